@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# Generate the perfect hash of the HTML tag and attribute names in libwget/html_url.c.
+#
+#   hash = (length + asso[1st char] + asso[2nd char] + asso[last char]) % SIZE
+#
+# The asso values are searched at random until no two names share a slot.
+# The seed is fixed, so the same name list always gives the same tables.
+# Paste the output over html_name_asso[] and html_names[] in libwget/html_url.c,
+# then run the unit tests (test_html_names in tests/test.c checks every name).
+#
+# Usage: contrib/gen_html_names.py
+#
+
+import random
+import sys
+
+SIZE = 64
+
+# name, HTML_NAME_* id, URL valued attribute
+NAMES = [
+    ('action', 'ACTION', 1),
+    ('archive', 'ARCHIVE', 1),
+    ('background', 'BACKGROUND', 1),
+    ('base', 'BASE', 0),
+    ('charset', 'CHARSET', 0),
+    ('cite', 'CITE', 1),
+    ('classid', 'CLASSID', 1),
+    ('code', 'CODE', 1),
+    ('codebase', 'CODEBASE', 1),
+    ('content', 'CONTENT', 0),
+    ('data', 'DATA', 1),
+    ('formaction', 'FORMACTION', 1),
+    ('href', 'HREF', 1),
+    ('http-equiv', 'HTTP_EQUIV', 0),
+    ('icon', 'ICON', 1),
+    ('link', 'LINK', 0),
+    ('longdesc', 'LONGDESC', 1),
+    ('lowsrc', 'LOWSRC', 1),
+    ('manifest', 'MANIFEST', 1),
+    ('meta', 'META', 0),
+    ('name', 'NAME', 0),
+    ('poster', 'POSTER', 1),
+    ('profile', 'PROFILE', 1),
+    ('rel', 'REL', 0),
+    ('src', 'SRC', 1),
+    ('srcset', 'SRCSET', 1),
+    ('style', 'STYLE', 0),
+    ('usemap', 'USEMAP', 1),
+]
+
+# the lookup reads name[0], name[1] and name[len - 1] and compares the whole name
+MAX_LENGTH = 10
+
+
+def slot(name, asso):
+    return (len(name) + asso[name[0]] + asso[name[1]] + asso[name[-1]]) % SIZE
+
+
+def search():
+    letters = sorted({c for name, _, _ in NAMES for c in (name[0], name[1], name[-1])})
+    rnd = random.Random(1)
+
+    for _ in range(1000000):
+        asso = {c: rnd.randrange(SIZE) for c in letters}
+        if len({slot(name, asso) for name, _, _ in NAMES}) == len(NAMES):
+            return asso
+
+    sys.exit('no perfect hash found, increase SIZE')
+
+
+def main():
+    for name, _, _ in NAMES:
+        if not 3 <= len(name) <= MAX_LENGTH or not (name[0] + name[1] + name[-1]).isalpha():
+            sys.exit("'%s' doesn't fit the hash function" % name)
+
+    asso = search()
+
+    entries = ["['%s'] = %d" % (c, v) for c, v in sorted(asso.items())]
+    print('static const unsigned char html_name_asso[256] = {')
+    for i in range(0, len(entries), 7):
+        print('\t' + ', '.join(entries[i:i + 7]) + ',')
+    print('};')
+    print()
+
+    print('static const struct html_name {')
+    print('\tconst char')
+    print('\t\tname[%d];' % (MAX_LENGTH + 1))
+    print('\tunsigned char')
+    print('\t\tid,')
+    print('\t\turl_attr; // attribute with a URL value')
+    print('} html_names[%d] = {' % SIZE)
+    for name, ident, url_attr in sorted(NAMES, key=lambda n: slot(n[0], asso)):
+        print('\t[%d] = { "%s", HTML_NAME_%s, %d },' % (slot(name, asso), name, ident, url_attr))
+    print('};')
+
+
+if __name__ == '__main__':
+    main()
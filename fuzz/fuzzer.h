@@ -0,0 +1,33 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Header file for the fuzzers
+ *
+ */
+
+#ifndef _WGET_FUZZER_H
+#define _WGET_FUZZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// the libFuzzer entry point, implemented by each fuzzer
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+#endif /* _WGET_FUZZER_H */
@@ -0,0 +1,54 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Fuzzer for wget_css_parse_buffer()
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <wget.h>
+#include "fuzzer.h"
+
+static void _css_parse_uri(void *context G_GNUC_WGET_UNUSED, const char *url G_GNUC_WGET_UNUSED, size_t len G_GNUC_WGET_UNUSED, size_t pos G_GNUC_WGET_UNUSED)
+{
+}
+
+static void _css_parse_encoding(void *context G_GNUC_WGET_UNUSED, const char *encoding G_GNUC_WGET_UNUSED, size_t len G_GNUC_WGET_UNUSED)
+{
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	char *in = wget_malloc(size + 1);
+
+	// the tokenizer scans in place and needs a 0-terminated buffer
+	memcpy(in, data, size);
+	in[size] = 0;
+
+	wget_css_parse_buffer(in, size, _css_parse_uri, _css_parse_encoding, NULL);
+
+	wget_xfree(in);
+
+	return 0;
+}
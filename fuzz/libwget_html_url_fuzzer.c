@@ -0,0 +1,48 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Fuzzer for wget_html_get_urls_inline()
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <wget.h>
+#include "fuzzer.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	WGET_HTML_PARSED_RESULT *res;
+	char *in = wget_malloc(size + 1);
+
+	// the parser expects a 0-terminated string
+	memcpy(in, data, size);
+	in[size] = 0;
+
+	res = wget_html_get_urls_inline(in, NULL, NULL);
+	wget_html_free_urls_inline(&res);
+
+	wget_xfree(in);
+
+	return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Fuzzer for wget_http_parse_response_header()
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <wget.h>
+#include "fuzzer.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	wget_http_response_t *resp;
+	char *in = wget_malloc(size + 1);
+
+	// the header is parsed in place
+	memcpy(in, data, size);
+	in[size] = 0;
+
+	resp = wget_http_parse_response_header(in);
+	wget_http_free_response(&resp);
+
+	wget_xfree(in);
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Fuzzer for wget_xml_parse_buffer()
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <wget.h>
+#include "fuzzer.h"
+
+static void _xml_callback(void *context, int flags G_GNUC_WGET_UNUSED, const char *dir G_GNUC_WGET_UNUSED,
+	const char *attr G_GNUC_WGET_UNUSED, const char *val G_GNUC_WGET_UNUSED, size_t len, size_t pos G_GNUC_WGET_UNUSED)
+{
+	*(size_t *) context += len;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	char *in = wget_malloc(size + 1);
+	size_t total = 0;
+
+	memcpy(in, data, size);
+	in[size] = 0;
+
+	// the same input as XML and as HTML, both share the tokenizer but differ in the handling of tags
+	wget_xml_parse_buffer(in, _xml_callback, &total, 0);
+	wget_xml_parse_buffer(in, _xml_callback, &total, XML_HINT_REMOVE_EMPTY_CONTENT | XML_HINT_HTML);
+
+	wget_xfree(in);
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Standalone driver for the fuzzers
+ *
+ * Without a fuzzing engine (libFuzzer brings its own main()), each fuzzer runs
+ * the files of its corpus SRCDIR/<fuzzer>.in/ and SRCDIR/<fuzzer>.repro/, or the
+ * files given on the command line. That way 'make check' replays the corpus.
+ *
+ * Slow-unit mode: each input has a CPU time budget that grows linearly with
+ * its size. A parser that needs more is super-linear on that input, which is
+ * reported as a failure. WGET_FUZZ_BUDGET_SCALE multiplies the budget
+ * (e.g. for valgrind or sanitizer builds), 0 switches the check off.
+ *
+ * Built with afl-gcc/afl-clang, the input is read from stdin instead.
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <wget.h>
+#include "fuzzer.h"
+
+#define BUDGET_BASE_MS 50 // fixed CPU time per input
+#define BUDGET_PER_KB_MS 2 // additional CPU time per KiB of input
+
+static double
+	budget_scale = 1.0;
+static int
+	nunits,
+	failed;
+
+static void _test_file(const char *fname)
+{
+	size_t size;
+	char *data = wget_read_file(fname, &size);
+	long long used, budget;
+	clock_t start;
+
+	if (!data) {
+		fprintf(stderr, "Failed to read %s\n", fname);
+		failed++;
+		return;
+	}
+
+	start = clock();
+	LLVMFuzzerTestOneInput((const uint8_t *) data, size);
+	used = (long long) (clock() - start) * 1000 / CLOCKS_PER_SEC;
+	nunits++;
+
+	budget = (long long) ((BUDGET_BASE_MS + BUDGET_PER_KB_MS * (size / 1024)) * budget_scale);
+
+	if (budget_scale > 0 && used > budget) {
+		fprintf(stderr, "Slow unit %s: %lld ms for %zu bytes (budget %lld ms)\n", fname, used, size, budget);
+		failed++;
+	}
+
+	wget_xfree(data);
+}
+
+// returns -1 if 'dirname' can't be opened, e.g. if there is no such corpus
+static int _test_dir(const char *dirname)
+{
+	DIR *dirp;
+	struct dirent *dp;
+
+	if (!(dirp = opendir(dirname)))
+		return -1;
+
+	while ((dp = readdir(dirp))) {
+		char *fname;
+
+		if (*dp->d_name == '.')
+			continue;
+
+		fname = wget_aprintf("%s/%s", dirname, dp->d_name);
+		_test_file(fname);
+		wget_xfree(fname);
+	}
+
+	closedir(dirp);
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *scale = getenv("WGET_FUZZ_BUDGET_SCALE");
+
+	if (scale)
+		budget_scale = atof(scale);
+
+#ifdef __AFL_COMPILER
+	(void) argc; (void) argv;
+
+	while (__AFL_LOOP(10000)) {
+		wget_buffer_t *buf = wget_buffer_alloc(4096);
+		char tmp[4096];
+		ssize_t nbytes;
+
+		while ((nbytes = read(STDIN_FILENO, tmp, sizeof(tmp))) > 0)
+			wget_buffer_memcat(buf, tmp, nbytes);
+
+		LLVMFuzzerTestOneInput((const uint8_t *) buf->data, buf->length);
+		wget_buffer_free(&buf);
+	}
+
+	return 0;
+#else
+	if (argc > 1) {
+		for (int it = 1; it < argc; it++)
+			_test_file(argv[it]);
+	} else {
+		// the corpus directories are named after the fuzzer, e.g. libwget_iri_fuzzer.in
+		const char *name = strrchr(argv[0], '/');
+		char *target, *dirname;
+		size_t len;
+
+		name = name ? name + 1 : argv[0];
+		if (!strncmp(name, "lt-", 3))
+			name += 3; // libtool wrapper
+
+		target = wget_strdup(name);
+		if ((len = strlen(target)) > 4 && !wget_strcasecmp_ascii(target + len - 4, ".exe"))
+			target[len - 4] = 0;
+
+		dirname = wget_aprintf("%s/%s.in", SRCDIR, target);
+		if (_test_dir(dirname)) {
+			fprintf(stderr, "Failed to open corpus %s\n", dirname);
+			failed++;
+		}
+		wget_xfree(dirname);
+
+		// reproducers of fixed bugs are optional
+		dirname = wget_aprintf("%s/%s.repro", SRCDIR, target);
+		_test_dir(dirname);
+		wget_xfree(dirname);
+
+		wget_xfree(target);
+	}
+
+	printf("%d units, %d failed\n", nunits, failed);
+
+	return failed ? 1 : 0;
+#endif
+}
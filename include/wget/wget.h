@@ -246,6 +246,8 @@ WGET_BEGIN_DECLS
 #define WGET_HTTP_BODY                2017
 #define WGET_HTTP_BODY_SAVEAS         2018
 #define WGET_HTTP_USER_DATA           2019
+#define WGET_HTTP_RESPONSE_KEEP_ENCODING 2020
+#define WGET_HTTP_DECOMPRESS_BUFFER_SIZE 2021
 
 // definition of error conditions
 #define WGET_E_SUCCESS 0 /* OK */
@@ -256,6 +258,8 @@ WGET_BEGIN_DECLS
 #define WGET_E_HANDSHAKE -5 /* general TLS handshake failure */
 #define WGET_E_CERTIFICATE -6 /* general TLS certificate failure */
 #define WGET_E_TLS_DISABLED -7 /* TLS was not enabled at compile time */
+#define WGET_E_ADDRESS -8 /* host name could not be resolved */
+#define WGET_E_CONNREFUSED -9 /* connection refused by the peer */
 
 typedef void (*wget_global_get_func_t)(const char *, size_t);
 
@@ -416,6 +420,34 @@ WGETAPI void *
 WGETAPI void
 	wget_set_oomfunc(wget_oom_callback_t);
 
+/*
+ * Memory accounting by subsystem (built with --enable-memstats)
+ */
+
+typedef enum {
+	WGET_MEMTAG_FRONTIER, // queued download jobs
+	WGET_MEMTAG_BLACKLIST, // URLs already queued or downloaded
+	WGET_MEMTAG_KNOWN_URLS, // URLs found while parsing
+	WGET_MEMTAG_DNS_CACHE,
+	WGET_MEMTAG_TLS, // TLS session cache
+	WGET_MEMTAG_HTTP_BUFFERS, // connection buffers and response bodies
+	WGET_MEMTAG_HTTP2_STREAMS,
+	WGET_MEMTAG_PARSERS, // parse results, kept until the end with --convert-links
+	WGET_MEMTAG_COOKIES,
+	WGET_MEMTAG_MAX
+} wget_memtag_t;
+
+WGETAPI void
+	wget_memstats_alloc(wget_memtag_t tag, size_t size);
+WGETAPI void
+	wget_memstats_free(wget_memtag_t tag, size_t size);
+WGETAPI void
+	wget_memstats_get(wget_memtag_t tag, size_t *current, size_t *peak, size_t *count);
+WGETAPI const char *
+	wget_memstats_name(wget_memtag_t tag) G_GNUC_WGET_CONST;
+WGETAPI size_t
+	wget_memstats_report(char *buf, size_t size) G_GNUC_WGET_NONNULL((1));
+
 /*
  * String/Memory routines, slightly different than standard functions
  */
@@ -813,6 +845,10 @@ WGETAPI void
 	wget_decompress_close(wget_decompressor_t *dc);
 WGETAPI int
 	wget_decompress(wget_decompressor_t *dc, char *src, size_t srclen);
+WGETAPI void
+	wget_decompress_set_buffer(wget_decompressor_t *dc, char *buf, size_t size);
+WGETAPI int
+	wget_decompress_buffer(int encoding, const char *src, size_t srclen, wget_buffer_t *dst) G_GNUC_WGET_NONNULL((4));
 
 /*
  * URI/IRI routines
@@ -997,6 +1033,37 @@ WGETAPI int
 WGETAPI int
 	wget_hsts_db_load(wget_hsts_db_t *hsts_db, const char *fname);
 
+/*
+ * Permanent redirect (301, 308) routines
+ */
+
+// structure for permanent redirect entries
+typedef struct _wget_redirect_st wget_redirect_t;
+typedef struct _wget_redirect_db_st wget_redirect_db_t;
+
+WGETAPI wget_redirect_t *
+	wget_redirect_init(wget_redirect_t *redirect);
+WGETAPI void
+	wget_redirect_deinit(wget_redirect_t *redirect);
+WGETAPI void
+	wget_redirect_free(wget_redirect_t *redirect);
+WGETAPI wget_redirect_t *
+	wget_redirect_new(const char *source, const char *target, int status, time_t maxage);
+WGETAPI wget_redirect_db_t *
+	wget_redirect_db_init(wget_redirect_db_t *redirect_db);
+WGETAPI void
+	wget_redirect_db_deinit(wget_redirect_db_t *redirect_db);
+WGETAPI void
+	wget_redirect_db_free(wget_redirect_db_t **redirect_db);
+WGETAPI void
+	wget_redirect_db_add(wget_redirect_db_t *redirect_db, wget_redirect_t *redirect);
+WGETAPI char *
+	wget_redirect_db_get(wget_redirect_db_t *redirect_db, const char *source, int *status);
+WGETAPI int
+	wget_redirect_db_save(wget_redirect_db_t *redirect_db, const char *fname);
+WGETAPI int
+	wget_redirect_db_load(wget_redirect_db_t *redirect_db, const char *fname);
+
 /*
  * HTTP Public Key Pinning (HPKP)
  */
@@ -1200,6 +1267,13 @@ typedef struct {
 		len;
 } wget_string_t;
 
+typedef struct {
+	wget_string_t
+		url; // content of <loc>
+	time_t
+		lastmod; // content of <lastmod>, 0 if missing
+} wget_sitemap_url_t;
+
 typedef struct {
 	wget_string_t
 		url;
@@ -1235,6 +1309,8 @@ WGETAPI void
 	wget_html_free_urls_inline(WGET_HTML_PARSED_RESULT **res);
 WGETAPI void
 	wget_sitemap_get_urls_inline(const char *sitemap, wget_vector_t **urls, wget_vector_t **sitemap_urls);
+WGETAPI void
+	wget_sitemap_get_entries_inline(const char *sitemap, wget_vector_t **urls, wget_vector_t **sitemap_urls);
 WGETAPI void
 	wget_atom_get_urls_inline(const char *atom, wget_vector_t **urls);
 WGETAPI void
@@ -1351,6 +1427,12 @@ WGETAPI int
 	wget_tcp_get_protocol(wget_tcp_t *tcp) G_GNUC_WGET_PURE;
 WGETAPI int
 	wget_tcp_get_local_port(wget_tcp_t *tcp);
+WGETAPI const char *
+	wget_tcp_get_peer_address(wget_tcp_t *tcp, char *buf, size_t bufsize);
+WGETAPI int
+	wget_tcp_get_error(wget_tcp_t *tcp) G_GNUC_WGET_PURE;
+WGETAPI int
+	wget_tcp_is_connected_to(wget_tcp_t *tcp, const char *host, const char *port);
 WGETAPI void
 	wget_tcp_set_debug(wget_tcp_t *tcp, int debug);
 WGETAPI void
@@ -1361,6 +1443,20 @@ WGETAPI void
 	wget_tcp_set_protocol(wget_tcp_t *tcp, int protocol);
 WGETAPI void
 	wget_tcp_set_bind_address(wget_tcp_t *tcp, const char *bind_address);
+WGETAPI void
+	wget_tcp_set_bind_address_no_port(wget_tcp_t *tcp, int no_port);
+WGETAPI void
+	wget_tcp_set_receive_buffer_size(wget_tcp_t *tcp, int size);
+WGETAPI void
+	wget_tcp_set_send_buffer_size(wget_tcp_t *tcp, int size);
+WGETAPI void
+	wget_tcp_set_notsent_lowat(wget_tcp_t *tcp, int lowat);
+WGETAPI void
+	wget_tcp_set_busy_poll(wget_tcp_t *tcp, int usecs);
+WGETAPI void
+	wget_tcp_set_quickack(wget_tcp_t *tcp, int quickack);
+WGETAPI void
+	wget_tcp_set_congestion_control(wget_tcp_t *tcp, const char *algorithm);
 WGETAPI struct addrinfo *
 	wget_tcp_resolve(wget_tcp_t *tcp, const char *restrict name, const char *restrict port) G_GNUC_WGET_NONNULL((2));
 WGETAPI int
@@ -1414,6 +1510,7 @@ WGETAPI int
 #define WGET_SSL_ALPN              18
 #define WGET_SSL_SESSION_CACHE     19
 #define WGET_SSL_HPKP_CACHE     20
+#define WGET_SSL_SERVER_ALPN    21
 
 WGETAPI void
 	wget_ssl_init(void);
@@ -1429,6 +1526,8 @@ WGETAPI int
 	wget_ssl_open(wget_tcp_t *tcp);
 WGETAPI void
 	wget_ssl_close(void **session);
+WGETAPI int
+	wget_ssl_check_peer_hostname(wget_tcp_t *tcp, const char *hostname);
 WGETAPI void
 	wget_ssl_set_check_certificate(char value);
 WGETAPI void
@@ -1464,7 +1563,8 @@ typedef struct {
 		pri;
 	enum {
 		link_rel_describedby,
-		link_rel_duplicate
+		link_rel_duplicate,
+		link_rel_preload
 	} rel;
 } wget_http_link_t;
 
@@ -1503,12 +1603,16 @@ typedef struct {
 		header_callback; // called after HTTP header has been received
 	wget_http_body_callback_t
 		body_callback; // called for each body data packet received
+	wget_http_body_callback_t
+		raw_body_callback; // called for each body data packet as received, before de-chunking and decompression
 	void *
 		user_data;
 	void *
 		header_user_data; // meant to be used in header callback function
 	void *
 		body_user_data; // meant to be used in body callback function
+	void *
+		raw_body_user_data; // meant to be used in raw body callback function
 	wget_buffer_t
 		esc_resource; // URI escaped resource
 	wget_buffer_t
@@ -1517,6 +1621,8 @@ typedef struct {
 		body_length;
 	int32_t
 		stream_id; // HTTP2 stream id
+	int
+		decompress_buffer_size; // bytes per body callback when decompressing, 0 = default
 	char
 		esc_resource_buf[256];
 	char
@@ -1524,7 +1630,8 @@ typedef struct {
 	char
 		method[8]; // we just need HEAD, GET and POST
 	unsigned char
-		response_keepheader : 1;
+		response_keepheader : 1,
+		response_keep_encoding : 1; // pass Content-Encoded bodies to the body callback without decompression
 } wget_http_request_t;
 
 // just parse the header lines that we need
@@ -1603,8 +1710,13 @@ typedef struct {
 		*pending_requests; // List of unresponsed requests (HTTP1 only)
 	wget_vector_t
 		*received_http2_responses; // List of received (but yet unprocessed) responses (HTTP2 only)
+	void
+		*proxy; // referenced proxy statistics to update when the first response arrived
+	long long
+		proxy_start; // time of connecting to 'proxy' (ms)
 	int
-		pending_http2_requests; // Number of unresponsed requests (HTTP2 only)
+		pending_http2_requests, // Number of unresponsed requests (HTTP2 only)
+		http2_max_streams; // The peer's SETTINGS_MAX_CONCURRENT_STREAMS, a small default until received (HTTP2 only)
 	char
 		protocol; // WGET_PROTOCOL_HTTP_1_1 or WGET_PROTOCOL_HTTP_2_0
 	unsigned char
@@ -1682,6 +1794,8 @@ WGETAPI int
 	wget_http_set_no_proxy(const char *no_proxy, const char *encoding);
 WGETAPI int
 	wget_http_match_no_proxy(wget_vector_t *no_proxies, const char *host);
+WGETAPI int
+	wget_http_set_http2_prior_knowledge(const char *hosts, const char *encoding);
 WGETAPI void
 	wget_http_abort_connection(wget_http_connection_t *conn);
 
@@ -1732,10 +1846,16 @@ WGETAPI wget_http_request_t *
 	wget_http_create_request(const wget_iri_t *iri, const char *method) G_GNUC_WGET_NONNULL_ALL;
 WGETAPI void
 	wget_http_close(wget_http_connection_t **conn) G_GNUC_WGET_NONNULL_ALL;
+WGETAPI int
+	wget_http_get_max_streams(const wget_http_connection_t *conn) G_GNUC_WGET_NONNULL_ALL;
+WGETAPI int
+	wget_http_match_connection(wget_http_connection_t *conn, const wget_iri_t *iri);
 WGETAPI void
 	wget_http_request_set_header_cb(wget_http_request_t *req, wget_http_header_callback_t cb, void *user_data) G_GNUC_WGET_NONNULL((1));
 WGETAPI void
 	wget_http_request_set_body_cb(wget_http_request_t *req, wget_http_body_callback_t cb, void *user_data) G_GNUC_WGET_NONNULL((1));
+WGETAPI void
+	wget_http_request_set_raw_body_cb(wget_http_request_t *req, wget_http_body_callback_t cb, void *user_data) G_GNUC_WGET_NONNULL((1));
 WGETAPI void
 	wget_http_request_set_int(wget_http_request_t *req, int key, int value) G_GNUC_WGET_NONNULL((1));
 WGETAPI int
@@ -1809,6 +1929,10 @@ WGETAPI int
 	wget_hash(wget_hash_hd_t *handle, const void *text, size_t textlen);
 WGETAPI void
 	wget_hash_deinit(wget_hash_hd_t *handle, void *digest);
+WGETAPI wget_hash_hd_t *
+	wget_hash_alloc(void) G_GNUC_WGET_MALLOC;
+WGETAPI void
+	wget_hash_free(wget_hash_hd_t **handle);
 
 /*
  * Hash file routines
@@ -1884,6 +2008,8 @@ typedef struct ROBOTS {
 		*paths;
 	wget_vector_t
 		*sitemaps;
+	int
+		crawl_delay; // Crawl-delay in milliseconds, 0 if not given
 } ROBOTS;
 
 WGETAPI ROBOTS *
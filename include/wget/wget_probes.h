@@ -0,0 +1,60 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Static tracepoints (SystemTap / USDT) used by libwget and wget2, not installed
+ *
+ * Each probe is a single nop plus an ELF note, so they stay in release builds.
+ * List them with 'stap -L "process(\"wget2\").mark(\"*\")"' or 'bpftrace -l "usdt:wget2:*"'.
+ * String arguments are char pointers, everything else is an integer.
+ *
+ * Provider 'wget', probes and arguments:
+ *   job_dequeue(uri, level)                          src/host.c
+ *   url_enqueue(uri, level)                          src/wget.c
+ *   url_blacklist(uri)                               src/wget.c
+ *   file_open(name, fd)                              src/wget.c
+ *   file_close(fd)                                   src/wget.c
+ *   tcp_connect_start(host, port)                    libwget/net.c
+ *   tcp_connect_end(host, port, error)               libwget/net.c
+ *   tls_handshake_start(host, fd)                    libwget/ssl_gnutls.c
+ *   tls_handshake_end(host, error)                   libwget/ssl_gnutls.c
+ *   http_request_send(method, host, resource)        libwget/http.c
+ *   http_response_first_byte(host, resource)         libwget/http.c
+ *   http_response_done(host, resource, code, bytes)  libwget/http.c
+ *
+ */
+
+#ifndef _WGET_PROBES_H
+#define _WGET_PROBES_H
+
+#ifdef ENABLE_PROBES
+#	include <sys/sdt.h>
+#	define WGET_PROBE0(name) DTRACE_PROBE(wget, name)
+#	define WGET_PROBE1(name, a) DTRACE_PROBE1(wget, name, a)
+#	define WGET_PROBE2(name, a, b) DTRACE_PROBE2(wget, name, a, b)
+#	define WGET_PROBE3(name, a, b, c) DTRACE_PROBE3(wget, name, a, b, c)
+#	define WGET_PROBE4(name, a, b, c, d) DTRACE_PROBE4(wget, name, a, b, c, d)
+#else
+#	define WGET_PROBE0(name) do { } while (0)
+#	define WGET_PROBE1(name, a) do { } while (0)
+#	define WGET_PROBE2(name, a, b) do { } while (0)
+#	define WGET_PROBE3(name, a, b, c) do { } while (0)
+#	define WGET_PROBE4(name, a, b, c, d) do { } while (0)
+#endif
+
+#endif /* _WGET_PROBES_H */
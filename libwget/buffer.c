@@ -78,17 +78,18 @@ void wget_buffer_realloc(wget_buffer_t *buf, size_t size)
 
 	buf->size = size;
 	// buf->size = buf->size ? (size / buf->size + 1) * buf->size : size;
-	buf->data = xmalloc(buf->size + 1);
 
-	if (likely(old_data)) {
-		if (buf->length)
-			memcpy(buf->data, old_data, buf->length + 1);
-		else
-			*buf->data = 0; // always 0 terminate data to allow string functions
+	if (likely(old_data) && buf->release_data) {
+		// realloc() may grow in place or remap, avoiding a copy of the whole content
+		buf->data = xrealloc(buf->data, buf->size + 1);
+		return;
+	}
 
-		if (buf->release_data)
-			xfree(old_data);
-	} else
+	buf->data = xmalloc(buf->size + 1);
+
+	if (likely(old_data) && buf->length)
+		memcpy(buf->data, old_data, buf->length + 1);
+	else
 		*buf->data = 0; // always 0 terminate data to allow string functions
 
 	buf->release_data = 1;
@@ -256,6 +256,29 @@ void wget_cookie_free(wget_cookie_t **cookie)
 	}
 }
 
+static inline size_t _cookie_size(const wget_cookie_t *cookie)
+{
+	size_t size = sizeof(wget_cookie_t);
+
+	if (cookie->name)
+		size += strlen(cookie->name) + 1;
+	if (cookie->value)
+		size += strlen(cookie->value) + 1;
+	if (cookie->domain)
+		size += strlen(cookie->domain) + 1;
+	if (cookie->path)
+		size += strlen(cookie->path) + 1;
+
+	return size;
+}
+
+// destructor of the cookie db entries
+static void _free_cookie_entry(wget_cookie_t *cookie)
+{
+	memstats_free(WGET_MEMTAG_COOKIES, _cookie_size(cookie));
+	wget_cookie_deinit(cookie);
+}
+
 /*
 int wget_cookie_equals(wget_cookie_t *cookie1, wget_cookie_t *cookie2)
 {
@@ -633,6 +656,8 @@ int wget_cookie_store_cookie(wget_cookie_db_t *cookie_db, wget_cookie_t *cookie)
 		wget_vector_insert_sorted(cookie_db->cookies, cookie, sizeof(*cookie));
 	}
 
+	memstats_alloc(WGET_MEMTAG_COOKIES, _cookie_size(cookie));
+
 	wget_thread_mutex_unlock(&cookie_db->mutex);
 
 	return 0;
@@ -739,7 +764,7 @@ wget_cookie_db_t *wget_cookie_db_init(wget_cookie_db_t *cookie_db)
 
 	memset(cookie_db, 0, sizeof(*cookie_db));
 	cookie_db->cookies = wget_vector_create(32, -2, (wget_vector_compare_t)_compare_cookie);
-	wget_vector_set_destructor(cookie_db->cookies, (wget_vector_destructor_t)wget_cookie_deinit);
+	wget_vector_set_destructor(cookie_db->cookies, (wget_vector_destructor_t)_free_cookie_entry);
 	wget_thread_mutex_init(&cookie_db->mutex);
 #ifdef WITH_LIBPSL
 #if ((PSL_VERSION_MAJOR > 0) || (PSL_VERSION_MAJOR == 0 && PSL_VERSION_MINOR >= 16))
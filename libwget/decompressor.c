@@ -39,6 +39,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 #ifdef WITH_ZLIB
 #include <zlib.h>
@@ -59,6 +60,8 @@
 #include <wget.h>
 #include "private.h"
 
+#define DECOMPRESS_BUFSIZE (64 * 1024) // default size of the output buffer
+
 struct _wget_decompressor_st {
 #ifdef WITH_ZLIB
 	z_stream
@@ -79,6 +82,13 @@ struct _wget_decompressor_st {
 
 	wget_decompressor_sink_t
 		sink; // decompressed data goes here
+	wget_buffer_t
+		*out; // one-shot mode: decompressed data is appended here instead of calling sink()
+	char
+		*dst, // output buffer for sink()
+		*dst_alloc; // our own output buffer, NULL if supplied by the caller
+	size_t
+		dst_size;
 	int
 		(*decompress)(wget_decompressor_t *dc, char *src, size_t srclen);
 	void
@@ -88,6 +98,37 @@ struct _wget_decompressor_st {
 		encoding;
 };
 
+// return where to decompress into, in one-shot mode the output buffer grows as needed
+static char *_out_begin(wget_decompressor_t *dc, size_t *size)
+{
+	if (dc->out) {
+		if (dc->out->size - dc->out->length < 4096)
+			wget_buffer_ensure_capacity(dc->out, dc->out->size * 2);
+
+		*size = dc->out->size - dc->out->length;
+		return dc->out->data + dc->out->length;
+	}
+
+	if (!dc->dst) {
+		if (!dc->dst_size)
+			dc->dst_size = DECOMPRESS_BUFSIZE;
+		dc->dst = dc->dst_alloc = xmalloc(dc->dst_size);
+	}
+
+	*size = dc->dst_size;
+	return dc->dst;
+}
+
+// hand over 'length' bytes decompressed into the buffer returned by _out_begin()
+static void _out_end(wget_decompressor_t *dc, const char *data, size_t length)
+{
+	if (dc->out) {
+		dc->out->length += length;
+		dc->out->data[dc->out->length] = 0;
+	} else if (dc->sink)
+		dc->sink(dc->context, data, length);
+}
+
 #ifdef WITH_ZLIB
 static int gzip_init(z_stream *strm)
 {
@@ -106,13 +147,13 @@ static int gzip_init(z_stream *strm)
 static int gzip_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 {
 	z_stream *strm;
-	char dst[10240];
+	char *dst;
+	size_t dst_size;
 	int status;
 
 	if (!srclen) {
 		// special case to avoid decompress errors
-		if (dc->sink)
-			dc->sink(dc->context, "", 0);
+		_out_end(dc, "", 0);
 
 		return 0;
 	}
@@ -122,14 +163,14 @@ static int gzip_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 	strm->avail_in = (unsigned int) srclen;
 
 	do {
+		dst = _out_begin(dc, &dst_size);
 		strm->next_out = (unsigned char *) dst;
-		strm->avail_out = sizeof(dst);
+		strm->avail_out = (unsigned int) (dst_size < UINT_MAX ? dst_size : UINT_MAX);
+		dst_size = strm->avail_out;
 
 		status = inflate(strm, Z_SYNC_FLUSH);
-		if ((status == Z_OK || status == Z_STREAM_END) && strm->avail_out<sizeof(dst)) {
-			if (dc->sink)
-				dc->sink(dc->context, dst, sizeof(dst) - strm->avail_out);
-		}
+		if ((status == Z_OK || status == Z_STREAM_END) && strm->avail_out < dst_size)
+			_out_end(dc, dst, dst_size - strm->avail_out);
 	} while (status == Z_OK && !strm->avail_out);
 
 	if (status == Z_OK || status == Z_STREAM_END)
@@ -179,13 +220,13 @@ static int lzma_init(lzma_stream *strm)
 static int lzma_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 {
 	lzma_stream *strm;
-	char dst[10240];
+	char *dst;
+	size_t dst_size;
 	int status;
 
 	if (!srclen) {
 		// special case to avoid decompress errors
-		if (dc->sink)
-			dc->sink(dc->context, "", 0);
+		_out_end(dc, "", 0);
 
 		return 0;
 	}
@@ -195,14 +236,13 @@ static int lzma_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 	strm->avail_in = srclen;
 
 	do {
+		dst = _out_begin(dc, &dst_size);
 		strm->next_out = (unsigned char *)dst;
-		strm->avail_out = sizeof(dst);
+		strm->avail_out = dst_size;
 
 		status = lzma_code(strm, LZMA_RUN);
-		if ((status == LZMA_OK || status == LZMA_STREAM_END) && strm->avail_out<sizeof(dst)) {
-			if (dc->sink)
-				dc->sink(dc->context, dst, sizeof(dst) - strm->avail_out);
-		}
+		if ((status == LZMA_OK || status == LZMA_STREAM_END) && strm->avail_out < dst_size)
+			_out_end(dc, dst, dst_size - strm->avail_out);
 	} while (status == LZMA_OK && !strm->avail_out);
 
 	if (status == LZMA_OK || status == LZMA_STREAM_END)
@@ -233,15 +273,14 @@ static int brotli_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 {
 	BrotliDecoderState *strm;
 	BrotliDecoderResult status;
-	uint8_t dst[10240];
-	size_t available_in, available_out;
+	char *dst;
+	size_t dst_size, available_in, available_out;
 	const uint8_t *next_in;
 	uint8_t *next_out;
 
 	if (!srclen) {
 		// special case to avoid decompress errors
-		if (dc->sink)
-			dc->sink(dc->context, "", 0);
+		_out_end(dc, "", 0);
 
 		return 0;
 	}
@@ -251,14 +290,13 @@ static int brotli_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 	available_in = srclen;
 
 	do {
+		dst = _out_begin(dc, &dst_size);
 		next_out = (unsigned char *)dst;
-		available_out = sizeof(dst);
+		available_out = dst_size;
 
 		status = BrotliDecoderDecompressStream(strm, &available_in, &next_in, &available_out, &next_out, NULL);
-		if (available_out != sizeof(dst)) {
-			if (dc->sink)
-				dc->sink(dc->context, (char *)dst, sizeof(dst) - available_out);
-		}
+		if (available_out != dst_size)
+			_out_end(dc, dst, dst_size - available_out);
 	} while (status == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
 
 	if (status == BROTLI_DECODER_RESULT_SUCCESS || status == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT)
@@ -292,13 +330,13 @@ static int bzip2_init(bz_stream *strm)
 static int bzip2_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 {
 	bz_stream *strm;
-	char dst[10240];
+	char *dst;
+	size_t dst_size;
 	int status;
 
 	if (!srclen) {
 		// special case to avoid decompress errors
-		if (dc->sink)
-			dc->sink(dc->context, "", 0);
+		_out_end(dc, "", 0);
 
 		return 0;
 	}
@@ -308,14 +346,14 @@ static int bzip2_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 	strm->avail_in = (unsigned int) srclen;
 
 	do {
+		dst = _out_begin(dc, &dst_size);
 		strm->next_out = dst;
-		strm->avail_out = sizeof(dst);
+		strm->avail_out = (unsigned int) (dst_size < UINT_MAX ? dst_size : UINT_MAX);
+		dst_size = strm->avail_out;
 
 		status = BZ2_bzDecompress(strm);
-		if ((status == BZ_OK || status == BZ_STREAM_END) && strm->avail_out<sizeof(dst)) {
-			if (dc->sink)
-				dc->sink(dc->context, dst, sizeof(dst) - strm->avail_out);
-		}
+		if ((status == BZ_OK || status == BZ_STREAM_END) && strm->avail_out < dst_size)
+			_out_end(dc, dst, dst_size - strm->avail_out);
 	} while (status == BZ_OK && !strm->avail_out);
 
 	if (status == BZ_OK || status == BZ_STREAM_END)
@@ -333,7 +371,9 @@ static void bzip2_exit(wget_decompressor_t *dc)
 
 static int identity(wget_decompressor_t *dc, char *src, size_t srclen)
 {
-	if (dc->sink)
+	if (dc->out)
+		wget_buffer_memcat(dc->out, src, srclen);
+	else if (dc->sink)
 		dc->sink(dc->context, src, srclen);
 
 	return 0;
@@ -397,11 +437,28 @@ wget_decompressor_t *wget_decompress_open(int encoding,
 	return dc;
 }
 
+/*
+ * Let 'dc' decompress into 'buf' of 'size' bytes, each fill of the buffer is given to the sink.
+ * With 'buf' being NULL, 'dc' allocates a buffer of 'size' bytes itself.
+ * The size should match the size of the writes done by the sink, the default is 64 KiB.
+ * 'buf' must stay valid until wget_decompress_close().
+ */
+void wget_decompress_set_buffer(wget_decompressor_t *dc, char *buf, size_t size)
+{
+	if (!dc || !size)
+		return;
+
+	xfree(dc->dst_alloc);
+	dc->dst = buf;
+	dc->dst_size = size;
+}
+
 void wget_decompress_close(wget_decompressor_t *dc)
 {
 	if (dc) {
 		if (dc->exit)
 			dc->exit(dc);
+		xfree(dc->dst_alloc);
 		xfree(dc);
 	}
 }
@@ -414,3 +471,33 @@ int wget_decompress(wget_decompressor_t *dc, char *src, size_t srclen)
 
 	return 0;
 }
+
+/*
+ * Decompress a complete body 'src' of 'srclen' bytes in one go and append the result to 'dst'.
+ * 'dst' is grown as needed, without intermediate copies or callbacks. If the size of
+ * the result is known (or guessed), make sure 'dst' is large enough before.
+ * Return 0 on success, -1 if 'encoding' is not supported or the data is corrupt.
+ */
+int wget_decompress_buffer(int encoding, const char *src, size_t srclen, wget_buffer_t *dst)
+{
+	wget_decompressor_t *dc;
+	int rc;
+
+	if (!(dc = wget_decompress_open(encoding, NULL, NULL)))
+		return -1;
+
+	if (!dc->decompress) {
+		// encoding not supported by this build
+		wget_decompress_close(dc);
+		return -1;
+	}
+
+	if (dst->size - dst->length < srclen)
+		wget_buffer_ensure_capacity(dst, dst->length + srclen * 4);
+
+	dc->out = dst;
+	rc = dc->decompress(dc, (char *) src, srclen);
+	wget_decompress_close(dc);
+
+	return rc;
+}
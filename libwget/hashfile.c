@@ -504,6 +504,27 @@ void wget_hash_deinit(wget_hash_hd_t *dig, void *digest)
 }
 #endif
 
+/**
+ * \return A new hash handle to be used with wget_hash_init(), free it with wget_hash_free()
+ *
+ * The handle type is opaque, so callers that hash data in pieces allocate it here.
+ */
+wget_hash_hd_t *wget_hash_alloc(void)
+{
+	return xcalloc(1, sizeof(wget_hash_hd_t));
+}
+
+/**
+ * \param[in] handle Pointer to a handle returned by wget_hash_alloc()
+ *
+ * Free the hash handle and set it to NULL. Call wget_hash_deinit() before, if wget_hash_init() has been called.
+ */
+void wget_hash_free(wget_hash_hd_t **handle)
+{
+	if (handle)
+		xfree(*handle);
+}
+
 /**
  * \param[in] hashname Name of the hashing algorithm. See wget_hash_get_algorithm()
  * \param[in] fd File descriptor for the target file
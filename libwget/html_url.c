@@ -45,7 +45,8 @@ typedef struct {
 	wget_vector_t *
 		ignore_tags;
 	int
-		uri_index;
+		uri_index,
+		tag_id; // HTML_NAME_* id of the current tag
 	size_t
 		css_start_offset;
 	char
@@ -58,36 +59,120 @@ typedef struct {
 		* css_dir;
 } _html_context_t;
 
-// see https://stackoverflow.com/questions/2725156/complete-list-of-html-tag-attributes-which-have-a-url-value
-static const char maybe[256] = {
-	['a'] = 1,
-	['b'] = 1,
-	['c'] = 1,
-	['d'] = 1,
-	['f'] = 1,
-	['h'] = 1,
-	['i'] = 1,
-	['l'] = 1,
-	['m'] = 1,
-	['p'] = 1,
-	['s'] = 1,
-	['u'] = 1,
+// tag and attribute names we are interested in
+enum {
+	HTML_NAME_UNKNOWN = 0,
+	HTML_NAME_ACTION,
+	HTML_NAME_ARCHIVE,
+	HTML_NAME_BACKGROUND,
+	HTML_NAME_BASE,
+	HTML_NAME_CHARSET,
+	HTML_NAME_CITE,
+	HTML_NAME_CLASSID,
+	HTML_NAME_CODE,
+	HTML_NAME_CODEBASE,
+	HTML_NAME_CONTENT,
+	HTML_NAME_DATA,
+	HTML_NAME_FORMACTION,
+	HTML_NAME_HREF,
+	HTML_NAME_HTTP_EQUIV,
+	HTML_NAME_ICON,
+	HTML_NAME_LINK,
+	HTML_NAME_LONGDESC,
+	HTML_NAME_LOWSRC,
+	HTML_NAME_MANIFEST,
+	HTML_NAME_META,
+	HTML_NAME_NAME,
+	HTML_NAME_POSTER,
+	HTML_NAME_PROFILE,
+	HTML_NAME_REL,
+	HTML_NAME_SRC,
+	HTML_NAME_SRCSET,
+	HTML_NAME_STYLE,
+	HTML_NAME_USEMAP
+};
+
+// Perfect hash over the names above (gperf style):
+//   hash = (length + asso[1st char] + asso[2nd char] + asso[last char]) % 64
+// Characters are case-folded by OR'ing 0x20, non-letters fall back to 0 and fail the final compare.
+// The tables are generated by contrib/gen_html_names.py, add new names there.
+static const unsigned char html_name_asso[256] = {
+	['a'] = 13, ['b'] = 15, ['c'] = 5, ['d'] = 10, ['e'] = 22, ['f'] = 37, ['h'] = 52,
+	['i'] = 7, ['k'] = 10, ['l'] = 14, ['m'] = 24, ['n'] = 18, ['o'] = 57, ['p'] = 1,
+	['r'] = 23, ['s'] = 25, ['t'] = 27, ['u'] = 27, ['v'] = 20,
 };
-static const char attrs[][12] = {
-	"action", "archive",
-	"background",
-	"code", "codebase", "cite", "classid",
-	"data",
-	"formaction",
-	"href",
-	"icon",
-	"lowsrc", "longdesc",
-	"manifest",
-	"profile", "poster",
-	"src", "srcset",
-	"usemap"
+
+// see https://stackoverflow.com/questions/2725156/complete-list-of-html-tag-attributes-which-have-a-url-value
+static const struct html_name {
+	const char
+		name[11];
+	unsigned char
+		id,
+		url_attr; // attribute with a URL value
+} html_names[64] = {
+	[1] = { "archive", HTML_NAME_ARCHIVE, 1 },
+	[8] = { "manifest", HTML_NAME_MANIFEST, 1 },
+	[15] = { "style", HTML_NAME_STYLE, 0 },
+	[17] = { "srcset", HTML_NAME_SRCSET, 1 },
+	[18] = { "lowsrc", HTML_NAME_LOWSRC, 1 },
+	[20] = { "longdesc", HTML_NAME_LONGDESC, 1 },
+	[23] = { "poster", HTML_NAME_POSTER, 1 },
+	[24] = { "code", HTML_NAME_CODE, 1 },
+	[27] = { "charset", HTML_NAME_CHARSET, 0 },
+	[28] = { "codebase", HTML_NAME_CODEBASE, 1 },
+	[32] = { "content", HTML_NAME_CONTENT, 0 },
+	[34] = { "icon", HTML_NAME_ICON, 1 },
+	[35] = { "link", HTML_NAME_LINK, 0 },
+	[36] = { "classid", HTML_NAME_CLASSID, 1 },
+	[38] = { "cite", HTML_NAME_CITE, 1 },
+	[40] = { "data", HTML_NAME_DATA, 1 },
+	[42] = { "action", HTML_NAME_ACTION, 1 },
+	[45] = { "http-equiv", HTML_NAME_HTTP_EQUIV, 0 },
+	[48] = { "background", HTML_NAME_BACKGROUND, 1 },
+	[52] = { "href", HTML_NAME_HREF, 1 },
+	[53] = { "profile", HTML_NAME_PROFILE, 1 },
+	[54] = { "base", HTML_NAME_BASE, 0 },
+	[56] = { "src", HTML_NAME_SRC, 1 },
+	[57] = { "name", HTML_NAME_NAME, 0 },
+	[58] = { "formaction", HTML_NAME_FORMACTION, 1 },
+	[59] = { "usemap", HTML_NAME_USEMAP, 1 },
+	[62] = { "rel", HTML_NAME_REL, 0 },
+	[63] = { "meta", HTML_NAME_META, 0 },
 };
 
+static const struct html_name *_html_lookup_name(const char *name)
+{
+	size_t len = strlen(name);
+
+	if (len < 3 || len > 10)
+		return NULL;
+
+	const struct html_name *entry = &html_names[(len
+		+ html_name_asso[(unsigned char)(name[0] | 0x20)]
+		+ html_name_asso[(unsigned char)(name[1] | 0x20)]
+		+ html_name_asso[(unsigned char)(name[len - 1] | 0x20)]) % countof(html_names)];
+
+	if (entry->id && !wget_strcasecmp_ascii(name, entry->name))
+		return entry;
+
+	return NULL;
+}
+
+static int _html_name_id(const char *name)
+{
+	const struct html_name *entry = _html_lookup_name(name);
+
+	return entry ? entry->id : HTML_NAME_UNKNOWN;
+}
+
+// 'tags' is a vector of wget_html_tag_t with a compare function, sorted when the tag list is set up.
+// That makes each lookup a binary search without building anything per document.
+static int _tag_set_contains(const wget_vector_t *tags, const char *tag, const char *attr)
+{
+	return wget_vector_find(tags, &(wget_html_tag_t){ .name = tag, .attribute = NULL }) != -1
+		|| wget_vector_find(tags, &(wget_html_tag_t){ .name = tag, .attribute = attr }) != -1;
+}
+
 static void _css_parse_uri(void *context, const char *url G_GNUC_WGET_UNUSED, size_t len, size_t pos)
 {
 	_html_context_t *ctx = context;
@@ -119,9 +204,12 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 	// Also ,we are interested in ROBOTS e.g.
 	//   <META name="ROBOTS" content="NOINDEX, NOFOLLOW">
 	if ((flags & XML_FLG_BEGIN)) {
-		if ((*tag|0x20) == 'm' && !wget_strcasecmp_ascii(tag, "meta"))
+		// the first callback of each tag has XML_FLG_BEGIN set, lookup the tag name just once
+		ctx->tag_id = _html_name_id(tag);
+
+		if (ctx->tag_id == HTML_NAME_META)
 			ctx->found_robots = ctx->found_content_type = 0;
-		else if ((*tag|0x20) == 'l' && !wget_strcasecmp_ascii(tag, "link")) {
+		else if (ctx->tag_id == HTML_NAME_LINK) {
 			ctx->link_inline = 0;
 			ctx->uri_index = -1;
 		}
@@ -129,16 +217,18 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 
 	if ((flags & XML_FLG_ATTRIBUTE) && val) {
 		WGET_HTML_PARSED_RESULT *res = &ctx->result;
+		const struct html_name *attr_name = _html_lookup_name(attr);
+		int attr_id = attr_name ? attr_name->id : HTML_NAME_UNKNOWN;
 
 //		info_printf("%02X %s %s '%.*s' %zu %zu\n", (unsigned) flags, tag, attr, (int) len, val, len, pos);
 
-		if ((*tag|0x20) == 'm' && !wget_strcasecmp_ascii(tag, "meta")) {
+		if (ctx->tag_id == HTML_NAME_META) {
 			if (!ctx->found_robots) {
-				if (!wget_strcasecmp_ascii(attr, "name") && !wget_strncasecmp_ascii(val, "robots", len)) {
+				if (attr_id == HTML_NAME_NAME && !wget_strncasecmp_ascii(val, "robots", len)) {
 					ctx->found_robots = 1;
 					return;
 				}
-			} else if (ctx->found_robots && !wget_strcasecmp_ascii(attr, "content")) {
+			} else if (ctx->found_robots && attr_id == HTML_NAME_CONTENT) {
 				char *p;
 				char valbuf[len + 1], *value = valbuf;
 
@@ -163,7 +253,7 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 			}
 
 			if (ctx->found_content_type && !res->encoding) {
-				if (!wget_strcasecmp_ascii(attr, "content")) {
+				if (attr_id == HTML_NAME_CONTENT) {
 					char valbuf[len + 1], *value = valbuf;
 
 					memcpy(value, val, len);
@@ -172,10 +262,10 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 				}
 			}
 			else if (!ctx->found_content_type && !res->encoding) {
-				if (!wget_strcasecmp_ascii(attr, "http-equiv") && !wget_strncasecmp_ascii(val, "Content-Type", len)) {
+				if (attr_id == HTML_NAME_HTTP_EQUIV && !wget_strncasecmp_ascii(val, "Content-Type", len)) {
 					ctx->found_content_type = 1;
 				}
-				else if (!wget_strcasecmp_ascii(attr, "charset")) {
+				else if (attr_id == HTML_NAME_CHARSET) {
 					res->encoding = wget_strmemdup(val, len);
 				}
 			}
@@ -183,13 +273,10 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 			return;
 		}
 
-		if (ctx->ignore_tags) {
-			if (wget_vector_find(ctx->ignore_tags, &(wget_html_tag_t){ .name = tag, .attribute = NULL } ) != -1
-				|| wget_vector_find(ctx->ignore_tags, &(wget_html_tag_t){ .name = tag, .attribute = attr } ) != -1)
-				return;
-		}
+		if (ctx->ignore_tags && _tag_set_contains(ctx->ignore_tags, tag, attr))
+			return;
 
-		if ((*attr|0x20) == 's' && !wget_strcasecmp_ascii(attr, "style") && len) {
+		if (attr_id == HTML_NAME_STYLE && len) {
 			ctx->css_dir = tag;
 			ctx->css_attr = "style";
 			ctx->css_start_offset = val - ctx->html;
@@ -197,42 +284,32 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 			return;
 		}
 
-		if ((*tag|0x20) == 'l' && !wget_strcasecmp_ascii(tag, "link")) {
-			if (!wget_strcasecmp_ascii(attr, "rel")) {
-				if (!wget_strncasecmp_ascii(val, "shortcut icon", len)
-					|| !wget_strncasecmp_ascii(val, "stylesheet", len)
-					|| !wget_strncasecmp_ascii(val, "preload", len))
-					ctx->link_inline = 1;
-				else
-					ctx->link_inline = 0;
-
-				if (ctx->uri_index >= 0) {
-					// href= came before rel=
-					WGET_HTML_PARSED_URL *url = wget_vector_get(res->uris, ctx->uri_index);
-					url->link_inline = ctx->link_inline;
-				}
+		if (ctx->tag_id == HTML_NAME_LINK && attr_id == HTML_NAME_REL) {
+			if (!wget_strncasecmp_ascii(val, "shortcut icon", len)
+				|| !wget_strncasecmp_ascii(val, "stylesheet", len)
+				|| !wget_strncasecmp_ascii(val, "preload", len))
+				ctx->link_inline = 1;
+			else
+				ctx->link_inline = 0;
+
+			if (ctx->uri_index >= 0) {
+				// href= came before rel=
+				WGET_HTML_PARSED_URL *url = wget_vector_get(res->uris, ctx->uri_index);
+				url->link_inline = ctx->link_inline;
 			}
 		}
 
-		// shortcut to avoid unneeded calls to bsearch()
-		int found = 0;
-
-		// search the static list for a tag/attr match
-		if (maybe[(unsigned char)*attr|0x20] && attr[1] && attr[2])
-			found = bsearch(attr, attrs, countof(attrs), sizeof(attrs[0]), (int(*)(const void *, const void *))wget_strcasecmp_ascii) != NULL;
+		// search the static list for a tag/attr match, then the dynamic list
+		int found = attr_name && attr_name->url_attr;
 
-		// search the dynamic list for a tag/attr match
-		if (!found && ctx->additional_tags) {
-			if (wget_vector_find(ctx->additional_tags, &(wget_html_tag_t){ .name = tag, .attribute = NULL } ) != -1
-				|| wget_vector_find(ctx->additional_tags, &(wget_html_tag_t){ .name = tag, .attribute = attr } ) != -1)
-				found = 1;
-		}
+		if (!found && ctx->additional_tags)
+			found = _tag_set_contains(ctx->additional_tags, tag, attr);
 
 		if (found) {
 			for (;len && c_isspace(*val); val++, len--); // skip leading spaces
 			for (;len && c_isspace(val[len - 1]); len--);  // skip trailing spaces
 
-			if ((*tag|0x20) == 'b' && !wget_strcasecmp_ascii(tag, "base")) {
+			if (ctx->tag_id == HTML_NAME_BASE) {
 				// found a <BASE href="...">
 				res->base.p = val;
 				res->base.len = len;
@@ -244,7 +321,7 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 
 			WGET_HTML_PARSED_URL url;
 
-			if (!wget_strcasecmp_ascii(attr, "srcset")) {
+			if (attr_id == HTML_NAME_SRCSET) {
 				// value is a list of URLs, see https://html.spec.whatwg.org/multipage/embedded-content.html#attr-img-srcset
 				while (len) {
 					const char *p;
@@ -274,7 +351,7 @@ static void _html_get_url(void *context, int flags, const char *tag, const char
 		}
 	}
 
-	if (flags & XML_FLG_CONTENT && val && len && !wget_strcasecmp_ascii(tag, "style")) {
+	if (flags & XML_FLG_CONTENT && val && len && _html_name_id(tag) == HTML_NAME_STYLE) {
 		ctx->css_dir = "style";
 		ctx->css_attr = "";
 		ctx->css_start_offset = val - ctx->html;
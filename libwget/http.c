@@ -40,6 +40,7 @@
 #include <c-ctype.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
 #ifdef HAVE_SYS_SOCKET_H
 # include <sys/socket.h>
 #elif defined HAVE_WS2TCPIP_H
@@ -55,6 +56,7 @@
 
 #include <wget.h>
 #include "private.h"
+#include "wget_probes.h"
 
 #define HTTP_CTYPE_SEPARATOR (1<<0)
 #define _http_isseparator(c) (http_ctype[(unsigned char)(c)]&HTTP_CTYPE_SEPARATOR)
@@ -85,10 +87,34 @@ static const unsigned char
 static char
 	_abort_indicator;
 
+// proxy with connect health statistics, used to prefer fast and working proxies.
+// Proxy lists hold pointers to reference counted entries, so a connection keeps its
+// proxy alive even if the list is replaced meanwhile. 'refs' is guarded by proxy_mutex.
+typedef struct {
+	wget_iri_t
+		*iri;
+	long long
+		eject_until; // don't use proxy before this time (ms)
+	int
+		latency, // exponentially weighted moving average of connect time (ms)
+		failures, // number of consecutive connect failures
+		refs; // number of references (proxy list + connections)
+} _proxy_t;
+
+// streams assumed to be allowed until the peer's SETTINGS arrive.
+// RFC 9113 6.5.2 recommends servers to allow at least 100, but some allow only a handful.
+#define HTTP2_INITIAL_MAX_STREAMS 4
+
+// a proxy is ejected after this number of consecutive failures
+#define PROXY_MAX_FAILURES 3
+
 static wget_vector_t
 	*http_proxies,
 	*https_proxies,
-	*no_proxies;
+	*no_proxies,
+	*h2c_hosts; // hosts spoken to with HTTP/2 over plain TCP
+static wget_thread_mutex_t
+	proxy_mutex = WGET_THREAD_MUTEX_INITIALIZER;
 
 int wget_http_isseparator(char c)
 {
@@ -228,6 +254,24 @@ void wget_http_add_param(wget_vector_t **params, wget_http_header_param_t *param
 	wget_vector_add(*params, param, sizeof(*param));
 }
 
+// check whether a space separated list of relation types contains 'type'
+static int _has_rel_type(const char *rel, const char *type)
+{
+	size_t len = strlen(type);
+
+	while (*rel) {
+		const char *p;
+
+		while (c_isblank(*rel)) rel++;
+		for (p = rel; *rel && !c_isblank(*rel); rel++);
+
+		if ((size_t)(rel - p) == len && !wget_strncasecmp_ascii(p, type, len))
+			return 1;
+	}
+
+	return 0;
+}
+
 /*
   Link           = "Link" ":" #link-value
   link-value     = "<" URI-Reference ">" *( ";" link-param )
@@ -284,6 +328,8 @@ const char *wget_http_parse_link(const char *s, wget_http_link_t *link)
 							link->rel = link_rel_describedby;
 						else if (!wget_strcasecmp_ascii(value, "duplicate"))
 							link->rel = link_rel_duplicate;
+						else if (_has_rel_type(value, "preload"))
+							link->rel = link_rel_preload;
 					} else if (!wget_strcasecmp_ascii(name, "pri")) {
 						link->pri = atoi(value);
 					} else if (!wget_strcasecmp_ascii(name, "type")) {
@@ -301,13 +347,39 @@ const char *wget_http_parse_link(const char *s, wget_http_link_t *link)
 			//			if (!msg->contacts) msg->contacts=vec_create(1,1,NULL);
 			//			vec_add(msg->contacts,&contact,sizeof(contact));
 
-			while (*s && !c_isblank(*s)) s++;
+			// stop at the comma separating the next link-value
+			while (*s && *s != ',' && !c_isblank(*s)) s++;
 		}
 	}
 
 	return s;
 }
 
+// A Link header may carry several comma separated links.
+// Redirections keep all of them (Metalink/HTTP), other responses just the preload hints.
+static void _add_links(wget_http_response_t *resp, const char *s)
+{
+	wget_http_link_t link;
+
+	while (s && *s) {
+		s = wget_http_parse_link(s, &link);
+
+		if (link.uri && (resp->code / 100 == 3 || link.rel == link_rel_preload)) {
+			if (!resp->links) {
+				resp->links = wget_vector_create(8, 8, NULL);
+				wget_vector_set_destructor(resp->links, (wget_vector_destructor_t)wget_http_free_link);
+			}
+			wget_vector_add(resp->links, &link, sizeof(link));
+		} else
+			wget_http_free_link(&link);
+
+		while (s && c_isblank(*s)) s++;
+		if (!s || *s != ',')
+			break;
+		s++;
+	}
+}
+
 // from RFC 3230:
 // Digest = "Digest" ":" #(instance-digest)
 // instance-digest = digest-algorithm "=" <encoded digest output>
@@ -795,14 +867,161 @@ month        = "Jan" | "Feb" | "Mar" | "Apr"
 				 | "Sep" | "Oct" | "Nov" | "Dec"
 */
 
+// three lowercase letters packed into an int, index + 1 is the month number
+static const unsigned _month_keys[12] = {
+	('j'<<16)|('a'<<8)|'n', ('f'<<16)|('e'<<8)|'b', ('m'<<16)|('a'<<8)|'r',
+	('a'<<16)|('p'<<8)|'r', ('m'<<16)|('a'<<8)|'y', ('j'<<16)|('u'<<8)|'n',
+	('j'<<16)|('u'<<8)|'l', ('a'<<16)|('u'<<8)|'g', ('s'<<16)|('e'<<8)|'p',
+	('o'<<16)|('c'<<8)|'t', ('n'<<16)|('o'<<8)|'v', ('d'<<16)|('e'<<8)|'c'
+};
+
+// returns 1..12 or 0 if s doesn't start with a month name
+static int _parse_month(const char *s)
+{
+	unsigned key;
+
+	if (!c_isalpha(s[0]) || !c_isalpha(s[1]) || !c_isalpha(s[2]))
+		return 0;
+
+	key = ((s[0] | 0x20) << 16) | ((s[1] | 0x20) << 8) | (s[2] | 0x20);
+
+	for (int it = 0; it < 12; it++) {
+		if (_month_keys[it] == key)
+			return it + 1;
+	}
+
+	return 0;
+}
+
+// parse up to 'maxdigits' decimal digits with optional leading blanks (like sscanf's %d)
+static const char *_parse_number(const char *s, int maxdigits, int *n)
+{
+	int value = 0, ndigits;
+
+	while (*s == ' ' || *s == '\t')
+		s++;
+
+	for (ndigits = 0; ndigits < maxdigits && c_isdigit(*s); ndigits++)
+		value = value * 10 + (*s++ - '0');
+
+	if (!ndigits)
+		return NULL;
+
+	*n = value;
+	return s;
+}
+
+static const char *_parse_time(const char *s, int *hour, int *min, int *sec)
+{
+	if (!(s = _parse_number(s, 2, hour)) || *s++ != ':')
+		return NULL;
+	if (!(s = _parse_number(s, 2, min)) || *s++ != ':')
+		return NULL;
+	return _parse_number(s, 2, sec);
+}
+
+static inline const char *_skip_blanks(const char *s)
+{
+	while (c_isblank(*s))
+		s++;
+	return s;
+}
+
+#define DIGIT(c) ((unsigned)((c) - '0') <= 9)
+
+// IMF-fixdate has fixed positions: "Sun, 06 Nov 1994 08:49:37 GMT"
+static int _parse_imf_fixdate(const char *s, int *day, int *mon, int *year, int *hour, int *min, int *sec)
+{
+	if (s[3] != ',' || s[4] != ' ' || s[7] != ' ' || s[11] != ' ' || s[16] != ' ' || s[19] != ':' || s[22] != ':')
+		return 0;
+
+	if (!DIGIT(s[5]) || !DIGIT(s[6]) || !DIGIT(s[12]) || !DIGIT(s[13]) || !DIGIT(s[14]) || !DIGIT(s[15])
+		|| !DIGIT(s[17]) || !DIGIT(s[18]) || !DIGIT(s[20]) || !DIGIT(s[21]) || !DIGIT(s[23]) || !DIGIT(s[24]))
+		return 0;
+
+	if (!(*mon = _parse_month(s + 8)))
+		return 0;
+
+	*day = (s[5] - '0') * 10 + (s[6] - '0');
+	*year = (s[12] - '0') * 1000 + (s[13] - '0') * 100 + (s[14] - '0') * 10 + (s[15] - '0');
+	*hour = (s[17] - '0') * 10 + (s[18] - '0');
+	*min = (s[20] - '0') * 10 + (s[21] - '0');
+	*sec = (s[23] - '0') * 10 + (s[24] - '0');
+
+	return 1;
+}
+
+// the obsolete formats, see the grammar above
+static int _parse_obsolete_date(const char *s, int *day, int *mon, int *year, int *hour, int *min, int *sec)
+{
+	if (c_isdigit(*s)) {
+		// non-standard: 1 Mar 2027 09:23:12 GMT
+		if (!(s = _parse_number(s, 9, day)))
+			return 0;
+		s = _skip_blanks(s);
+		if (!(*mon = _parse_month(s)))
+			return 0;
+		if (!(s = _parse_number(s + 3, 4, year)))
+			return 0;
+		return _parse_time(s, hour, min, sec) != NULL;
+	}
+
+	if (!c_isalpha(*s))
+		return 0;
+
+	while (c_isalpha(*s))
+		s++; // skip weekday
+
+	if (*s == ',') {
+		if (!(s = _parse_number(s + 1, 2, day)))
+			return 0;
+
+		if (*s == '-') {
+			// RFC 850 / 1036 or Netscape: Wednesday, 09-Jun-21 10:18:14 or Wed, 09-Jun-2021 10:18:14
+			if (!(*mon = _parse_month(s + 1)) || s[4] != '-')
+				return 0;
+			s += 5;
+		} else {
+			// RFC 822 / 1123 with unusual spacing: Wed,  9 Jun 2021 10:18:14 GMT
+			s = _skip_blanks(s);
+			if (!(*mon = _parse_month(s)))
+				return 0;
+			s += 3;
+		}
+
+		if (!(s = _parse_number(s, 4, year)))
+			return 0;
+		return _parse_time(s, hour, min, sec) != NULL;
+	}
+
+	// ANSI C's asctime(): Wed Jun  9 10:18:14 2021
+	if (!c_isblank(*s))
+		return 0;
+	s = _skip_blanks(s);
+	if (!(*mon = _parse_month(s)))
+		return 0;
+	if (!(s = _parse_number(s + 3, 2, day)))
+		return 0;
+	if (!(s = _parse_time(s, hour, min, sec)))
+		return 0;
+	return _parse_number(s, 4, year) != NULL;
+}
+
+#undef DIGIT
+
+#ifdef WITH_THREAD_LOCAL
+// servers send the same Date: value for a whole second, so remember the last one per thread
+static __thread char _last_parsed_date[32];
+static __thread time_t _last_parsed_time;
+static __thread time_t _last_printed_time;
+static __thread char _last_printed_date[32];
+#endif
+
 time_t wget_http_parse_full_date(const char *s)
 {
 	// we simply can't use strptime() since it requires us to setlocale()
 	// which is not thread-safe !!!
-	static const char *mnames[12] = {
-		"Jan", "Feb", "Mar","Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
-	};
-	static int days_per_month[12] = {
+	static const int days_per_month[12] = {
 		31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
 	};
 	// cumulated number of days until beginning of month for non-leap years
@@ -810,33 +1029,25 @@ time_t wget_http_parse_full_date(const char *s)
 		0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
 	};
 
-	int day, mon = 0, year, hour, min, sec, leap_month, leap_year, days;
-	char mname[4] = "";
+	int day, mon, year, hour, min, sec, leap_month, leap_year, days;
+	const char *p;
+	time_t t;
 
-	if (sscanf(s, " %*[a-zA-Z], %02d %3s %4d %2d:%2d:%2d", &day, mname, &year, &hour, &min, &sec) >= 6) {
-		// RFC 822 / 1123: Wed, 09 Jun 2021 10:18:14 GMT
-	}
-	else if (sscanf(s, " %*[a-zA-Z], %2d-%3s-%4d %2d:%2d:%2d", &day, mname, &year, &hour, &min, &sec) >= 6) {
-		// RFC 850 / 1036 or Netscape: Wednesday, 09-Jun-21 10:18:14 or Wed, 09-Jun-2021 10:18:14
-	}
-	else if (sscanf(s, " %*[a-zA-Z] %3s %2d %2d:%2d:%2d %4d", mname, &day, &hour, &min, &sec, &year) >= 6) {
-		// ANSI C's asctime(): Wed Jun 09 10:18:14 2021
-	}
-	else if (sscanf(s, " %d %3s %4d %2d:%2d:%2d", &day, mname, &year, &hour, &min, &sec) >= 6) {
-		// non-standard: 1 Mar 2027 09:23:12 GMT
-	} else {
-		error_printf(_("Failed to parse date '%s'\n"), s);
-		return 0; // return as session cookie
-	}
+	while (c_isspace(*s))
+		s++;
 
-	if (*mname) {
-		unsigned it;
+#ifdef WITH_THREAD_LOCAL
+	if (*_last_parsed_date && !strcmp(s, _last_parsed_date))
+		return _last_parsed_time;
+#endif
 
-		for (it = 0; it < countof(mnames); it++) {
-			if (!wget_strcasecmp_ascii(mname, mnames[it])) {
-				mon = it + 1;
-				break;
-			}
+	// the fixed-position check never reads past the terminating 0 of shorter strings
+	for (p = s; *p && p - s < 25; p++);
+
+	if (p - s < 25 || !_parse_imf_fixdate(s, &day, &mon, &year, &hour, &min, &sec)) {
+		if (!_parse_obsolete_date(s, &day, &mon, &year, &hour, &min, &sec)) {
+			error_printf(_("Failed to parse date '%s'\n"), s);
+			return 0; // return as session cookie
 		}
 	}
 
@@ -862,28 +1073,96 @@ time_t wget_http_parse_full_date(const char *s)
 	days += sum_of_days[mon - 1] + (mon > 2 && leap_year);
 	days += day - 1;
 
-	return (((time_t)days * 24 + hour) * 60 + min) * 60 + sec;
+	t = (((time_t)days * 24 + hour) * 60 + min) * 60 + sec;
+
+#ifdef WITH_THREAD_LOCAL
+	if (strlen(s) < sizeof(_last_parsed_date)) {
+		strcpy(_last_parsed_date, s);
+		_last_parsed_time = t;
+	}
+#endif
+
+	return t;
 }
 
 char *wget_http_print_date(time_t t, char *buf, size_t bufsize)
 {
-	static const char *dnames[7] = {
+	static const char dnames[7][4] = {
 		"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
 	};
-	static const char *mnames[12] = {
+	static const char mnames[12][4] = {
 		"Jan", "Feb", "Mar","Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
 	};
+	static const char digits2[100][2] = {
+		"00", "01", "02", "03", "04", "05", "06", "07", "08", "09",
+		"10", "11", "12", "13", "14", "15", "16", "17", "18", "19",
+		"20", "21", "22", "23", "24", "25", "26", "27", "28", "29",
+		"30", "31", "32", "33", "34", "35", "36", "37", "38", "39",
+		"40", "41", "42", "43", "44", "45", "46", "47", "48", "49",
+		"50", "51", "52", "53", "54", "55", "56", "57", "58", "59",
+		"60", "61", "62", "63", "64", "65", "66", "67", "68", "69",
+		"70", "71", "72", "73", "74", "75", "76", "77", "78", "79",
+		"80", "81", "82", "83", "84", "85", "86", "87", "88", "89",
+		"90", "91", "92", "93", "94", "95", "96", "97", "98", "99"
+	};
+	char tmp[64], *p = tmp;
 	struct tm tm;
+	size_t len;
 
 	if (!bufsize)
 		return buf;
 
-	if (gmtime_r(&t, &tm)) {
+#ifdef WITH_THREAD_LOCAL
+	if (t == _last_printed_time && *_last_printed_date) {
+		len = strlen(_last_printed_date);
+		p = _last_printed_date;
+		goto out;
+	}
+#endif
+
+	if (!gmtime_r(&t, &tm)) {
+		*buf = 0;
+		return buf;
+	}
+
+	if (tm.tm_year + 1900 < 1000 || tm.tm_year + 1900 > 9999) {
+		// not representable as IMF-fixdate anyways
 		snprintf(buf, bufsize, "%s, %02d %s %d %02d:%02d:%02d GMT",
 			dnames[tm.tm_wday],tm.tm_mday,mnames[tm.tm_mon],tm.tm_year+1900,
 			tm.tm_hour, tm.tm_min, tm.tm_sec);
-	} else
-		*buf = 0;
+		return buf;
+	}
+
+	memcpy(p, dnames[tm.tm_wday], 3); p += 3;
+	*p++ = ',';
+	*p++ = ' ';
+	memcpy(p, digits2[tm.tm_mday], 2); p += 2;
+	*p++ = ' ';
+	memcpy(p, mnames[tm.tm_mon], 3); p += 3;
+	*p++ = ' ';
+	memcpy(p, digits2[(tm.tm_year + 1900) / 100], 2); p += 2;
+	memcpy(p, digits2[(tm.tm_year + 1900) % 100], 2); p += 2;
+	*p++ = ' ';
+	memcpy(p, digits2[tm.tm_hour], 2); p += 2;
+	*p++ = ':';
+	memcpy(p, digits2[tm.tm_min], 2); p += 2;
+	*p++ = ':';
+	memcpy(p, digits2[tm.tm_sec], 2); p += 2;
+	memcpy(p, " GMT", 5); p += 4;
+
+	len = p - tmp;
+	p = tmp;
+
+#ifdef WITH_THREAD_LOCAL
+	memcpy(_last_printed_date, tmp, len + 1);
+	_last_printed_time = t;
+
+out:
+#endif
+	if (len >= bufsize)
+		len = bufsize - 1;
+	memcpy(buf, p, len);
+	buf[len] = 0;
 
 	return buf;
 }
@@ -1093,16 +1372,8 @@ wget_http_response_t *wget_http_parse_response_header(char *buf)
 			} else if (resp->code / 100 == 3 && !wget_strncasecmp_ascii(name, "Location", namelen)) {
 				xfree(resp->location);
 				wget_http_parse_location(s, &resp->location);
-			} else if (resp->code / 100 == 3 && !wget_strncasecmp_ascii(name, "Link", namelen)) {
-				// debug_printf("s=%.31s\n",s);
-				wget_http_link_t link;
-				wget_http_parse_link(s, &link);
-				// debug_printf("link->uri=%s\n",link.uri);
-				if (!resp->links) {
-					resp->links = wget_vector_create(8, 8, NULL);
-					wget_vector_set_destructor(resp->links, (wget_vector_destructor_t)wget_http_free_link);
-				}
-				wget_vector_add(resp->links, &link, sizeof(link));
+			} else if (!wget_strncasecmp_ascii(name, "Link", namelen)) {
+				_add_links(resp, s);
 			}
 			break;
 		case 'p':
@@ -1265,6 +1536,8 @@ void wget_http_free_response(wget_http_response_t **resp)
 		xfree((*resp)->etag);
 		// xfree((*resp)->reason);
 		wget_buffer_free(&(*resp)->header);
+		if ((*resp)->body)
+			memstats_free(WGET_MEMTAG_HTTP_BUFFERS, (*resp)->body->size);
 		wget_buffer_free(&(*resp)->body);
 		xfree(*resp);
 	}
@@ -1285,11 +1558,23 @@ void wget_http_free_request(wget_http_request_t **req)
 // This is the default function for collecting body data
 static int _body_callback(wget_http_response_t *resp, void *user_data G_GNUC_WGET_UNUSED, const char *data, size_t length)
 {
-	if (!resp->body)
-		resp->body = wget_buffer_alloc(102400);
+	if (!resp->body) {
+		// with a sane Content-Length we allocate the body just once
+		if (resp->content_length_valid && resp->content_length >= 102400 && resp->content_length <= 10 * 1024 * 1024)
+			resp->body = wget_buffer_alloc(resp->content_length);
+		else
+			resp->body = wget_buffer_alloc(102400);
+
+		memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, resp->body->size);
+	}
+
+	size_t size = resp->body->size;
 
 	wget_buffer_memcat(resp->body, data, length);
 
+	if (resp->body->size != size)
+		memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, resp->body->size - size);
+
 	return 0;
 }
 
@@ -1325,10 +1610,25 @@ void wget_http_request_set_body_cb(wget_http_request_t *req, wget_http_body_call
 	req->body_user_data = user_data;
 }
 
+// the callback gets the body as received from the wire, e.g. to archive it (chunked and compressed as sent by the server)
+void wget_http_request_set_raw_body_cb(wget_http_request_t *req, wget_http_body_callback_t callback, void *user_data)
+{
+	req->raw_body_callback = callback;
+	req->raw_body_user_data = user_data;
+}
+
+static void _raw_body(wget_http_response_t *resp, const char *data, size_t length)
+{
+	if (resp->req->raw_body_callback && length)
+		resp->req->raw_body_callback(resp, resp->req->raw_body_user_data, data, length);
+}
+
 void wget_http_request_set_int(wget_http_request_t *req, int key, int value)
 {
 	switch (key) {
 	case WGET_HTTP_RESPONSE_KEEPHEADER: req->response_keepheader = !!value; break;
+	case WGET_HTTP_RESPONSE_KEEP_ENCODING: req->response_keep_encoding = !!value; break;
+	case WGET_HTTP_DECOMPRESS_BUFFER_SIZE: req->decompress_buffer_size = value > 0 ? value : 0; break;
 	default: error_printf(_("%s: Unknown key %d (or value must not be an integer)\n"), __func__, key);
 	}
 }
@@ -1337,6 +1637,8 @@ int wget_http_request_get_int(wget_http_request_t *req, int key)
 {
 	switch (key) {
 	case WGET_HTTP_RESPONSE_KEEPHEADER: return req->response_keepheader;
+	case WGET_HTTP_RESPONSE_KEEP_ENCODING: return req->response_keep_encoding;
+	case WGET_HTTP_DECOMPRESS_BUFFER_SIZE: return req->decompress_buffer_size;
 	default:
 		error_printf(_("%s: Unknown key %d (or value must not be an integer)\n"), __func__, key);
 		return -1;
@@ -1606,22 +1908,43 @@ static int _on_frame_send_callback(nghttp2_session *session G_GNUC_WGET_UNUSED,
 }
 
 static int _on_frame_recv_callback(nghttp2_session *session,
-	const nghttp2_frame *frame, void *user_data G_GNUC_WGET_UNUSED)
+	const nghttp2_frame *frame, void *user_data)
 {
 	_print_frame_type(frame->hd.type, '<', frame->hd.stream_id);
 
+	// the peer may change its stream limit at any time
+	if (frame->hd.type == NGHTTP2_SETTINGS && !(frame->hd.flags & NGHTTP2_FLAG_ACK)) {
+		wget_http_connection_t *conn = (wget_http_connection_t *) user_data;
+		uint32_t max_streams = nghttp2_session_get_remote_settings(session, NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
+
+		conn->http2_max_streams = max_streams > INT_MAX ? INT_MAX : (int) max_streams;
+		debug_printf("HTTP/2 peer allows %d concurrent streams\n", conn->http2_max_streams);
+	}
+
 	// header callback after receiving all header tags
 	if (frame->hd.type == NGHTTP2_HEADERS) {
 		struct _http2_stream_context *ctx = nghttp2_session_get_stream_user_data(session, frame->hd.stream_id);
 		wget_http_response_t *resp = ctx ? ctx->resp : NULL;
 
 		if (resp) {
+			WGET_PROBE2(http_response_first_byte, resp->req->esc_host.data, resp->req->esc_resource.data);
+
 			if (resp->header && resp->req->header_callback) {
 				resp->req->header_callback(resp, resp->req->header_user_data);
 			}
 
-			if (!ctx->decompressor)
-				ctx->decompressor = wget_decompress_open(resp->content_encoding, _get_body, resp);
+			if (resp->code / 100 == 1) {
+				// an interim response, the code is kept until the final response header replaces it
+				wget_http_free_links(&resp->links);
+				if (resp->header)
+					wget_buffer_reset(resp->header);
+			}
+			// the header callback may decide to keep the encoded body
+			else if (!ctx->decompressor) {
+				ctx->decompressor = wget_decompress_open(resp->req->response_keep_encoding ?
+					wget_content_encoding_identity : resp->content_encoding, _get_body, resp);
+				wget_decompress_set_buffer(ctx->decompressor, NULL, resp->req->decompress_buffer_size);
+			}
 		}
 	}
 
@@ -1644,7 +1967,10 @@ static int _on_header_callback(nghttp2_session *session,
 	}
 
 	if (frame->hd.type == NGHTTP2_HEADERS) {
-		if (frame->headers.cat == NGHTTP2_HCAT_RESPONSE) {
+		// the final response header of a stream follows its interim responses (e.g. 103 Early Hints)
+		if (frame->headers.cat == NGHTTP2_HCAT_RESPONSE
+			|| (frame->headers.cat == NGHTTP2_HCAT_HEADERS && resp && resp->code / 100 == 1))
+		{
 			const char *s = wget_strmemdup((char *) value, valuelen);
 
 			debug_printf("%.*s: %s\n", (int) namelen, name, s);
@@ -1660,16 +1986,8 @@ static int _on_header_callback(nghttp2_session *session,
 			case 4:
 				if (!memcmp(name, "etag", namelen)) {
 					wget_http_parse_etag(s, &resp->etag);
-				} else if (!memcmp(name, "link", namelen) && resp->code / 100 == 3) {
-					// debug_printf("s=%.31s\n",s);
-					wget_http_link_t link;
-					wget_http_parse_link(s, &link);
-					// debug_printf("link->uri=%s\n",link.uri);
-					if (!resp->links) {
-						resp->links = wget_vector_create(8, 8, NULL);
-						wget_vector_set_destructor(resp->links, (wget_vector_destructor_t)wget_http_free_link);
-					}
-					wget_vector_add(resp->links, &link, sizeof(link));
+				} else if (!memcmp(name, "link", namelen)) {
+					_add_links(resp, s);
 				}
 				break;
 			case 6:
@@ -1799,6 +2117,7 @@ static int _on_stream_close_callback(nghttp2_session *session, int32_t stream_id
 		wget_vector_add_noalloc(conn->received_http2_responses, ctx->resp);
 		wget_decompress_close(ctx->decompressor);
 		xfree(ctx);
+		memstats_free(WGET_MEMTAG_HTTP2_STREAMS, sizeof(struct _http2_stream_context) + sizeof(wget_http_response_t));
 	}
 
 	return 0;
@@ -1817,6 +2136,7 @@ static int _on_data_chunk_recv_callback(nghttp2_session *session,
 //		debug_printf("[INFO] C <---------------------------- S%d (DATA chunk - %zu bytes)\n", stream_id, len);
 		debug_printf("nbytes %zu\n", len);
 		ctx->resp->cur_downloaded += len;
+		_raw_body(ctx->resp, (const char *) data, len);
 		wget_decompress(ctx->decompressor, (char *) data, len);
 	}
 	return 0;
@@ -1834,18 +2154,119 @@ static void setup_nghttp2_callbacks(nghttp2_session_callbacks *callbacks)
 }
 #endif
 
+// Select the proxy to use from a list of proxies.
+// Ejected proxies are skipped, from the remaining ones the proxy with the lowest
+// connect latency is taken. Proxies without measurements yet are preferred to get them probed.
+// Ties are broken round-robin, starting at *next.
+// If all proxies are ejected, the one with the earliest ejection deadline is returned.
+static _proxy_t *_select_proxy(wget_vector_t *proxies, int *next)
+{
+	_proxy_t *best = NULL, *ejected = NULL;
+	long long now = wget_get_timemillis();
+	int n = wget_vector_size(proxies);
+
+	*next = (*next + 1) % n;
+
+	for (int it = 0; it < n; it++) {
+		_proxy_t *proxy = *(_proxy_t **) wget_vector_get(proxies, (*next + it) % n);
+
+		if (proxy->eject_until > now) {
+			if (!ejected || proxy->eject_until < ejected->eject_until)
+				ejected = proxy;
+		} else if (!best || proxy->latency < best->latency)
+			best = proxy;
+	}
+
+	if (!best)
+		best = ejected;
+
+	best->refs++;
+
+	return best;
+}
+
+// Drop a reference to a proxy, proxy_mutex has to be held
+static void _unref_proxy(_proxy_t *proxy)
+{
+	if (--proxy->refs == 0) {
+		wget_iri_free(&proxy->iri);
+		xfree(proxy);
+	}
+}
+
+// Update health statistics of a proxy after a connect attempt.
+// A non-blocking connect (or TCP Fast Open) reports a refused connection not before the
+// first request is sent, so a successful connect is accounted by _proxy_connected().
+// The latency then is the time until the first response bytes arrived.
+// On success the latency average is updated (weight 1/4 for the new value) and the failures reset.
+// On failure, the proxy is ejected for an exponentially growing amount of time
+// after PROXY_MAX_FAILURES consecutive failures.
+static void _update_proxy(_proxy_t *proxy, int rc, long long latency)
+{
+	wget_thread_mutex_lock(&proxy_mutex);
+
+	if (rc == WGET_E_SUCCESS) {
+		if (proxy->latency)
+			proxy->latency = (int) ((proxy->latency * 3 + latency) / 4);
+		else
+			proxy->latency = (int) latency;
+		if (proxy->latency <= 0)
+			proxy->latency = 1; // 0 is reserved for 'not measured yet'
+		proxy->failures = 0;
+		proxy->eject_until = 0;
+	} else if (++proxy->failures >= PROXY_MAX_FAILURES) {
+		int shift = proxy->failures - PROXY_MAX_FAILURES;
+
+		proxy->eject_until = wget_get_timemillis() + (1000LL << (shift < 8 ? shift : 8));
+		debug_printf("proxy %s:%s ejected for %lld ms after %d failures\n",
+			proxy->iri->host, proxy->iri->resolv_port, 1000LL << (shift < 8 ? shift : 8), proxy->failures);
+	} else {
+		// a single failure makes the proxy less attractive until it proved to be working again
+		proxy->latency = proxy->latency ? proxy->latency * 2 : 1000;
+	}
+
+	debug_printf("proxy %s:%s: latency=%d failures=%d\n", proxy->iri->host, proxy->iri->resolv_port, proxy->latency, proxy->failures);
+
+	wget_thread_mutex_unlock(&proxy_mutex);
+}
+
+// Account the connect to a proxy when the first response arrived (rc == 0),
+// or the first request failed to send or got no answer (rc != 0)
+static void _proxy_connected(wget_http_connection_t *conn, int rc)
+{
+	if (conn->proxy) {
+		_update_proxy(conn->proxy, rc ? WGET_E_CONNECT : WGET_E_SUCCESS, wget_get_timemillis() - conn->proxy_start);
+		wget_thread_mutex_lock(&proxy_mutex);
+		_unref_proxy(conn->proxy);
+		wget_thread_mutex_unlock(&proxy_mutex);
+		conn->proxy = NULL;
+	}
+}
+
+static int _match_h2c_host(const char *host)
+{
+	for (int it = 0; it < wget_vector_size(h2c_hosts); it++) {
+		if (!strcmp(wget_vector_get(h2c_hosts, it), "*"))
+			return 1;
+	}
+
+	return wget_http_match_no_proxy(h2c_hosts, host);
+}
+
 int wget_http_open(wget_http_connection_t **_conn, const wget_iri_t *iri)
 {
 	static int next_http_proxy = -1;
 	static int next_https_proxy = -1;
-	static wget_thread_mutex_t
-		mutex = WGET_THREAD_MUTEX_INITIALIZER;
 
 	wget_http_connection_t
 		*conn;
+	_proxy_t
+		*proxy = NULL;
 	const char
 		*port,
 		*host;
+	long long
+		start;
 	int
 		rc,
 		ssl = iri->scheme == WGET_IRI_SCHEME_HTTPS;
@@ -1859,21 +2280,18 @@ int wget_http_open(wget_http_connection_t **_conn, const wget_iri_t *iri)
 	port = iri->resolv_port;
 
 	if (!wget_http_match_no_proxy(no_proxies, iri->host)) {
-		wget_iri_t *proxy;
-
-		wget_thread_mutex_lock(&mutex);
-		if (iri->scheme == WGET_IRI_SCHEME_HTTP && http_proxies) {
-			proxy = wget_vector_get(http_proxies, (++next_http_proxy) % wget_vector_size(http_proxies));
-			host = proxy->host;
-			port = proxy->resolv_port;
-			conn->proxied = 1;
-		} else if (iri->scheme == WGET_IRI_SCHEME_HTTPS && https_proxies) {
-			proxy = wget_vector_get(https_proxies, (++next_https_proxy) % wget_vector_size(https_proxies));
-			host = proxy->host;
-			port = proxy->resolv_port;
+		wget_thread_mutex_lock(&proxy_mutex);
+		if (iri->scheme == WGET_IRI_SCHEME_HTTP && http_proxies)
+			proxy = _select_proxy(http_proxies, &next_http_proxy);
+		else if (iri->scheme == WGET_IRI_SCHEME_HTTPS && https_proxies)
+			proxy = _select_proxy(https_proxies, &next_https_proxy);
+		wget_thread_mutex_unlock(&proxy_mutex);
+
+		if (proxy) {
+			host = proxy->iri->host;
+			port = proxy->iri->resolv_port;
 			conn->proxied = 1;
 		}
-		wget_thread_mutex_unlock(&mutex);
 	}
 
 	conn->tcp = wget_tcp_init();
@@ -1882,12 +2300,31 @@ int wget_http_open(wget_http_connection_t **_conn, const wget_iri_t *iri)
 		wget_tcp_set_ssl_hostname(conn->tcp, host); // enable host name checking
 	}
 
-	if ((rc = wget_tcp_connect(conn->tcp, host, port)) == WGET_E_SUCCESS) {
+	start = wget_get_timemillis();
+	rc = wget_tcp_connect(conn->tcp, host, port);
+
+	if (proxy && rc != WGET_E_SUCCESS) {
+		_update_proxy(proxy, rc, wget_get_timemillis() - start);
+		wget_thread_mutex_lock(&proxy_mutex);
+		_unref_proxy(proxy);
+		wget_thread_mutex_unlock(&proxy_mutex);
+	}
+
+	if (rc == WGET_E_SUCCESS) {
+		conn->proxy = proxy;
+		conn->proxy_start = start;
 		conn->esc_host = iri->host ? wget_strdup(iri->host) : NULL;
 		conn->port = iri->resolv_port;
 		conn->scheme = iri->scheme;
 		conn->buf = wget_buffer_alloc(102400); // reusable buffer, large enough for most requests and responses
+		memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, conn->buf->size);
 #ifdef WITH_LIBNGHTTP2
+		// HTTP/2 with prior knowledge (h2c), a proxy in between only speaks HTTP/1.1
+		if (!ssl && !proxy && _match_h2c_host(iri->host)) {
+			debug_printf("using HTTP/2 without TLS for %s\n", iri->host);
+			wget_tcp_set_protocol(conn->tcp, WGET_PROTOCOL_HTTP_2_0);
+		}
+
 		if ((conn->protocol = wget_tcp_get_protocol(conn->tcp)) == WGET_PROTOCOL_HTTP_2_0) {
 			nghttp2_session_callbacks *callbacks;
 
@@ -1919,6 +2356,9 @@ int wget_http_open(wget_http_connection_t **_conn, const wget_iri_t *iri)
 			}
 
 			conn->received_http2_responses = wget_vector_create(16, -2, NULL);
+
+			// until the peer's SETTINGS arrive, a few parallel requests are risked
+			conn->http2_max_streams = HTTP2_INITIAL_MAX_STREAMS;
 		} else
 			conn->pending_requests = wget_vector_create(16, -2, NULL);
 #else
@@ -1931,6 +2371,57 @@ int wget_http_open(wget_http_connection_t **_conn, const wget_iri_t *iri)
 	return rc;
 }
 
+/*
+ * Number of requests the peer accepts in parallel on 'conn':
+ * the peer's SETTINGS_MAX_CONCURRENT_STREAMS for HTTP/2, else 1.
+ */
+int wget_http_get_max_streams(const wget_http_connection_t *conn)
+{
+#ifdef WITH_LIBNGHTTP2
+	if (conn->protocol == WGET_PROTOCOL_HTTP_2_0)
+		return conn->http2_max_streams;
+#endif
+
+	return 1;
+}
+
+/*
+ * Check if a request for 'iri' may be sent over 'conn'.
+ * Besides a connection to the same host, scheme and port, an unproxied HTTP/2 connection
+ * is coalesced for another host name if that name resolves to the connected address and
+ * the server's certificate is valid for it (RFC 7540, 9.1.1).
+ * Other connections are never coalesced, so they are never checked by address.
+ */
+int wget_http_match_connection(wget_http_connection_t *conn, const wget_iri_t *iri)
+{
+	if (!conn || !iri)
+		return 0;
+
+	if (!wget_strcmp(conn->esc_host, iri->host) && conn->scheme == iri->scheme && !wget_strcmp(conn->port, iri->resolv_port))
+		return 1;
+
+#ifdef WITH_LIBNGHTTP2
+	if (conn->protocol != WGET_PROTOCOL_HTTP_2_0 || conn->proxied
+		|| conn->scheme != WGET_IRI_SCHEME_HTTPS || iri->scheme != WGET_IRI_SCHEME_HTTPS
+		|| wget_strcmp(conn->port, iri->resolv_port))
+		return 0;
+
+	// a proxied host needs a connection to the proxy
+	if (https_proxies && !wget_http_match_no_proxy(no_proxies, iri->host))
+		return 0;
+
+	// the certificate check is done in memory, the address check needs a DNS lookup
+	if (wget_ssl_check_peer_hostname(conn->tcp, iri->host)
+		&& wget_tcp_is_connected_to(conn->tcp, iri->host, iri->resolv_port))
+	{
+		debug_printf("coalescing %s with the HTTP/2 connection to %s\n", iri->host, conn->esc_host);
+		return 1;
+	}
+#endif
+
+	return 0;
+}
+
 void wget_http_close(wget_http_connection_t **conn)
 {
 	if (*conn) {
@@ -1946,11 +2437,19 @@ void wget_http_close(wget_http_connection_t **conn)
 		wget_vector_free(&(*conn)->received_http2_responses);
 #endif
 		wget_tcp_deinit(&(*conn)->tcp);
+		if ((*conn)->proxy) {
+			// closed before the first request has been sent
+			wget_thread_mutex_lock(&proxy_mutex);
+			_unref_proxy((*conn)->proxy);
+			wget_thread_mutex_unlock(&proxy_mutex);
+		}
 //		if (!wget_tcp_get_dns_caching())
 //			freeaddrinfo((*conn)->addrinfo);
 		xfree((*conn)->esc_host);
 		// xfree((*conn)->port);
 		// xfree((*conn)->scheme);
+		if ((*conn)->buf)
+			memstats_free(WGET_MEMTAG_HTTP_BUFFERS, (*conn)->buf->size);
 		wget_buffer_free(&(*conn)->buf);
 		wget_vector_clear_nofree((*conn)->pending_requests);
 		wget_vector_free(&(*conn)->pending_requests);
@@ -1973,6 +2472,8 @@ int wget_http_send_request(wget_http_connection_t *conn, wget_http_request_t *re
 {
 	ssize_t nbytes;
 
+	WGET_PROBE3(http_request_send, req->method, req->esc_host.data, req->esc_resource.data);
+
 #ifdef WITH_LIBNGHTTP2
 	if (wget_tcp_get_protocol(conn->tcp) == WGET_PROTOCOL_HTTP_2_0) {
 		int n = 4 + wget_vector_size(req->headers);
@@ -2019,8 +2520,13 @@ int wget_http_send_request(wget_http_connection_t *conn, wget_http_request_t *re
 			return -1;
 		}
 
+		memstats_alloc(WGET_MEMTAG_HTTP2_STREAMS, sizeof(struct _http2_stream_context) + sizeof(wget_http_response_t));
+
 		conn->pending_http2_requests++;
 
+		// HTTP/2 to a proxy implies a completed TLS handshake
+		_proxy_connected(conn, 0);
+
 		debug_printf("HTTP2 stream id %d\n", req->stream_id);
 
 		return 0;
@@ -2035,7 +2541,10 @@ int wget_http_send_request(wget_http_connection_t *conn, wget_http_request_t *re
 	if (wget_tcp_write(conn->tcp, conn->buf->data, nbytes) != nbytes) {
 		// An error will be written by the wget_tcp_write function.
 		// error_printf(_("Failed to send %zd bytes (%d)\n"), nbytes, errno);
-		return -1;
+		int rc = wget_tcp_get_error(conn->tcp);
+
+		_proxy_connected(conn, -1);
+		return rc ? rc : WGET_E_UNKNOWN;
 	}
 
 	wget_vector_add_noalloc(conn->pending_requests, req);
@@ -2148,6 +2657,7 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 		resp = wget_vector_get(conn->received_http2_responses, 0); // should use double linked lists here
 		if (resp) {
 			debug_printf("  ##  response status %d\n", resp->code);
+			WGET_PROBE4(http_response_done, resp->req->esc_host.data, resp->req->esc_resource.data, resp->code, resp->cur_downloaded);
 			wget_vector_remove_nofree(conn->received_http2_responses, 0);
 
 			// a workaround for broken server configurations
@@ -2179,17 +2689,19 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 
 	while ((nbytes = wget_tcp_read(conn->tcp, buf + nread, bufsize - nread)) > 0) {
 		debug_printf("nbytes %zd nread %zd %zu\n", nbytes, nread, bufsize);
+		if (!nread)
+			WGET_PROBE2(http_response_first_byte, req->esc_host.data, req->esc_resource.data);
 		nread += nbytes;
 		buf[nread] = 0; // 0-terminate to allow string functions
 
 		if (nread < 4) continue;
 
-		if (nread == nbytes)
+		if (nread - nbytes <= 3)
 			p = buf;
 		else
 			p = buf + nread - nbytes - 3;
 
-		if ((p = strstr(p, "\r\n\r\n"))) {
+		while ((p = strstr(p, "\r\n\r\n"))) {
 			// found end-of-header
 			*p = 0;
 
@@ -2219,6 +2731,16 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 					goto cleanup; // stop requested by callback function
 			}
 
+			if (resp->code / 100 == 1 && resp->code != 101) {
+				// an interim response (e.g. 103 Early Hints), the final response follows
+				p += 4;
+				nread -= p - buf;
+				memmove(buf, p, nread + 1);
+				wget_http_free_response(&resp);
+				p = buf;
+				continue;
+			}
+
 			if (req && !wget_strcasecmp_ascii(req->method, "HEAD"))
 				goto cleanup; // a HEAD response won't have a body
 
@@ -2226,12 +2748,20 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 			break;
 		}
 
+		if (resp)
+			break; // found the final response header
+
 		if ((size_t)nread + 1024 > bufsize) {
 			wget_buffer_ensure_capacity(conn->buf, bufsize + 1024);
+			memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, conn->buf->size - bufsize);
 			buf = conn->buf->data;
 			bufsize = conn->buf->size;
 		}
 	}
+
+	// a proxy that accepts connections but drops them without an answer is failing as well
+	_proxy_connected(conn, nread ? 0 : -1);
+
 	if (!nread) goto cleanup;
 
 	if (!resp || resp->code / 100 == 1 || resp->code == 204 || resp->code == 304 ||
@@ -2241,7 +2771,9 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 		goto cleanup;
 	}
 
-	dc = wget_decompress_open(resp->content_encoding, _get_body, resp);
+	// the header callback may decide to keep the encoded body
+	dc = wget_decompress_open(req->response_keep_encoding ? wget_content_encoding_identity : resp->content_encoding, _get_body, resp);
+	wget_decompress_set_buffer(dc, NULL, req->decompress_buffer_size);
 
 	// calculate number of body bytes so far read
 	body_len = nread - (p - buf);
@@ -2249,6 +2781,7 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 	memmove(buf, p, body_len);
 	buf[body_len] = 0;
 	resp->cur_downloaded = body_len;
+	_raw_body(resp, buf, body_len);
 
 	if (resp->transfer_encoding == transfer_encoding_chunked) {
 		size_t chunk_size = 0;
@@ -2302,6 +2835,7 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 				if ((nbytes = wget_tcp_read(conn->tcp, buf + body_len, bufsize - body_len)) <= 0)
 					goto cleanup;
 
+				_raw_body(resp, buf + body_len, nbytes);
 				body_len += nbytes;
 				buf[body_len] = 0;
 				debug_printf("a nbytes %zd body_len %zu\n", nbytes, body_len);
@@ -2330,6 +2864,7 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 					if ((nbytes = wget_tcp_read(conn->tcp, buf + body_len, bufsize - body_len)) <= 0)
 						goto cleanup;
 
+					_raw_body(resp, buf + body_len, nbytes);
 					body_len += nbytes;
 					buf[body_len] = 0;
 					end = buf;
@@ -2367,6 +2902,7 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 				if ((nbytes = wget_tcp_read(conn->tcp, buf, bufsize)) <= 0)
 					goto cleanup;
 				debug_printf("a nbytes=%zd chunk_size=%zu\n", nread, chunk_size);
+				_raw_body(resp, buf, nbytes);
 
 				if (chunk_size <= (size_t)nbytes) {
 					if (chunk_size == 1 || !strncmp(buf + chunk_size - 2, "\r\n", 2)) {
@@ -2416,6 +2952,7 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 			body_len += nbytes;
 			debug_printf("nbytes %zd total %zu/%zu\n", nbytes, body_len, resp->content_length);
 			resp->cur_downloaded += nbytes;
+			_raw_body(resp, buf, nbytes);
 			wget_decompress(dc, buf, nbytes);
 		}
 		if (nbytes < 0)
@@ -2436,6 +2973,7 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 			body_len += nbytes;
 			debug_printf("nbytes %zd total %zu\n", nbytes, body_len);
 			resp->cur_downloaded += nbytes;
+			_raw_body(resp, buf, nbytes);
 			wget_decompress(dc, buf, nbytes);
 		}
 		resp->content_length = body_len;
@@ -2444,6 +2982,14 @@ wget_http_response_t *wget_http_get_response_cb(wget_http_connection_t *conn)
 cleanup:
 	wget_decompress_close(dc);
 
+	if (req) {
+		WGET_PROBE4(http_response_done, req->esc_host.data, req->esc_resource.data, resp ? resp->code : 0, resp ? resp->cur_downloaded : 0);
+
+		// the request is owned by the response, an unanswered one is released here
+		if (!resp)
+			wget_http_free_request(&req);
+	}
+
 	return resp;
 }
 
@@ -2464,6 +3010,12 @@ wget_http_response_t *wget_http_get_response(wget_http_connection_t *conn)
 	return resp;
 }
 
+// vector destructor, called with proxy_mutex being held
+static void _free_proxy(_proxy_t **proxy)
+{
+	_unref_proxy(*proxy);
+}
+
 static wget_vector_t *_parse_proxies(const char *proxy, const char *encoding)
 {
 	if (!proxy)
@@ -2473,23 +3025,29 @@ static wget_vector_t *_parse_proxies(const char *proxy, const char *encoding)
 	const char *s, *p;
 
 	proxies = wget_vector_create(8, -2, NULL);
-	wget_vector_set_destructor(proxies, (wget_vector_destructor_t)wget_iri_free_content);
+	wget_vector_set_destructor(proxies, (wget_vector_destructor_t)_free_proxy);
 
 	for (s = p = proxy; *p; s = p + 1) {
 		while (c_isspace(*s) && s < p) s++;
 
 		if ((p = strchrnul(s, ',')) != s && p - s < 256) {
 			wget_iri_t *iri;
+			_proxy_t *entry;
 			char host[p - s + 1];
 
 			memcpy(host, s, p - s);
 			host[p - s] = 0;
 			iri = wget_iri_parse (host, encoding);
 			if (!iri) {
+				wget_thread_mutex_lock(&proxy_mutex);
 				wget_vector_free(&proxies);
+				wget_thread_mutex_unlock(&proxy_mutex);
 				return NULL;
 			}
-			wget_vector_add_noalloc(proxies, iri);
+			entry = xcalloc(1, sizeof(_proxy_t));
+			entry->iri = iri;
+			entry->refs = 1;
+			wget_vector_add(proxies, &entry, sizeof(entry));
 		}
 	}
 
@@ -2539,11 +3097,15 @@ static wget_vector_t *_parse_no_proxies(const char *no_proxy, const char *encodi
 
 int wget_http_set_http_proxy(const char *proxy, const char *encoding)
 {
-	if (http_proxies)
-		wget_vector_free(&http_proxies);
+	wget_vector_t *proxies = _parse_proxies(proxy, encoding);
+
+	// connections still using a proxy of the old list keep a reference to it
+	wget_thread_mutex_lock(&proxy_mutex);
+	wget_vector_free(&http_proxies);
+	http_proxies = proxies;
+	wget_thread_mutex_unlock(&proxy_mutex);
 
-	http_proxies = _parse_proxies(proxy, encoding);
-	if (!http_proxies)
+	if (!proxies)
 		return -1;
 
 	return 0;
@@ -2551,11 +3113,15 @@ int wget_http_set_http_proxy(const char *proxy, const char *encoding)
 
 int wget_http_set_https_proxy(const char *proxy, const char *encoding)
 {
-	if (https_proxies)
-		wget_vector_free(&https_proxies);
+	wget_vector_t *proxies = _parse_proxies(proxy, encoding);
 
-	https_proxies = _parse_proxies(proxy, encoding);
-	if (!https_proxies)
+	// connections still using a proxy of the old list keep a reference to it
+	wget_thread_mutex_lock(&proxy_mutex);
+	wget_vector_free(&https_proxies);
+	https_proxies = proxies;
+	wget_thread_mutex_unlock(&proxy_mutex);
+
+	if (!proxies)
 		return -1;
 
 	return 0;
@@ -2573,6 +3139,23 @@ int wget_http_set_no_proxy(const char *no_proxy, const char *encoding)
 	return 0;
 }
 
+/*
+ * Set the hosts that are known to speak HTTP/2 over plain TCP (h2c with prior knowledge).
+ * 'hosts' is a comma separated list of host names, domains with a leading dot or "*" for all hosts.
+ * Connections to these hosts start with the HTTP/2 connection preface instead of HTTP/1.1.
+ */
+int wget_http_set_http2_prior_knowledge(const char *hosts, const char *encoding)
+{
+	if (h2c_hosts)
+		wget_vector_free(&h2c_hosts);
+
+	h2c_hosts = _parse_no_proxies(hosts, encoding);
+	if (!h2c_hosts)
+		return -1;
+
+	return 0;
+}
+
 int wget_http_match_no_proxy(wget_vector_t *no_proxies, const char *host)
 {
 	if (!no_proxies || !host)
@@ -90,6 +90,31 @@ static const unsigned char
 		['~'] = IRI_CTYPE_UNRESERVED
 	};
 
+// characters that are not percent-escaped by wget_iri_escape(), wget_iri_escape_path() and wget_iri_escape_query()
+#define IRI_SAFE (1<<0)
+#define IRI_SAFE_PATH (1<<1)
+#define IRI_SAFE_QUERY (1<<2)
+
+static const unsigned char
+	iri_safe[256] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 7, 7, 2,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 0, 0, 0, 4, 0, 0,
+	0, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 0, 0, 0, 0, 7,
+	0, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 0, 0, 0, 7, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	};
+
 int wget_iri_supported(const wget_iri_t *iri)
 {
 	int it;
@@ -121,40 +146,17 @@ int wget_iri_isreserved(char c)
 
 int wget_iri_isunreserved(char c)
 {
-	return c > 32 && c < 127 && (c_isalnum(c) || _iri_isunreserved(c));
+	return iri_safe[(unsigned char)c] & IRI_SAFE;
 }
 
 int wget_iri_isunreserved_path(char c)
 {
-	return c > 32 && c < 127 && (c_isalnum(c) || _iri_isunreserved(c) || c == '/');
-}
-
-static _GL_INLINE unsigned char G_GNUC_WGET_CONST _unhex(unsigned char c)
-{
-	return c <= '9' ? c - '0' : (c <= 'F' ? c - 'A' + 10 : c - 'a' + 10);
+	return iri_safe[(unsigned char)c] & IRI_SAFE_PATH;
 }
 
 char *wget_iri_unescape_inline(char *src)
 {
-	char *ret = NULL;
-	unsigned char *s = (unsigned char *)src; // just a helper to avoid casting a lot
-	unsigned char *d = s;
-
-	while (*s) {
-		if (*s == '%') {
-			if (c_isxdigit(s[1]) && c_isxdigit(s[2])) {
-				*d++ = (_unhex(s[1]) << 4) | _unhex(s[2]);
-				s += 3;
-				ret = src;
-				continue;
-			}
-		}
-
-		*d++ = *s++;
-	}
-	*d = 0;
-
-	return ret;
+	return wget_percent_unescape(src) ? src : NULL;
 }
 
 // needed as helper for blacklist.c/blacklist_free()
@@ -674,67 +676,63 @@ int wget_iri_compare(wget_iri_t *iri1, wget_iri_t *iri2)
 	return 0;
 }
 
-const char *wget_iri_escape(const char *src, wget_buffer_t *buf)
+// percent-escape all bytes of src that don't have the 'safe' flag, optionally ' ' becomes '+'
+static const char *_iri_escape(const char *src, wget_buffer_t *buf, unsigned char safe, int space_to_plus)
 {
-	const char *begin;
+	static const char hex[16] = "0123456789ABCDEF";
+	const unsigned char *s;
+	size_t length, escapes = 0;
+	char *d;
 
 	if (!src)
 		return buf->data;
 
-	for (begin = src; *src; src++) {
-		if (!wget_iri_isunreserved(*src)) {
-			if (begin != src)
-				wget_buffer_memcat(buf, begin, src - begin);
-			begin = src + 1;
-			wget_buffer_printf_append(buf, "%%%02X", (unsigned char)*src);
-		}
+	// reserve the exact output size, so we can write without further checks
+	for (s = (const unsigned char *)src; *s; s++) {
+		if (!(iri_safe[*s] & safe))
+			escapes++;
 	}
+	length = s - (const unsigned char *)src;
 
-	if (begin != src)
-		wget_buffer_memcat(buf, begin, src - begin);
-
-	return buf->data;
-}
+	if (!escapes) {
+		wget_buffer_memcat(buf, src, length);
+		return buf->data;
+	}
 
-const char *wget_iri_escape_path(const char *src, wget_buffer_t *buf)
-{
-	const char *begin;
+	wget_buffer_ensure_capacity(buf, buf->length + length + escapes * 2);
 
-	for (begin = src; *src; src++) {
-		if (!wget_iri_isunreserved_path(*src)) {
-			if (begin != src)
-				wget_buffer_memcat(buf, begin, src - begin);
-			begin = src + 1;
-			wget_buffer_printf_append(buf, "%%%02X", (unsigned char)*src);
+	d = buf->data + buf->length;
+	for (s = (const unsigned char *)src; *s; s++) {
+		if (iri_safe[*s] & safe)
+			*d++ = *s;
+		else if (*s == ' ' && space_to_plus)
+			*d++ = '+';
+		else {
+			*d++ = '%';
+			*d++ = hex[*s >> 4];
+			*d++ = hex[*s & 0xf];
 		}
 	}
+	*d = 0;
 
-	if (begin != src)
-		wget_buffer_memcat(buf, begin, src - begin);
+	buf->length = d - buf->data;
 
 	return buf->data;
 }
 
-const char *wget_iri_escape_query(const char *src, wget_buffer_t *buf)
+const char *wget_iri_escape(const char *src, wget_buffer_t *buf)
 {
-	const char *begin;
-
-	for (begin = src; *src; src++) {
-		if (!wget_iri_isunreserved(*src) && *src != '=' && *src != '&') {
-			if (begin != src)
-				wget_buffer_memcat(buf, begin, src - begin);
-			begin = src + 1;
-			if (*src == ' ')
-				wget_buffer_memcat(buf, "+", 1);
-			else
-				wget_buffer_printf_append(buf, "%%%02X", (unsigned char)*src);
-		}
-	}
+	return _iri_escape(src, buf, IRI_SAFE, 0);
+}
 
-	if (begin != src)
-		wget_buffer_memcat(buf, begin, src - begin);
+const char *wget_iri_escape_path(const char *src, wget_buffer_t *buf)
+{
+	return _iri_escape(src, buf, IRI_SAFE_PATH, 0);
+}
 
-	return buf->data;
+const char *wget_iri_escape_query(const char *src, wget_buffer_t *buf)
+{
+	return _iri_escape(src, buf, IRI_SAFE_QUERY, 1);
 }
 
 const char *wget_iri_get_escaped_host(const wget_iri_t *iri, wget_buffer_t *buf)
@@ -0,0 +1,191 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Memory accounting by subsystem
+ *
+ * The counters are charged explicitly where a subsystem keeps long-living data,
+ * not within wget_malloc(). Within libwget and wget2 the calls are wrapped into
+ * memstats_alloc() / memstats_free(), which compile to nothing without ENABLE_MEMSTATS.
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <wget.h>
+#include "private.h"
+
+typedef struct {
+	size_t
+		current; // bytes in use
+	size_t
+		peak; // high-water mark of 'current'
+	size_t
+		count; // number of allocations
+} MEMSTATS;
+
+static MEMSTATS
+	stats[WGET_MEMTAG_MAX];
+
+static const char *names[WGET_MEMTAG_MAX] = {
+	[WGET_MEMTAG_FRONTIER] = "frontier",
+	[WGET_MEMTAG_BLACKLIST] = "blacklist",
+	[WGET_MEMTAG_KNOWN_URLS] = "known_urls",
+	[WGET_MEMTAG_DNS_CACHE] = "dns_cache",
+	[WGET_MEMTAG_TLS] = "tls",
+	[WGET_MEMTAG_HTTP_BUFFERS] = "http_buffers",
+	[WGET_MEMTAG_HTTP2_STREAMS] = "http2_streams",
+	[WGET_MEMTAG_PARSERS] = "parsers",
+	[WGET_MEMTAG_COOKIES] = "cookies",
+};
+
+#ifndef WITH_ATOMIC_RELAXED
+static wget_thread_mutex_t
+	mutex = WGET_THREAD_MUTEX_INITIALIZER;
+#endif
+
+void wget_memstats_alloc(wget_memtag_t tag, size_t size)
+{
+	if ((unsigned) tag >= WGET_MEMTAG_MAX)
+		return;
+
+	MEMSTATS *s = &stats[tag];
+
+#ifdef WITH_ATOMIC_RELAXED
+	// the counters are statistics only, they don't order other memory accesses
+	size_t current = __atomic_add_fetch(&s->current, size, __ATOMIC_RELAXED);
+	size_t peak = __atomic_load_n(&s->peak, __ATOMIC_RELAXED);
+
+	while (current > peak && !__atomic_compare_exchange_n(&s->peak, &peak, current, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+
+	__atomic_add_fetch(&s->count, 1, __ATOMIC_RELAXED);
+#else
+	wget_thread_mutex_lock(&mutex);
+	s->current += size;
+	if (s->current > s->peak)
+		s->peak = s->current;
+	s->count++;
+	wget_thread_mutex_unlock(&mutex);
+#endif
+}
+
+void wget_memstats_free(wget_memtag_t tag, size_t size)
+{
+	if ((unsigned) tag >= WGET_MEMTAG_MAX)
+		return;
+
+#ifdef WITH_ATOMIC_RELAXED
+	__atomic_sub_fetch(&stats[tag].current, size, __ATOMIC_RELAXED);
+#else
+	wget_thread_mutex_lock(&mutex);
+	stats[tag].current -= size;
+	wget_thread_mutex_unlock(&mutex);
+#endif
+}
+
+// no locking with the mutex fallback, so that it can be called from a signal handler
+void wget_memstats_get(wget_memtag_t tag, size_t *current, size_t *peak, size_t *count)
+{
+	MEMSTATS s = { 0, 0, 0 };
+
+	if ((unsigned) tag < WGET_MEMTAG_MAX) {
+#ifdef WITH_ATOMIC_RELAXED
+		s.current = __atomic_load_n(&stats[tag].current, __ATOMIC_RELAXED);
+		s.peak = __atomic_load_n(&stats[tag].peak, __ATOMIC_RELAXED);
+		s.count = __atomic_load_n(&stats[tag].count, __ATOMIC_RELAXED);
+#else
+		s = stats[tag];
+#endif
+	}
+
+	if (current)
+		*current = s.current;
+	if (peak)
+		*peak = s.peak;
+	if (count)
+		*count = s.count;
+}
+
+const char *wget_memstats_name(wget_memtag_t tag)
+{
+	return (unsigned) tag < WGET_MEMTAG_MAX ? names[tag] : NULL;
+}
+
+// append 's' (or the decimal number 'n' if 's' is NULL), padded to 'width'
+static size_t _append(char *buf, size_t size, size_t pos, const char *s, size_t n, size_t width)
+{
+	char num[24];
+	size_t len;
+
+	if (!s) {
+		char *p = num + sizeof(num);
+
+		do {
+			*--p = '0' + n % 10;
+		} while ((n /= 10));
+
+		s = p;
+		len = num + sizeof(num) - p;
+	} else
+		len = strlen(s);
+
+	for (; len < width && pos < size; width--)
+		buf[pos++] = ' ';
+
+	for (; len && pos < size; len--)
+		buf[pos++] = *s++;
+
+	return pos;
+}
+
+/*
+ * Writes a table of all counters (in bytes) into 'buf' and returns the number of bytes written,
+ * the output is 0-terminated and truncated if 'buf' is too small.
+ * Doesn't allocate memory and doesn't use stdio, so it is safe to call it from a signal handler.
+ */
+size_t wget_memstats_report(char *buf, size_t size)
+{
+	size_t pos = 0, current, peak, count;
+
+	if (!size)
+		return 0;
+
+	size--; // room for the trailing 0
+
+	pos = _append(buf, size, pos, "Memory by subsystem   current           peak    allocations\n", 0, 0);
+
+	for (int tag = 0; tag < WGET_MEMTAG_MAX; tag++) {
+		wget_memstats_get(tag, &current, &peak, &count);
+
+		pos = _append(buf, size, pos, "  ", 0, 0);
+		pos = _append(buf, size, pos, names[tag], 0, 0);
+		pos = _append(buf, size, pos, NULL, current, 27 - strlen(names[tag]));
+		pos = _append(buf, size, pos, NULL, peak, 15);
+		pos = _append(buf, size, pos, NULL, count, 15);
+		pos = _append(buf, size, pos, "\n", 0, 0);
+	}
+
+	buf[pos] = 0;
+
+	return pos;
+}
@@ -68,6 +68,7 @@
 #include <wget.h>
 #include "private.h"
 #include "net.h"
+#include "wget_probes.h"
 
 // resolver / DNS cache entry
 struct ADDR_ENTRY {
@@ -98,7 +99,8 @@ static struct wget_tcp_st _global_tcp = {
 static wget_vector_t
 	*dns_cache;
 static wget_thread_mutex_t
-	dns_mutex = WGET_THREAD_MUTEX_INITIALIZER;
+	dns_mutex = WGET_THREAD_MUTEX_INITIALIZER,
+	bind_mutex = WGET_THREAD_MUTEX_INITIALIZER;
 
 static struct addrinfo *_wget_dns_cache_get(const char *host, const char *port)
 {
@@ -130,8 +132,28 @@ static int G_GNUC_WGET_PURE _compare_addr(struct ADDR_ENTRY *a1, struct ADDR_ENT
 	return n;
 }
 
+// estimated heap usage of a cache entry including the resolver's addrinfo list
+static inline size_t _dns_entry_size(const struct ADDR_ENTRY *entry)
+{
+	size_t size = sizeof(struct ADDR_ENTRY);
+
+	if (entry->host)
+		size += strlen(entry->host) + 1;
+	if (entry->port)
+		size += strlen(entry->port) + 1;
+
+	for (const struct addrinfo *ai = entry->addrinfo; ai; ai = ai->ai_next) {
+		size += sizeof(struct addrinfo) + ai->ai_addrlen;
+		if (ai->ai_canonname)
+			size += strlen(ai->ai_canonname) + 1;
+	}
+
+	return size;
+}
+
 static void _free_dns(struct ADDR_ENTRY *entry)
 {
+	memstats_free(WGET_MEMTAG_DNS_CACHE, _dns_entry_size(entry));
 	freeaddrinfo(entry->addrinfo);
 }
 
@@ -166,6 +188,7 @@ static struct addrinfo * _wget_dns_cache_add(const char *host, const char *port,
 	if ((index = wget_vector_find(dns_cache, entryp)) == -1) {
 		debug_printf("Add dns cache entry %s:%s\n", host, port);
 		wget_vector_insert_sorted_noalloc(dns_cache, entryp);
+		memstats_alloc(WGET_MEMTAG_DNS_CACHE, _dns_entry_size(entryp));
 	} else {
 		// race condition:
 		xfree(entryp);
@@ -411,6 +434,72 @@ int wget_tcp_get_local_port(wget_tcp_t *tcp)
 	return 0;
 }
 
+// write the numeric address of the connected peer into 'buf', returns 'buf' or NULL on error
+const char *wget_tcp_get_peer_address(wget_tcp_t *tcp, char *buf, size_t bufsize)
+{
+	struct sockaddr_storage addr_store;
+	struct sockaddr *addr = (struct sockaddr *)&addr_store;
+	socklen_t addr_len = sizeof(addr_store);
+
+	if (!tcp || tcp->sockfd == -1 || !buf)
+		return NULL;
+
+	if (getpeername(tcp->sockfd, addr, &addr_len) != 0
+		|| getnameinfo(addr, addr_len, buf, bufsize, NULL, 0, NI_NUMERICHOST) != 0)
+		return NULL;
+
+	return buf;
+}
+
+// WGET_E_* of the last failed connect, read or write, taken from errno right at the failing call
+int wget_tcp_get_error(wget_tcp_t *tcp)
+{
+	return tcp ? tcp->error : WGET_E_SUCCESS;
+}
+
+static int _errno_to_error(int err)
+{
+	if (err == ECONNREFUSED)
+		return WGET_E_CONNREFUSED;
+	if (err == ETIMEDOUT)
+		return WGET_E_TIMEOUT;
+	return WGET_E_UNKNOWN;
+}
+
+// check if the connected peer is one of the addresses that 'host' resolves to
+int wget_tcp_is_connected_to(wget_tcp_t *tcp, const char *host, const char *port)
+{
+	struct sockaddr_storage addr_store;
+	struct sockaddr *addr = (struct sockaddr *)&addr_store;
+	socklen_t addr_len = sizeof(addr_store);
+	char peer[NI_MAXHOST], peer_port[NI_MAXSERV];
+	struct addrinfo *addrinfo;
+	int found = 0;
+
+	if (!tcp || tcp->sockfd == -1 || !host)
+		return 0;
+
+	if (getpeername(tcp->sockfd, addr, &addr_len) != 0
+		|| getnameinfo(addr, addr_len, peer, sizeof(peer), peer_port, sizeof(peer_port), NI_NUMERICHOST | NI_NUMERICSERV) != 0)
+		return 0;
+
+	if (!(addrinfo = wget_tcp_resolve(tcp, host, port)))
+		return 0;
+
+	for (struct addrinfo *ai = addrinfo; ai && !found; ai = ai->ai_next) {
+		char adr[NI_MAXHOST], sport[NI_MAXSERV];
+
+		if (ai->ai_family == addr->sa_family
+			&& getnameinfo(ai->ai_addr, ai->ai_addrlen, adr, sizeof(adr), sport, sizeof(sport), NI_NUMERICHOST | NI_NUMERICSERV) == 0)
+			found = !strcmp(adr, peer) && !strcmp(sport, peer_port);
+	}
+
+	if (!tcp->caching)
+		freeaddrinfo(addrinfo);
+
+	return found;
+}
+
 void wget_tcp_set_dns_timeout(wget_tcp_t *tcp, int timeout)
 {
 	(tcp ? tcp : &_global_tcp)->dns_timeout = timeout;
@@ -431,46 +520,179 @@ int wget_tcp_get_timeout(wget_tcp_t *tcp)
 	return (tcp ? tcp : &_global_tcp)->timeout;
 }
 
+static void _free_bind_address(struct _bind_address *entry)
+{
+	if (entry->addrinfo_allocated)
+		freeaddrinfo(entry->addrinfo);
+}
+
+// resolve a single bind address in the form host, host:port, [ipv6] or [ipv6]:port
+static struct addrinfo *_resolve_bind_address(wget_tcp_t *tcp, const char *bind_address, size_t len)
+{
+	char copy[len + 1], *s = copy;
+	const char *host;
+
+	memcpy(copy, bind_address, len);
+	copy[len] = 0;
+
+	if (*s == '[') {
+		// IPv6 address within brackets
+		char *p = strrchr(s, ']');
+		if (p) {
+			host = s + 1;
+			*p = 0;
+			s = p + 1;
+		} else {
+			// something is broken
+			host = s + 1;
+			while (*s) s++;
+		}
+	} else {
+		host = s;
+		while (*s && *s != ':')
+			s++;
+	}
+	if (*s == ':') {
+		*s = 0;
+		return wget_tcp_resolve(tcp, host, s + 1); // bind to host + specified port
+	} else {
+		return wget_tcp_resolve(tcp, host, NULL); // bind to host on any port
+	}
+}
+
+static void _release_bind_address(wget_tcp_t *tcp)
+{
+	if (tcp->bind_address) {
+		wget_thread_mutex_lock(&bind_mutex);
+		tcp->bind_address->inuse--;
+		tcp->bind_address = NULL;
+		wget_thread_mutex_unlock(&bind_mutex);
+	}
+}
+
+// drop a reference to a bind address list, the last one frees the list
+static void _unref_bind_addresses(struct _bind_addresses **addresses)
+{
+	if (*addresses) {
+		wget_thread_mutex_lock(&bind_mutex);
+		if (--(*addresses)->refs == 0) {
+			wget_vector_free(&(*addresses)->entries);
+			xfree(*addresses);
+		}
+		wget_thread_mutex_unlock(&bind_mutex);
+		*addresses = NULL;
+	}
+}
+
+// 'bind_address' may be a comma separated list of local addresses.
+// Each new connection binds to the address that is least used by the current connections.
 void wget_tcp_set_bind_address(wget_tcp_t *tcp, const char *bind_address)
 {
 	if (!tcp)
 		tcp = &_global_tcp;
 
-	if (tcp->bind_addrinfo_allocated) {
-		freeaddrinfo(tcp->bind_addrinfo);
-		tcp->bind_addrinfo = NULL;
-	}
+	// tcp objects created before keep their reference to the old list
+	_release_bind_address(tcp);
+	_unref_bind_addresses(&tcp->bind_addresses);
 
 	if (bind_address) {
-		char copy[strlen(bind_address) + 1], *s = copy;
-		const char *host;
+		const char *s, *p;
 
-		memcpy(copy, bind_address, sizeof(copy));
+		tcp->bind_addresses = xcalloc(1, sizeof(struct _bind_addresses));
+		tcp->bind_addresses->entries = wget_vector_create(4, 4, NULL);
+		tcp->bind_addresses->refs = 1;
+		wget_vector_set_destructor(tcp->bind_addresses->entries, (wget_vector_destructor_t)_free_bind_address);
 
-		if (*s == '[') {
-			// IPv6 address within brackets
-			char *p = strrchr(s, ']');
-			if (p) {
-				host = s + 1;
-				s = p + 1;
-			} else {
-				// something is broken
-				host = s + 1;
-				while (*s) s++;
+		for (s = p = bind_address; *p; s = p + 1) {
+			while (c_isspace(*s)) s++;
+
+			if ((p = strchrnul(s, ',')) != s) {
+				struct _bind_address entry = { .addrinfo = _resolve_bind_address(tcp, s, p - s) };
+
+				if (entry.addrinfo) {
+					entry.addrinfo_allocated = !tcp->caching;
+					wget_vector_add(tcp->bind_addresses->entries, &entry, sizeof(entry));
+				} else
+					error_printf(_("Failed to resolve bind address '%.*s'\n"), (int)(p - s), s);
 			}
-		} else {
-			host = s;
-			while (*s && *s != ':')
-				s++;
 		}
-		if (*s == ':') {
-			*s = 0;
-			tcp->bind_addrinfo = wget_tcp_resolve(tcp, host, s + 1); // bind to host + specified port
-		} else {
-			tcp->bind_addrinfo = wget_tcp_resolve(tcp, host, NULL); // bind to host on any port
+	}
+}
+
+void wget_tcp_set_bind_address_no_port(wget_tcp_t *tcp, int no_port)
+{
+	(tcp ? tcp : &_global_tcp)->bind_no_port = !!no_port;
+}
+
+// Select the least used bind address that matches the address family.
+// Ties are broken round-robin, so sequential connections rotate over the addresses.
+// Returns NULL if no bind address has an address of 'family'.
+static struct addrinfo *_get_bind_address(wget_tcp_t *tcp, int family)
+{
+	static int next = -1;
+	struct _bind_address *best = NULL;
+	struct addrinfo *best_ai = NULL;
+	int n = wget_vector_size(tcp->bind_addresses->entries);
+
+	wget_thread_mutex_lock(&bind_mutex);
+
+	if (n > 0)
+		next = (next + 1) % n;
+
+	for (int it = 0; it < n; it++) {
+		struct _bind_address *entry = wget_vector_get(tcp->bind_addresses->entries, (next + it) % n);
+		struct addrinfo *ai;
+
+		for (ai = entry->addrinfo; ai && ai->ai_family != family; ai = ai->ai_next);
+
+		if (ai && (!best || entry->inuse < best->inuse)) {
+			best = entry;
+			best_ai = ai;
 		}
-		tcp->bind_addrinfo_allocated = !tcp->caching;
 	}
+
+	if (best)
+		best->inuse++;
+
+	tcp->bind_address = best;
+
+	wget_thread_mutex_unlock(&bind_mutex);
+
+	return best_ai;
+}
+
+void wget_tcp_set_receive_buffer_size(wget_tcp_t *tcp, int size)
+{
+	(tcp ? tcp : &_global_tcp)->sockopts.rcvbuf = size;
+}
+
+void wget_tcp_set_send_buffer_size(wget_tcp_t *tcp, int size)
+{
+	(tcp ? tcp : &_global_tcp)->sockopts.sndbuf = size;
+}
+
+void wget_tcp_set_notsent_lowat(wget_tcp_t *tcp, int lowat)
+{
+	(tcp ? tcp : &_global_tcp)->sockopts.notsent_lowat = lowat;
+}
+
+void wget_tcp_set_busy_poll(wget_tcp_t *tcp, int usecs)
+{
+	(tcp ? tcp : &_global_tcp)->sockopts.busy_poll = usecs;
+}
+
+void wget_tcp_set_quickack(wget_tcp_t *tcp, int quickack)
+{
+	(tcp ? tcp : &_global_tcp)->sockopts.quickack = !!quickack;
+}
+
+void wget_tcp_set_congestion_control(wget_tcp_t *tcp, const char *algorithm)
+{
+	if (!tcp)
+		tcp = &_global_tcp;
+
+	xfree(tcp->sockopts.congestion);
+	tcp->sockopts.congestion = wget_strdup(algorithm);
 }
 
 void wget_tcp_set_ssl(wget_tcp_t *tcp, int ssl)
@@ -503,6 +725,15 @@ wget_tcp_t *wget_tcp_init(void)
 
 	*tcp = _global_tcp;
 	tcp->ssl_hostname = wget_strdup(_global_tcp.ssl_hostname);
+	tcp->sockopts.congestion = wget_strdup(_global_tcp.sockopts.congestion);
+	tcp->bind_address = NULL;
+
+	// the bind addresses are shared with _global_tcp
+	if (tcp->bind_addresses) {
+		wget_thread_mutex_lock(&bind_mutex);
+		tcp->bind_addresses->refs++;
+		wget_thread_mutex_unlock(&bind_mutex);
+	}
 
 	return tcp;
 }
@@ -513,6 +744,8 @@ void wget_tcp_deinit(wget_tcp_t **_tcp)
 
 	if (!_tcp) {
 		xfree(_global_tcp.ssl_hostname);
+		xfree(_global_tcp.sockopts.congestion);
+		_unref_bind_addresses(&_global_tcp.bind_addresses);
 		return;
 	}
 
@@ -523,6 +756,8 @@ void wget_tcp_deinit(wget_tcp_t **_tcp)
 			freeaddrinfo(tcp->bind_addrinfo);
 			tcp->bind_addrinfo = NULL;
 		}
+		_unref_bind_addresses(&tcp->bind_addresses);
+		xfree(tcp->sockopts.congestion);
 		xfree(tcp->ssl_hostname);
 		xfree(tcp);
 		if (_tcp)
@@ -548,6 +783,79 @@ static void _set_async(int fd)
 #endif
 }
 
+#ifdef TCP_QUICKACK
+static int _set_quickack(int sockfd)
+{
+	int on = 1;
+
+	return setsockopt(sockfd, IPPROTO_TCP, TCP_QUICKACK, (void *)&on, sizeof(on));
+}
+#endif
+
+static void _set_socket_options(wget_tcp_t *tcp, int sockfd)
+{
+	struct _tcp_sockopts *opts = &tcp->sockopts;
+
+	if (opts->rcvbuf > 0 && setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, (void *)&opts->rcvbuf, sizeof(opts->rcvbuf)) == -1)
+		error_printf(_("Failed to set socket option RCVBUF\n"));
+
+	if (opts->sndbuf > 0 && setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, (void *)&opts->sndbuf, sizeof(opts->sndbuf)) == -1)
+		error_printf(_("Failed to set socket option SNDBUF\n"));
+
+#ifdef TCP_CONGESTION
+	if (opts->congestion && setsockopt(sockfd, IPPROTO_TCP, TCP_CONGESTION, opts->congestion, strlen(opts->congestion)) == -1)
+		error_printf(_("Failed to set TCP congestion control '%s' (%d)\n"), opts->congestion, errno);
+#endif
+
+#ifdef TCP_NOTSENT_LOWAT
+	if (opts->notsent_lowat > 0 && setsockopt(sockfd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, (void *)&opts->notsent_lowat, sizeof(opts->notsent_lowat)) == -1)
+		error_printf(_("Failed to set socket option NOTSENT_LOWAT\n"));
+#endif
+
+#ifdef TCP_QUICKACK
+	if (opts->quickack && _set_quickack(sockfd) == -1)
+		error_printf(_("Failed to set socket option QUICKACK\n"));
+#endif
+
+#ifdef SO_BUSY_POLL
+	if (opts->busy_poll > 0 && setsockopt(sockfd, SOL_SOCKET, SO_BUSY_POLL, (void *)&opts->busy_poll, sizeof(opts->busy_poll)) == -1)
+		error_printf(_("Failed to set socket option BUSY_POLL (%d)\n"), errno);
+#endif
+}
+
+// print the socket options as they are effectively set by the kernel
+static void _print_socket_options(int sockfd)
+{
+	int rcvbuf = -1, sndbuf = -1, notsent_lowat = -1, quickack = -1, busy_poll = -1;
+	char congestion[16] = "-";
+	socklen_t len;
+
+	len = sizeof(rcvbuf);
+	getsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, (void *)&rcvbuf, &len);
+	len = sizeof(sndbuf);
+	getsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, (void *)&sndbuf, &len);
+#ifdef TCP_CONGESTION
+	len = sizeof(congestion) - 1;
+	if (getsockopt(sockfd, IPPROTO_TCP, TCP_CONGESTION, congestion, &len) == 0)
+		congestion[len] = 0;
+#endif
+#ifdef TCP_NOTSENT_LOWAT
+	len = sizeof(notsent_lowat);
+	getsockopt(sockfd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, (void *)&notsent_lowat, &len);
+#endif
+#ifdef TCP_QUICKACK
+	len = sizeof(quickack);
+	getsockopt(sockfd, IPPROTO_TCP, TCP_QUICKACK, (void *)&quickack, &len);
+#endif
+#ifdef SO_BUSY_POLL
+	len = sizeof(busy_poll);
+	getsockopt(sockfd, SOL_SOCKET, SO_BUSY_POLL, (void *)&busy_poll, &len);
+#endif
+
+	debug_printf("socket options: rcvbuf=%d sndbuf=%d congestion=%s notsent_lowat=%d quickack=%d busy_poll=%d\n",
+		rcvbuf, sndbuf, congestion, notsent_lowat, quickack, busy_poll);
+}
+
 int wget_tcp_ready_2_transfer(wget_tcp_t *tcp, int flags)
 {
 	return wget_ready_2_transfer(tcp->sockfd, tcp->timeout, flags);
@@ -560,12 +868,19 @@ int wget_tcp_connect(wget_tcp_t *tcp, const char *host, const char *port)
 	char adr[NI_MAXHOST], s_port[NI_MAXSERV];
 	int debug = wget_logger_is_active(wget_get_logger(WGET_LOGGER_DEBUG));
 
+	WGET_PROBE2(tcp_connect_start, host, port);
+
+	tcp->error = WGET_E_SUCCESS;
+
 	if (tcp->addrinfo_allocated)
 		freeaddrinfo(tcp->addrinfo);
 
 	tcp->addrinfo = wget_tcp_resolve(tcp, host, port);
 	tcp->addrinfo_allocated = !tcp->caching;
 
+	if (!tcp->addrinfo)
+		ret = WGET_E_ADDRESS;
+
 	for (ai = tcp->addrinfo; ai; ai = ai->ai_next) {
 		if (debug) {
 			if ((rc = getnameinfo(ai->ai_addr, ai->ai_addrlen, adr, sizeof(adr), s_port, sizeof(s_port), NI_NUMERICHOST | NI_NUMERICSERV)) == 0)
@@ -586,17 +901,40 @@ int wget_tcp_connect(wget_tcp_t *tcp, const char *host, const char *port)
 			if (setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (void *)&on, sizeof(on)) == -1)
 				error_printf(_("Failed to set socket option NODELAY\n"));
 
-			if (tcp->bind_addrinfo) {
+			_set_socket_options(tcp, sockfd);
+			if (debug)
+				_print_socket_options(sockfd);
+
+			if (tcp->bind_addresses) {
+				struct addrinfo *bind_ai = _get_bind_address(tcp, ai->ai_family);
+
+				if (!bind_ai) {
+					// e.g. 'host' resolved to IPv6 and IPv4 but only IPv4 bind addresses are given
+					debug_printf("no bind address for address family %d\n", ai->ai_family);
+					close(sockfd);
+					continue;
+				}
+
 				if (debug) {
-					if ((rc = getnameinfo(tcp->bind_addrinfo->ai_addr, tcp->bind_addrinfo->ai_addrlen, adr, sizeof(adr), s_port, sizeof(s_port), NI_NUMERICHOST | NI_NUMERICSERV)) == 0)
+					if ((rc = getnameinfo(bind_ai->ai_addr, bind_ai->ai_addrlen, adr, sizeof(adr), s_port, sizeof(s_port), NI_NUMERICHOST | NI_NUMERICSERV)) == 0)
 						debug_printf("binding to %s:%s...\n", adr, s_port);
 					else
 						debug_printf("binding to ???:%s (%s)...\n", s_port, gai_strerror(rc));
 				}
 
-				if (bind(sockfd, tcp->bind_addrinfo->ai_addr, tcp->bind_addrinfo->ai_addrlen) != 0) {
+#ifdef IP_BIND_ADDRESS_NO_PORT
+				if (tcp->bind_no_port) {
+					on = 1;
+					if (setsockopt(sockfd, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, (void *)&on, sizeof(on)) == -1)
+						debug_printf("Failed to set socket option IP_BIND_ADDRESS_NO_PORT\n");
+				}
+#endif
+
+				if (bind(sockfd, bind_ai->ai_addr, bind_ai->ai_addrlen) != 0) {
 					error_printf(_("Failed to bind (%d)\n"), errno);
+					_release_bind_address(tcp);
 					close(sockfd);
+					WGET_PROBE3(tcp_connect_end, host, port, -1);
 					return -1;
 				}
 			}
@@ -621,8 +959,9 @@ int wget_tcp_connect(wget_tcp_t *tcp, const char *host, const char *port)
 				&& errno != EAGAIN
 				&& errno != EINPROGRESS
 			) {
+				ret = errno == ECONNREFUSED ? WGET_E_CONNREFUSED : WGET_E_CONNECT;
 				error_printf(_("Failed to connect (%d)\n"), errno);
-				ret = WGET_E_CONNECT;
+				_release_bind_address(tcp);
 				close(sockfd);
 			} else {
 				tcp->sockfd = sockfd;
@@ -644,12 +983,15 @@ int wget_tcp_connect(wget_tcp_t *tcp, const char *host, const char *port)
 					}
 				}
 
+				WGET_PROBE3(tcp_connect_end, host, port, WGET_E_SUCCESS);
 				return WGET_E_SUCCESS;
 			}
 		} else
 			error_printf(_("Failed to create socket (%d)\n"), errno);
 	}
 
+	tcp->error = ret;
+	WGET_PROBE3(tcp_connect_end, host, port, ret);
 	return ret;
 }
 
@@ -786,16 +1128,24 @@ ssize_t wget_tcp_read(wget_tcp_t *tcp, char *buf, size_t count)
 		// 0: no timeout / immediate
 		// -1: INFINITE timeout
 		if (tcp->timeout) {
-			if ((rc = wget_ready_2_read(tcp->sockfd, tcp->timeout)) <= 0)
+			if ((rc = wget_ready_2_read(tcp->sockfd, tcp->timeout)) <= 0) {
+				tcp->error = rc ? _errno_to_error(errno) : WGET_E_TIMEOUT;
 				return rc;
+			}
 		}
 
 //		rc = read(tcp->sockfd, buf, count);
 		rc = recvfrom(tcp->sockfd, buf, count, 0, NULL, NULL);
 	}
 
-	if (rc < 0)
+	if (rc < 0) {
+		tcp->error = tcp->ssl_session ? WGET_E_UNKNOWN : _errno_to_error(errno);
 		error_printf(_("Failed to read %zu bytes (%d)\n"), count, errno);
+	}
+#ifdef TCP_QUICKACK
+	else if (rc > 0 && tcp->sockopts.quickack)
+		_set_quickack(tcp->sockfd); // the kernel leaves quick-ack mode on its own, re-arm it after each read
+#endif
 
 	return rc;
 }
@@ -805,8 +1155,11 @@ ssize_t wget_tcp_write(wget_tcp_t *tcp, const char *buf, size_t count)
 	ssize_t nwritten = 0, n;
 	int rc;
 
-	if (tcp->ssl_session)
-		return wget_ssl_write_timeout(tcp->ssl_session, buf, count, tcp->timeout);
+	if (tcp->ssl_session) {
+		if ((n = wget_ssl_write_timeout(tcp->ssl_session, buf, count, tcp->timeout)) <= 0)
+			tcp->error = n ? WGET_E_UNKNOWN : WGET_E_TIMEOUT;
+		return n;
+	}
 
 	while (count) {
 #ifdef TCP_FASTOPEN_LINUX
@@ -824,6 +1177,7 @@ ssize_t wget_tcp_write(wget_tcp_t *tcp, const char *buf, size_t count)
 					&& errno != ENOTCONN
 					&& errno != EINPROGRESS)
 				{
+					tcp->error = errno == ECONNREFUSED ? WGET_E_CONNREFUSED : WGET_E_CONNECT;
 					error_printf(_("Failed to connect (%d)\n"), errno);
 					return -1;
 				}
@@ -846,6 +1200,7 @@ ssize_t wget_tcp_write(wget_tcp_t *tcp, const char *buf, size_t count)
 				&& errno != ENOTCONN
 				&& errno != EINPROGRESS
 			) {
+				tcp->error = _errno_to_error(errno);
 				error_printf(_("Failed to write %zu bytes (%d)\n"), count, errno);
 				return -1;
 			}
@@ -853,8 +1208,10 @@ ssize_t wget_tcp_write(wget_tcp_t *tcp, const char *buf, size_t count)
 			// 0: no timeout / immediate
 			// -1: INFINITE timeout
 			if (tcp->timeout) {
-				if ((rc = wget_ready_2_write(tcp->sockfd, tcp->timeout)) <= 0)
+				if ((rc = wget_ready_2_write(tcp->sockfd, tcp->timeout)) <= 0) {
+					tcp->error = rc ? _errno_to_error(errno) : WGET_E_TIMEOUT;
 					return rc;
+				}
 			}
 		}
 	}
@@ -903,6 +1260,7 @@ void wget_tcp_close(wget_tcp_t *tcp)
 			close(tcp->sockfd);
 			tcp->sockfd = -1;
 		}
+		_release_bind_address(tcp);
 		if (tcp->addrinfo_allocated) {
 			freeaddrinfo(tcp->addrinfo);
 		}
@@ -31,6 +31,37 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 
+// local address to bind to, selected by least usage in wget_tcp_connect()
+struct _bind_address {
+	struct addrinfo *
+		addrinfo;
+	int
+		inuse; // number of connections currently bound to this address
+	unsigned char
+		addrinfo_allocated : 1;
+};
+
+// list of local addresses to bind to, shared by the tcp objects created from the same settings
+struct _bind_addresses {
+	wget_vector_t *
+		entries; // list of struct _bind_address
+	int
+		refs; // number of tcp objects using this list, guarded by bind_mutex
+};
+
+// socket tuning options, applied by wget_tcp_connect() (0 / NULL keeps the system default)
+struct _tcp_sockopts {
+	const char *
+		congestion; // TCP_CONGESTION, e.g. "bbr" or "cubic"
+	int
+		rcvbuf, // SO_RCVBUF
+		sndbuf, // SO_SNDBUF
+		notsent_lowat, // TCP_NOTSENT_LOWAT
+		busy_poll; // SO_BUSY_POLL in microseconds
+	unsigned char
+		quickack : 1; // TCP_QUICKACK
+};
+
 struct wget_tcp_st {
 	void *
 		ssl_session;
@@ -40,6 +71,12 @@ struct wget_tcp_st {
 		bind_addrinfo;
 	struct addrinfo *
 		connect_addrinfo; // needed for TCP_FASTOPEN delayed connect
+	struct _bind_addresses *
+		bind_addresses; // referenced list of local addresses
+	struct _bind_address *
+		bind_address; // the entry of 'bind_addresses' the socket is bound to
+	struct _tcp_sockopts
+		sockopts;
 	const char *
 		ssl_hostname; // if set, do SSL hostname checking
 	int
@@ -51,13 +88,15 @@ struct wget_tcp_st {
 		timeout, // read and write timeouts are the same
 		family,
 		preferred_family,
-		protocol; // WGET_PROTOCOL_HTTP1_1, WGET_PROTOCOL_HTTP2_0
+		protocol, // WGET_PROTOCOL_HTTP1_1, WGET_PROTOCOL_HTTP2_0
+		error; // WGET_E_* of the last failed connect, read or write
 	unsigned char
 		ssl : 1,
 		passive : 1,
 		caching : 1,
 		addrinfo_allocated : 1,
 		bind_addrinfo_allocated : 1,
+		bind_no_port : 1, // use IP_BIND_ADDRESS_NO_PORT to defer port allocation to connect()
 		tls_false_start : 1,
 		tcp_fastopen : 1, // do we use TCP_FASTOPEN or not
 		first_send : 1; // TCP_FASTOPEN's first packet is sent different
@@ -55,4 +55,13 @@
 # define debug_printf wget_debug_printf
 # define debug_write wget_debug_write
 
+// memory accounting, compiled out unless configured with --enable-memstats
+# ifdef ENABLE_MEMSTATS
+#  define memstats_alloc(tag, size) wget_memstats_alloc(tag, size)
+#  define memstats_free(tag, size) wget_memstats_free(tag, size)
+# else
+#  define memstats_alloc(tag, size) ((void) sizeof(size))
+#  define memstats_free(tag, size) ((void) sizeof(size))
+# endif
+
 #endif /* _LIBWGET_PRIVATE_H */
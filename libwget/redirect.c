@@ -0,0 +1,365 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Permanent redirect routines
+ *
+ * A map of source URLs to the targets they permanently redirect to (301, 308),
+ * so that known redirects can be followed without asking the server again.
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <wget.h>
+#include "private.h"
+
+struct _wget_redirect_db_st {
+	wget_hashmap_t *
+		entries;
+	wget_thread_mutex_t
+		mutex;
+	time_t
+		load_time;
+};
+
+struct _wget_redirect_st {
+	const char *
+		source; // URL that has been redirected
+	const char *
+		target; // absolute URL of the Location
+	time_t
+		expires; // expiry time
+	time_t
+		created; // creation time
+	time_t
+		maxage; // max-age in seconds
+	int
+		status; // 301 or 308
+};
+
+static unsigned int G_GNUC_WGET_PURE _hash_redirect(const wget_redirect_t *redirect)
+{
+	unsigned int hash = 0;
+	const unsigned char *p;
+
+	for (p = (unsigned char *)redirect->source; *p; p++)
+		hash = hash * 101 + *p;
+
+	return hash;
+}
+
+static int G_GNUC_WGET_NONNULL_ALL G_GNUC_WGET_PURE _compare_redirect(const wget_redirect_t *r1, const wget_redirect_t *r2)
+{
+	return strcmp(r1->source, r2->source);
+}
+
+wget_redirect_t *wget_redirect_init(wget_redirect_t *redirect)
+{
+	if (!redirect)
+		redirect = xmalloc(sizeof(wget_redirect_t));
+
+	memset(redirect, 0, sizeof(*redirect));
+	redirect->created = time(NULL);
+
+	return redirect;
+}
+
+void wget_redirect_deinit(wget_redirect_t *redirect)
+{
+	if (redirect) {
+		xfree(redirect->source);
+		xfree(redirect->target);
+	}
+}
+
+void wget_redirect_free(wget_redirect_t *redirect)
+{
+	if (redirect) {
+		wget_redirect_deinit(redirect);
+		xfree(redirect);
+	}
+}
+
+wget_redirect_t *wget_redirect_new(const char *source, const char *target, int status, time_t maxage)
+{
+	wget_redirect_t *redirect = wget_redirect_init(NULL);
+
+	redirect->source = wget_strdup(source);
+	redirect->target = wget_strdup(target);
+	redirect->status = status;
+	redirect->maxage = maxage;
+	redirect->expires = maxage ? redirect->created + maxage : 0;
+
+	return redirect;
+}
+
+// Return a copy of the target URL for 'source' and optionally its status code, NULL if not known or expired
+char *wget_redirect_db_get(wget_redirect_db_t *redirect_db, const char *source, int *status)
+{
+	wget_redirect_t redirect, *redirectp;
+	char *target = NULL;
+
+	if (!redirect_db || !source)
+		return NULL;
+
+	redirect.source = source;
+
+	wget_thread_mutex_lock(&redirect_db->mutex);
+	if ((redirectp = wget_hashmap_get(redirect_db->entries, &redirect)) && redirectp->expires >= time(NULL)) {
+		target = wget_strdup(redirectp->target);
+		if (status)
+			*status = redirectp->status;
+	}
+	wget_thread_mutex_unlock(&redirect_db->mutex);
+
+	return target;
+}
+
+wget_redirect_db_t *wget_redirect_db_init(wget_redirect_db_t *redirect_db)
+{
+	if (!redirect_db)
+		redirect_db = xmalloc(sizeof(wget_redirect_db_t));
+
+	memset(redirect_db, 0, sizeof(*redirect_db));
+	redirect_db->entries = wget_hashmap_create(16, -2, (wget_hashmap_hash_t)_hash_redirect, (wget_hashmap_compare_t)_compare_redirect);
+	wget_hashmap_set_key_destructor(redirect_db->entries, (wget_hashmap_key_destructor_t)wget_redirect_free);
+	wget_hashmap_set_value_destructor(redirect_db->entries, (wget_hashmap_value_destructor_t)wget_redirect_free);
+	wget_thread_mutex_init(&redirect_db->mutex);
+
+	return redirect_db;
+}
+
+void wget_redirect_db_deinit(wget_redirect_db_t *redirect_db)
+{
+	if (redirect_db) {
+		wget_thread_mutex_lock(&redirect_db->mutex);
+		wget_hashmap_free(&redirect_db->entries);
+		wget_thread_mutex_unlock(&redirect_db->mutex);
+	}
+}
+
+void wget_redirect_db_free(wget_redirect_db_t **redirect_db)
+{
+	if (redirect_db) {
+		wget_redirect_db_deinit(*redirect_db);
+		xfree(*redirect_db);
+	}
+}
+
+void wget_redirect_db_add(wget_redirect_db_t *redirect_db, wget_redirect_t *redirect)
+{
+	wget_thread_mutex_lock(&redirect_db->mutex);
+
+	if (redirect->maxage == 0) {
+		if (wget_hashmap_remove(redirect_db->entries, redirect))
+			debug_printf("removed redirect %s\n", redirect->source);
+		wget_redirect_free(redirect);
+	} else {
+		wget_redirect_t *old = wget_hashmap_get(redirect_db->entries, redirect);
+
+		if (old) {
+			if (old->created < redirect->created || strcmp(old->target, redirect->target)) {
+				xfree(old->target);
+				old->target = redirect->target;
+				redirect->target = NULL;
+				old->status = redirect->status;
+				old->created = redirect->created;
+				old->expires = redirect->expires;
+				old->maxage = redirect->maxage;
+				debug_printf("update redirect %s -> %s (%d, maxage=%lld)\n", old->source, old->target, old->status, (long long)old->maxage);
+			}
+			wget_redirect_free(redirect);
+		} else {
+			// key and value are the same to make wget_hashmap_get() return old 'redirect'
+			debug_printf("add redirect %s -> %s (%d, maxage=%lld)\n", redirect->source, redirect->target, redirect->status, (long long)redirect->maxage);
+			wget_hashmap_put_noalloc(redirect_db->entries, redirect, redirect);
+		}
+	}
+
+	wget_thread_mutex_unlock(&redirect_db->mutex);
+}
+
+static int _redirect_db_load(wget_redirect_db_t *redirect_db, FILE *fp)
+{
+	wget_redirect_t redirect;
+	struct stat st;
+	char *buf = NULL, *linep, *p;
+	size_t bufsize = 0;
+	ssize_t buflen;
+	time_t now = time(NULL);
+	int ok;
+
+	// if the database file hasn't changed since the last read
+	// there's no need to reload
+
+	if (fstat(fileno(fp), &st) == 0) {
+		if (st.st_mtime != redirect_db->load_time)
+			redirect_db->load_time = st.st_mtime;
+		else
+			return 0;
+	}
+
+	while ((buflen = wget_getline(&buf, &bufsize, fp)) >= 0) {
+		linep = buf;
+
+		while (isspace(*linep)) linep++; // ignore leading whitespace
+		if (!*linep) continue; // skip empty lines
+
+		if (*linep == '#')
+			continue; // skip comments
+
+		// strip off \r\n
+		while (buflen > 0 && (buf[buflen] == '\n' || buf[buflen] == '\r'))
+			buf[--buflen] = 0;
+
+		wget_redirect_init(&redirect);
+		ok = 0;
+
+		// parse source URL
+		if (*linep) {
+			for (p = linep; *linep && !isspace(*linep); )
+				linep++;
+			redirect.source = wget_strmemdup(p, linep - p);
+		}
+
+		// parse status code
+		if (*linep) {
+			for (p = ++linep; *linep && !isspace(*linep); )
+				linep++;
+			redirect.status = atoi(p);
+		}
+
+		// parse target URL
+		if (*linep) {
+			for (p = ++linep; *linep && !isspace(*linep); )
+				linep++;
+			redirect.target = wget_strmemdup(p, linep - p);
+		}
+
+		// parse creation time
+		if (*linep) {
+			for (p = ++linep; *linep && !isspace(*linep); )
+				linep++;
+			redirect.created = (time_t)atoll(p);
+		}
+
+		// parse max age
+		if (*linep) {
+			for (p = ++linep; *linep && !isspace(*linep); )
+				linep++;
+			redirect.maxage = (time_t)atoll(p);
+			redirect.expires = redirect.maxage ? redirect.created + redirect.maxage : 0;
+			if (redirect.expires < now) {
+				// drop expired entry
+				wget_redirect_deinit(&redirect);
+				continue;
+			}
+			ok = redirect.source && redirect.target && *redirect.target;
+		}
+
+		if (ok) {
+			wget_redirect_db_add(redirect_db, wget_memdup(&redirect, sizeof(redirect)));
+		} else {
+			wget_redirect_deinit(&redirect);
+			error_printf(_("Failed to parse redirect line: '%s'\n"), buf);
+		}
+	}
+
+	xfree(buf);
+
+	if (ferror(fp)) {
+		redirect_db->load_time = 0; // reload on next call to this function
+		return -1;
+	}
+
+	return 0;
+}
+
+// Load the redirect cache from a flat file
+// Protected by flock()
+
+int wget_redirect_db_load(wget_redirect_db_t *redirect_db, const char *fname)
+{
+	if (!redirect_db || !fname || !*fname)
+		return 0;
+
+	if (wget_update_file(fname, (wget_update_load_t)_redirect_db_load, NULL, redirect_db)) {
+		error_printf(_("Failed to read redirect data\n"));
+		return -1;
+	} else {
+		debug_printf(_("Fetched redirect data from '%s'\n"), fname);
+		return 0;
+	}
+}
+
+static int G_GNUC_WGET_NONNULL_ALL _redirect_save(FILE *fp, const wget_redirect_t *redirect)
+{
+	fprintf(fp, "%s %d %s %lld %lld\n", redirect->source, redirect->status, redirect->target, (long long)redirect->created, (long long)redirect->maxage);
+	return 0;
+}
+
+static int _redirect_db_save(void *redirect_db, FILE *fp)
+{
+	wget_hashmap_t *entries = ((wget_redirect_db_t *)redirect_db)->entries;
+
+	if (wget_hashmap_size(entries) > 0) {
+		fputs("#Redirect 1.0 file\n", fp);
+		fputs("#Generated by Wget2 " PACKAGE_VERSION ". Edit at your own risk.\n", fp);
+		fputs("# <source URL> <status> <target URL> <created> <max-age>\n", fp);
+
+		wget_hashmap_browse(entries, (wget_hashmap_browse_t)_redirect_save, fp);
+
+		if (ferror(fp))
+			return -1;
+	}
+
+	return 0;
+}
+
+// Save the redirect cache to a flat file
+// Protected by flock()
+
+int wget_redirect_db_save(wget_redirect_db_t *redirect_db, const char *fname)
+{
+	int size;
+
+	if (!redirect_db || !fname || !*fname)
+		return -1;
+
+	if (wget_update_file(fname, (wget_update_load_t)_redirect_db_load, _redirect_db_save, redirect_db)) {
+		error_printf(_("Failed to write redirect file '%s'\n"), fname);
+		return -1;
+	}
+
+	if ((size = wget_hashmap_size(redirect_db->entries)))
+		debug_printf(_("Saved %d redirect entr%s into '%s'\n"), size, size != 1 ? "ies" : "y", fname);
+	else
+		debug_printf(_("No redirect entries to save. Table is empty.\n"));
+
+	return 0;
+}
@@ -32,6 +32,7 @@
 #include <strings.h>
 #include <string.h>
 #include <ctype.h>
+#include <c-ctype.h>
 
 #include <wget.h>
 #include "private.h"
@@ -58,8 +59,8 @@ static void _free_path(ROBOTS_PATH *path)
  * \return Return an allocated ROBOTS structure or NULL on error
  *
  * The function parses the robots.txt \p data and returns a ROBOTS structure
- * including a list of the disallowed paths and including a list of the sitemap
- * files.
+ * including a list of the disallowed paths, a list of the sitemap
+ * files and the Crawl-delay value.
  *
  * The ROBOTS structure has to be freed by calling wget_robots_free().
  */
@@ -106,6 +107,21 @@ ROBOTS *wget_robots_parse(const char *data, const char *client)
 				wget_vector_add(robots->paths, &path, sizeof(path));
 			}
 		}
+		else if (collect == 1 && !wget_strncasecmp_ascii(data, "Crawl-delay:", 12)) {
+			// seconds, fractions are allowed (e.g. 0.5)
+			long long ms = 0;
+			int scale = 1000;
+
+			for (data += 12; *data == ' ' || *data == '\t'; data++);
+			for (; c_isdigit(*data) && ms < 86400000; data++)
+				ms = ms * 10 + (*data - '0') * 1000;
+			if (*data == '.') {
+				for (data++; c_isdigit(*data) && scale > 1; data++)
+					ms += (*data - '0') * (scale /= 10);
+			}
+
+			robots->crawl_delay = ms < 86400000 ? (int) ms : 86400000;
+		}
 		else if (!wget_strncasecmp_ascii(data, "Sitemap:", 8)) {
 			for (data += 8; *data==' ' || *data == '\t'; data++);
 			for (p = data; *p && !isspace(*p); p++);
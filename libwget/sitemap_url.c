@@ -50,40 +50,128 @@ struct sitemap_context {
 	wget_vector_t
 		*sitemap_urls,
 		*urls;
+	time_t
+		lastmod; // <lastmod> seen before <loc> within the current entry
+	int
+		pos; // position of the current entry in its vector, -1 if <loc> has not been seen yet
+	bool
+		entries; // collect wget_sitemap_url_t instead of wget_string_t
 };
 
-static void _sitemap_get_url(void *context, int flags, const char *dir, const char *attr G_GNUC_WGET_UNUSED, const char *val, size_t len, size_t pos G_GNUC_WGET_UNUSED)
+// parse a W3C Datetime (https://www.w3.org/TR/NOTE-datetime) as used by <lastmod>, returns 0 on error
+static time_t _parse_w3c_datetime(const char *s, size_t len)
 {
-	struct sitemap_context *ctx = context;
-	wget_string_t url;
-	int type = 0;
+	// cumulated number of days until beginning of month for non-leap years
+	static const int sum_of_days[12] = {
+		0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+	};
+	char buf[64], sign = 0;
+	int year, mon = 1, day = 1, hour = 0, min = 0, sec = 0, tzhour = 0, tzmin = 0, n = 0, days, leap_year;
+	const char *p;
+
+	if (len >= sizeof(buf))
+		return 0;
+
+	memcpy(buf, s, len);
+	buf[len] = 0;
+
+	if (sscanf(buf, "%4d%n-%2d%n-%2d%n", &year, &n, &mon, &n, &day, &n) < 1)
+		return 0;
+
+	p = buf + n;
+	if (*p == 'T') {
+		if (sscanf(p, "T%2d:%2d%n", &hour, &min, &n) != 2)
+			return 0;
+		p += n;
+
+		if (*p == ':') {
+			if (sscanf(p, ":%2d%n", &sec, &n) != 1)
+				return 0;
+			for (p += n; *p == '.' || c_isdigit(*p); p++); // skip fractions of a second
+		}
+
+		if (*p == '+' || *p == '-') {
+			sign = *p;
+			if (sscanf(p + 1, "%2d:%2d%n", &tzhour, &tzmin, &n) != 2)
+				return 0;
+			p += n + 1;
+		} else if (*p == 'Z')
+			p++;
+	}
+
+	if (*p || year < 1970 || mon < 1 || mon > 12 || day < 1 || day > 31 || hour > 23 || min > 59 || sec > 60)
+		return 0;
 
-	if ((flags & XML_FLG_CONTENT) && len) {
-		if (!wget_strcasecmp_ascii(dir, "/sitemapindex/sitemap/loc"))
-			type = 1;
-		else if (!wget_strcasecmp_ascii(dir, "/urlset/url/loc"))
-			type = 2;
+	leap_year = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
 
-		if (type) {
-			for (;len && c_isspace(*val); val++, len--); // skip leading spaces
-			for (;len && c_isspace(val[len - 1]); len--);  // skip trailing spaces
+	days = 365 * (year - 1970) + (year - 1969) / 4 - (year - 1901) / 100 + (year - 1601) / 400;
+	days += sum_of_days[mon - 1] + (mon > 2 && leap_year);
+	days += day - 1;
 
-			// info_printf("%02X %s %s '%.*s' %zd %zd\n", flags, dir, attr, (int) len, val, len, pos);
-			url.p = val;
-			url.len = len;
+	// the timezone offset is added to UTC, so it has to be subtracted
+	min -= sign == '+' ? tzhour * 60 + tzmin : sign == '-' ? -(tzhour * 60 + tzmin) : 0;
 
-			if (type == 1) {
-				if (!ctx->sitemap_urls)
-					ctx->sitemap_urls = wget_vector_create(32, -2, NULL);
+	return (((time_t)days * 24 + hour) * 60 + min) * 60 + sec;
+}
 
-				wget_vector_add(ctx->sitemap_urls, &url, sizeof(url));
-			} else {
-				if (!ctx->urls)
-					ctx->urls = wget_vector_create(32, -2, NULL);
+static void _sitemap_get_url(void *context, int flags, const char *dir, const char *attr G_GNUC_WGET_UNUSED, const char *val, size_t len, size_t pos G_GNUC_WGET_UNUSED)
+{
+	struct sitemap_context *ctx = context;
+	wget_vector_t **v;
+	int type = 0;
 
-				wget_vector_add(ctx->urls, &url, sizeof(url));
+	if (flags & XML_FLG_BEGIN) {
+		// a new <url> or <sitemap> entry starts
+		if (!wget_strcasecmp_ascii(dir, "/sitemapindex/sitemap") || !wget_strcasecmp_ascii(dir, "/urlset/url")) {
+			ctx->lastmod = 0;
+			ctx->pos = -1;
+		}
+		return;
+	}
 
-			}
+	if (!(flags & XML_FLG_CONTENT) || !len)
+		return;
+
+	if (!wget_strcasecmp_ascii(dir, "/sitemapindex/sitemap/loc"))
+		type = 1;
+	else if (!wget_strcasecmp_ascii(dir, "/urlset/url/loc"))
+		type = 2;
+	else if (ctx->entries && (!wget_strcasecmp_ascii(dir, "/sitemapindex/sitemap/lastmod")))
+		type = 3;
+	else if (ctx->entries && (!wget_strcasecmp_ascii(dir, "/urlset/url/lastmod")))
+		type = 4;
+	else
+		return;
+
+	for (;len && c_isspace(*val); val++, len--); // skip leading spaces
+	for (;len && c_isspace(val[len - 1]); len--);  // skip trailing spaces
+
+	// info_printf("%02X %s %s '%.*s' %zd %zd\n", flags, dir, attr, (int) len, val, len, pos);
+	v = (type == 1 || type == 3) ? &ctx->sitemap_urls : &ctx->urls;
+
+	if (type >= 3) {
+		// <lastmod> may come before or after <loc>
+		time_t lastmod = _parse_w3c_datetime(val, len);
+
+		if (ctx->pos >= 0) {
+			wget_sitemap_url_t *entry = wget_vector_get(*v, ctx->pos);
+
+			if (entry)
+				entry->lastmod = lastmod;
+		} else
+			ctx->lastmod = lastmod;
+	} else if (len) {
+		if (!*v)
+			*v = wget_vector_create(32, -2, NULL);
+
+		if (ctx->entries) {
+			wget_sitemap_url_t entry = { .url = { .p = val, .len = len }, .lastmod = ctx->lastmod };
+
+			ctx->pos = wget_vector_add(*v, &entry, sizeof(entry));
+		} else {
+			wget_string_t url = { .p = val, .len = len };
+
+			wget_vector_add(*v, &url, sizeof(url));
 		}
 	}
 }
@@ -99,7 +187,26 @@ static void _sitemap_get_url(void *context, int flags, const char *dir, const ch
  */
 void wget_sitemap_get_urls_inline(const char *sitemap, wget_vector_t **urls, wget_vector_t **sitemap_urls)
 {
-	struct sitemap_context context = { .urls = NULL, .sitemap_urls = NULL };
+	struct sitemap_context context = { .urls = NULL, .sitemap_urls = NULL, .pos = -1 };
+
+	wget_xml_parse_buffer(sitemap, _sitemap_get_url, &context, XML_HINT_REMOVE_EMPTY_CONTENT);
+
+	*urls = context.urls;
+	*sitemap_urls = context.sitemap_urls;
+}
+
+/**
+ * \param[in] sitemap Sitemap XML data
+ * \param[in,out] urls Pointer to return vector of URL entries
+ * \param[in,out] sitemap_urls Pointer to return vector of sitemap URL entries
+ *
+ * Like wget_sitemap_get_urls_inline(), but the vectors contain wget_sitemap_url_t entries
+ * with the `<lastmod>` value of each URL (0 if missing or not parseable).
+ *
+ */
+void wget_sitemap_get_entries_inline(const char *sitemap, wget_vector_t **urls, wget_vector_t **sitemap_urls)
+{
+	struct sitemap_context context = { .urls = NULL, .sitemap_urls = NULL, .pos = -1, .entries = 1 };
 
 	wget_xml_parse_buffer(sitemap, _sitemap_get_url, &context, XML_HINT_REMOVE_EMPTY_CONTENT);
 
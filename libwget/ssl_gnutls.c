@@ -61,6 +61,7 @@
 #include <wget.h>
 #include "private.h"
 #include "net.h"
+#include "wget_probes.h"
 
 static struct _config {
 	const char
@@ -72,7 +73,8 @@ static struct _config {
 		*key_file,
 		*crl_file,
 		*ocsp_server,
-		*alpn;
+		*alpn,
+		*server_alpn;
 	wget_ocsp_db_t
 		*ocsp_cert_cache,
 		*ocsp_host_cache;
@@ -133,6 +135,7 @@ void wget_ssl_set_config_string(int key, const char *value)
 	case WGET_SSL_SESSION_CACHE: _config.tls_session_cache = (wget_tls_session_db_t *)value; break;
 	case WGET_SSL_HPKP_CACHE: _config.hpkp_cache = (wget_hpkp_db_t *)value; break;
 	case WGET_SSL_ALPN: _config.alpn = value; break;
+	case WGET_SSL_SERVER_ALPN: _config.server_alpn = value; break;
 	default: error_printf(_("Unknown config key %d (or value must not be a string)\n"), key);
 	}
 }
@@ -468,6 +471,8 @@ static int send_ocsp_request(const char *server,
 			if ((resp = wget_http_get_response(conn))) {
 				*ocsp_data = resp->body;
 				resp->body = NULL;
+				if (*ocsp_data)
+					memstats_free(WGET_MEMTAG_HTTP_BUFFERS, (*ocsp_data)->size);
 				wget_http_free_response(&resp);
 				ret = 0;
 			}
@@ -1268,6 +1273,48 @@ static ssize_t _ssl_writev(gnutls_transport_ptr_t *p, const giovec_t *iov, int i
 }
 #endif
 
+#if GNUTLS_VERSION_NUMBER >= 0x030200
+// offer (client) or accept (server) the comma separated protocols of 'alpn'
+static void _set_alpn(gnutls_session_t session, const char *alpn, unsigned flags)
+{
+	unsigned nprot;
+	const char *e, *s;
+	int rc;
+
+	for (nprot = 0, s = e = alpn; *e; s = e + 1)
+		if ((e = strchrnul(s, ',')) != s)
+			nprot++;
+
+	gnutls_datum_t data[nprot];
+
+	for (nprot = 0, s = e = alpn; *e; s = e + 1) {
+		if ((e = strchrnul(s, ',')) != s) {
+			data[nprot].data = (unsigned char *) s;
+			data[nprot].size = e - s;
+			debug_printf("ALPN offering %.*s\n", (int) data[nprot].size, data[nprot].data);
+			nprot++;
+		}
+	}
+
+	if ((rc = gnutls_alpn_set_protocols(session, data, nprot, flags)))
+		error_printf("GnuTLS: Set ALPN: %s\n", gnutls_strerror(rc));
+}
+
+static void _get_alpn(gnutls_session_t session, wget_tcp_t *tcp)
+{
+	gnutls_datum_t protocol;
+	int rc;
+
+	if ((rc = gnutls_alpn_get_selected_protocol(session, &protocol)))
+		debug_printf("GnuTLS: Get ALPN: %s\n", gnutls_strerror(rc));
+	else {
+		debug_printf("ALPN: Server accepted protocol '%.*s'\n", (int) protocol.size, protocol.data);
+		if (!memcmp(protocol.data, "h2", 2))
+			tcp->protocol = WGET_PROTOCOL_HTTP_2_0;
+	}
+}
+#endif
+
 int wget_ssl_open(wget_tcp_t *tcp)
 {
 	gnutls_session_t session;
@@ -1337,28 +1384,8 @@ int wget_ssl_open(wget_tcp_t *tcp)
 #endif
 
 #if GNUTLS_VERSION_NUMBER >= 0x030200
-	if (_config.alpn) {
-		unsigned nprot;
-		const char *e, *s;
-
-		for (nprot = 0, s = e = _config.alpn; *e; s = e + 1)
-			if ((e = strchrnul(s, ',')) != s)
-				nprot++;
-
-		gnutls_datum_t data[nprot];
-
-		for (nprot = 0, s = e = _config.alpn; *e; s = e + 1) {
-			if ((e = strchrnul(s, ',')) != s) {
-				data[nprot].data = (unsigned char *) s;
-				data[nprot].size = e - s;
-				debug_printf("ALPN offering %.*s\n", (int) data[nprot].size, data[nprot].data);
-				nprot++;
-			}
-		}
-
-		if ((rc = gnutls_alpn_set_protocols(session, data, nprot, 0)))
-			error_printf("GnuTLS: Set ALPN: %s\n", gnutls_strerror(rc));
-	}
+	if (_config.alpn)
+		_set_alpn(session, _config.alpn, 0);
 #endif
 
 	tcp->ssl_session = session;
@@ -1395,19 +1422,13 @@ int wget_ssl_open(wget_tcp_t *tcp)
 		}
 	}
 
+	WGET_PROBE2(tls_handshake_start, hostname, sockfd);
 	ret = _do_handshake(session, sockfd, connect_timeout);
+	WGET_PROBE2(tls_handshake_end, hostname, ret);
 
 #if GNUTLS_VERSION_NUMBER >= 0x030200
-	if (_config.alpn) {
-		gnutls_datum_t protocol;
-		if ((rc = gnutls_alpn_get_selected_protocol(session, &protocol)))
-			debug_printf("GnuTLS: Get ALPN: %s\n", gnutls_strerror(rc));
-		else {
-			debug_printf("ALPN: Server accepted protocol '%.*s'\n", (int) protocol.size, protocol.data);
-			if (!memcmp(protocol.data, "h2", 2))
-				tcp->protocol = WGET_PROTOCOL_HTTP_2_0;
-		}
-	}
+	if (_config.alpn)
+		_get_alpn(session, tcp);
 #endif
 
 	if (_config.print_info)
@@ -1466,6 +1487,41 @@ void wget_ssl_close(void **session)
 	}
 }
 
+/*
+ * Check if the verified certificate of an open TLS connection is also valid for 'hostname',
+ * so that requests for 'hostname' may be sent over this connection.
+ * Returns 1 if so, 0 if not or if certificates are not checked at all.
+ */
+int wget_ssl_check_peer_hostname(wget_tcp_t *tcp, const char *hostname)
+{
+	gnutls_session_t session;
+	const gnutls_datum_t *cert_list;
+	unsigned int cert_list_size;
+	gnutls_x509_crt_t cert;
+	int ret = 0;
+
+	if (!tcp || !(session = tcp->ssl_session) || !hostname || !_config.check_certificate)
+		return 0;
+
+	if (gnutls_certificate_type_get(session) != GNUTLS_CRT_X509)
+		return 0;
+
+	if (!(cert_list = gnutls_certificate_get_peers(session, &cert_list_size)) || !cert_list_size)
+		return 0;
+
+	if (gnutls_x509_crt_init(&cert) < 0)
+		return 0;
+
+	if (gnutls_x509_crt_import(cert, &cert_list[0], GNUTLS_X509_FMT_DER) == GNUTLS_E_SUCCESS
+		&& gnutls_x509_crt_check_hostname(cert, hostname)
+		&& !_cert_verify_hpkp(cert, hostname))
+		ret = 1;
+
+	gnutls_x509_crt_deinit(cert);
+
+	return ret;
+}
+
 static gnutls_certificate_credentials_t
 	_server_credentials;
 static gnutls_priority_t
@@ -1552,6 +1608,11 @@ int wget_ssl_server_open(wget_tcp_t *tcp)
 	 */
 	gnutls_certificate_server_set_request(session, GNUTLS_CERT_IGNORE);
 
+#if GNUTLS_VERSION_NUMBER >= 0x030200
+	if (_config.server_alpn)
+		_set_alpn(session, _config.server_alpn, GNUTLS_ALPN_SERVER_PRECEDENCE);
+#endif
+
 #ifdef HAVE_GNUTLS_TRANSPORT_GET_INT
 	// since GnuTLS 3.1.9, avoid warnings about illegal pointer conversion
 	gnutls_transport_set_int(session, sockfd);
@@ -1567,6 +1628,10 @@ int wget_ssl_server_open(wget_tcp_t *tcp)
 	if (ret == WGET_E_SUCCESS) {
 		debug_printf("Server handshake completed\n");
 		tcp->ssl_session = session;
+#if GNUTLS_VERSION_NUMBER >= 0x030200
+		if (_config.server_alpn)
+			_get_alpn(session, tcp);
+#endif
 	} else {
 		if (ret == WGET_E_TIMEOUT)
 			debug_printf("Server handshake timed out\n");
@@ -1706,6 +1771,7 @@ void wget_ssl_init(void) { }
 void wget_ssl_deinit(void) { }
 int wget_ssl_open(wget_tcp_t *tcp) { return WGET_E_TLS_DISABLED; }
 void wget_ssl_close(void **session) { }
+int wget_ssl_check_peer_hostname(wget_tcp_t *tcp, const char *hostname) { return 0; }
 ssize_t wget_ssl_read_timeout(void *session, char *buf, size_t count, int timeout) { return 0; }
 ssize_t wget_ssl_write_timeout(void *session, const char *buf, size_t count, int timeout) { return 0; }
 void wget_ssl_server_init(void) { }
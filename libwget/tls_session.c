@@ -154,6 +154,18 @@ int wget_tls_session_get(const wget_tls_session_db_t *tls_session_db, const char
 	return 1;
 }
 
+static inline size_t _tls_session_size(const wget_tls_session_t *tls_session)
+{
+	return sizeof(wget_tls_session_t) + strlen(tls_session->host) + 1 + tls_session->data_size;
+}
+
+// key and value are the same pointer, the hashmap calls only the key destructor
+static void _free_tls_session_entry(wget_tls_session_t *tls_session)
+{
+	memstats_free(WGET_MEMTAG_TLS, _tls_session_size(tls_session));
+	wget_tls_session_free(tls_session);
+}
+
 wget_tls_session_db_t *wget_tls_session_db_init(wget_tls_session_db_t *tls_session_db)
 {
 	if (!tls_session_db)
@@ -161,7 +173,7 @@ wget_tls_session_db_t *wget_tls_session_db_init(wget_tls_session_db_t *tls_sessi
 
 	memset(tls_session_db, 0, sizeof(*tls_session_db));
 	tls_session_db->entries = wget_hashmap_create(16, -2, (wget_hashmap_hash_t)_hash_tls_session, (wget_hashmap_compare_t)_compare_tls_session);
-	wget_hashmap_set_key_destructor(tls_session_db->entries, (wget_hashmap_key_destructor_t)wget_tls_session_free);
+	wget_hashmap_set_key_destructor(tls_session_db->entries, (wget_hashmap_key_destructor_t)_free_tls_session_entry);
 	wget_hashmap_set_value_destructor(tls_session_db->entries, (wget_hashmap_value_destructor_t)wget_tls_session_free);
 	wget_thread_mutex_init(&tls_session_db->mutex);
 
@@ -207,6 +219,7 @@ void wget_tls_session_db_add(wget_tls_session_db_t *tls_session_db, wget_tls_ses
 
 		debug_printf("add TLS session data for %s (maxage=%lld, size=%zu)\n", tls_session->host, (long long)tls_session->maxage, tls_session->data_size);
 		wget_hashmap_put_noalloc(tls_session_db->entries, tls_session, tls_session);
+		memstats_alloc(WGET_MEMTAG_TLS, _tls_session_size(tls_session));
 		tls_session_db->changed = 1;
 	}
 
@@ -249,8 +249,9 @@ int wget_strncasecmp(const char *s1, const char *s2, size_t n)
  */
 void wget_memtohex(const unsigned char *src, size_t src_len, char *dst, size_t dst_size)
 {
+	static const char hex[16] = "0123456789abcdef";
 	size_t it;
-	int adjust = 0, c;
+	int adjust = 0;
 
 	if (dst_size == 0)
 		return;
@@ -261,11 +262,11 @@ void wget_memtohex(const unsigned char *src, size_t src_len, char *dst, size_t d
 	}
 
 	for (it = 0; it < src_len; it++, src++) {
-		*dst++ = (c = (*src >> 4)) >= 10 ? c + 'a' - 10 : c + '0';
-		*dst++ = (c = (*src & 0xf)) >= 10 ? c + 'a' - 10 : c + '0';
+		*dst++ = hex[*src >> 4];
+		*dst++ = hex[*src & 0xf];
 	}
 	if (adjust && (dst_size & 1) == 0)
-		*dst++ = (c = (*src >> 4)) >= 10 ? c + 'a' - 10 : c + '0';
+		*dst++ = hex[*src >> 4];
 
 	*dst = 0;
 }
@@ -295,10 +296,25 @@ long long wget_get_timemillis(void)
 	return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
 }
 
-static _GL_INLINE unsigned char G_GNUC_WGET_CONST _unhex(unsigned char c)
-{
-	return c <= '9' ? c - '0' : (c <= 'F' ? c - 'A' + 10 : c - 'a' + 10);
-}
+// value of a hex digit, 0xFF for anything else
+static const unsigned char unhex[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 10, 11, 12, 13, 14, 15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 10, 11, 12, 13, 14, 15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
 
 /**
  * \param[in,out] src String to unescape
@@ -311,18 +327,20 @@ static _GL_INLINE unsigned char G_GNUC_WGET_CONST _unhex(unsigned char c)
  */
 int wget_percent_unescape(char *src)
 {
+	unsigned char *s, *d;
+	unsigned char hi, lo;
 	int ret = 0;
-	unsigned char *s = (unsigned char *)src; // just a helper to avoid casting a lot
-	unsigned char *d = s;
-
-	while (*s) {
-		if (*s == '%') {
-			if (c_isxdigit(s[1]) && c_isxdigit(s[2])) {
-				*d++ = (_unhex(s[1]) << 4) | _unhex(s[2]);
-				s += 3;
-				ret = 1;
-				continue;
-			}
+
+	// most strings don't contain any escapes, so we won't write anything
+	if (!(s = (unsigned char *)strchr(src, '%')))
+		return 0;
+
+	for (d = s; *s; ) {
+		if (*s == '%' && (hi = unhex[s[1]]) != 0xFF && (lo = unhex[s[2]]) != 0xFF) {
+			*d++ = (unsigned char) (hi << 4 | lo);
+			s += 3;
+			ret = 1;
+			continue;
 		}
 
 		*d++ = *s++;
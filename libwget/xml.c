@@ -57,7 +57,8 @@ struct XML_CONTEXT {
 		*p, // pointer next char in buffer
 		*token; // token buffer
 	int
-		hints; // XML_HINT...
+		hints, // XML_HINT...
+		depth; // current nesting level
 	size_t
 		token_size, // size of token buffer
 		token_len; // used bytes of token buffer (not counting terminating 0 byte)
@@ -67,6 +68,9 @@ struct XML_CONTEXT {
 		callback;
 };
 
+// deeper nesting stops parsing, each level takes stack space
+#define XML_MAX_DEPTH 256
+
 #define ascii_isspace(c) (c == ' ' || (c >= 9 && c <=  13))
 
 // working only for consecutive alphabets, e.g. EBCDIC would not work
@@ -74,7 +78,7 @@ struct XML_CONTEXT {
 
 // append a char to token buffer
 
-static const char *getToken(XML_CONTEXT *context)
+static const char *_getToken(XML_CONTEXT *context)
 {
 	int c;
 	const char *p;
@@ -191,6 +195,17 @@ static const char *getToken(XML_CONTEXT *context)
 	return NULL;
 }
 
+// on end of input the read pointer stays on the terminating 0 byte, callers may continue reading
+static const char *getToken(XML_CONTEXT *context)
+{
+	const char *tok = _getToken(context);
+
+	if (!tok && context->p > context->buf && !context->p[-1])
+		context->p--;
+
+	return tok;
+}
+
 static int getValue(XML_CONTEXT *context)
 {
 	int c;
@@ -200,7 +215,10 @@ static int getValue(XML_CONTEXT *context)
 
 	// remove leading spaces
 	while ((c = *context->p++) && ascii_isspace(c));
-	if (!c) return EOF;
+	if (!c) {
+		context->p--;
+		return EOF;
+	}
 
 	if (c == '=') {
 		if (!getToken(context))
@@ -407,8 +425,14 @@ static void parseXML(const char *dir, XML_CONTEXT *context)
 							if (context->token_len)
 								debug_printf("%s=%.*s\n", directory, (int)context->token_len, context->token);
 						}
-					} else
+					} else if (context->depth >= XML_MAX_DEPTH) {
+						debug_printf("XML nesting deeper than %d levels, stop parsing\n", XML_MAX_DEPTH);
+						context->p += strlen(context->p);
+					} else {
+						context->depth++;
 						parseXML(directory, context); // descend one level
+						context->depth--;
+					}
 					break;
 				} else {
 //					snprintf(attribute, sizeof(attribute), "%.*s", (int)context->token_len, tok);
@@ -484,6 +508,7 @@ void wget_xml_parse_buffer(
 	context.user_ctx = user_ctx;
 	context.callback = callback;
 	context.hints = hints;
+	context.depth = 0;
 
 	parseXML("/", &context);
 }
@@ -86,8 +86,12 @@ int blacklist_size(void)
 	return wget_hashmap_size(blacklist);
 }
 
+// the IRI and its string copies are allocated in one chunk (see wget_iri_parse())
+#define _iri_size(iri) (sizeof(wget_iri_t) + strlen((iri)->uri) * 2 + 2)
+
 static void _free_entry(wget_iri_t *iri)
 {
+	memstats_free(WGET_MEMTAG_BLACKLIST, _iri_size(iri));
 	wget_iri_free(&iri);
 }
 
@@ -107,6 +111,7 @@ wget_iri_t *blacklist_add(wget_iri_t *iri)
 		if (!wget_hashmap_contains(blacklist, iri)) {
 			// info_printf("Add to blacklist: %s\n",iri->uri);
 			wget_hashmap_put_noalloc(blacklist, iri, NULL); // use hashmap as a hashset (without value)
+			memstats_alloc(WGET_MEMTAG_BLACKLIST, _iri_size(iri));
 			wget_thread_mutex_unlock(&mutex);
 			return iri;
 		}
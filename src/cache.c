@@ -0,0 +1,754 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Persistent HTTP cache (RFC 9111, private cache)
+ *
+ * Each stored response is a file named by the SHA-1 of the normalized URL:
+ *   WGET2-CACHE 1
+ *   <request time> <response time>
+ *   <URL>
+ *   <name>: <value>     (request header fields selected by Vary, zero or more lines)
+ *   <empty line>
+ *   <response header, CRLF separated, with an empty line at the end>
+ *   <decoded body>
+ *
+ * Entries are written into a temporary file and renamed into place, so downloader
+ * threads (and concurrent wget2 processes) never see partial entries.
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <c-ctype.h>
+#include "safe-write.h"
+
+#include <wget.h>
+
+#include "wget_main.h"
+#include "wget_options.h"
+#include "wget_cache.h"
+
+#define CACHE_MAGIC "WGET2-CACHE 1\n"
+
+struct CACHE_ENTRY {
+	char
+		*fname, // path of the entry file
+		*data, // content of the entry file
+		*etag;
+	const char
+		*uri,
+		*vary, // 'name: value' lines of the request header fields selected by Vary
+		*header, // response header
+		*body;
+	size_t
+		vary_length,
+		header_length,
+		body_length;
+	time_t
+		request_time,
+		response_time,
+		date,
+		age,
+		lifetime, // freshness lifetime
+		last_modified;
+	unsigned char
+		no_cache : 1, // always revalidate
+		no_store : 1, // must not be stored
+		vary_any : 1; // 'Vary: *'
+};
+
+// a header field, name and value are not 0-terminated
+typedef struct {
+	const char
+		*line,
+		*name,
+		*value;
+	size_t
+		linelen,
+		namelen,
+		valuelen;
+} _cache_field_t;
+
+static wget_thread_mutex_t
+	mutex = WGET_THREAD_MUTEX_INITIALIZER;
+static int
+	nhits,
+	nrevalidated,
+	nmisses;
+static unsigned int
+	tmp_serial;
+
+// iterate over the fields of a CRLF separated header, 'p' has to point behind the status line
+static const char *_cache_next_field(const char *p, _cache_field_t *field)
+{
+	const char *eol, *colon;
+
+	while ((eol = strstr(p, "\r\n")) && eol != p) {
+		field->line = p;
+		field->linelen = eol - p;
+
+		if ((colon = memchr(p, ':', eol - p))) {
+			field->name = p;
+			for (field->namelen = colon - p; field->namelen && c_isblank(p[field->namelen - 1]); field->namelen--);
+
+			for (field->value = colon + 1; field->value < eol && c_isblank(*field->value); field->value++);
+			for (field->valuelen = eol - field->value; field->valuelen && c_isblank(field->value[field->valuelen - 1]); field->valuelen--);
+
+			return eol + 2;
+		}
+
+		p = eol + 2; // skip malformed line
+	}
+
+	return NULL;
+}
+
+static int _cache_field_is(const _cache_field_t *field, const char *name)
+{
+	size_t namelen = strlen(name);
+
+	return field->namelen == namelen && !wget_strncasecmp_ascii(field->name, name, namelen);
+}
+
+// skip the status line of a CRLF separated header
+static const char *_cache_first_field(const char *header)
+{
+	const char *p = strstr(header, "\r\n");
+
+	return p ? p + 2 : header + strlen(header);
+}
+
+static time_t _cache_parse_date(const char *s, size_t len)
+{
+	char buf[64];
+
+	if (len >= sizeof(buf))
+		return 0;
+
+	memcpy(buf, s, len);
+	buf[len] = 0;
+
+	return wget_http_parse_full_date(buf);
+}
+
+// hop-by-hop fields and fields describing the encoded message are not stored,
+// the body is kept as it has been written to disk (de-chunked and decompressed).
+// Cookies are processed when received, they must not be replayed from the cache.
+static int _cache_is_stored_field(const char *name, size_t namelen)
+{
+	static const char *skip[] = {
+		"Connection", "Content-Encoding", "Content-Length", "Keep-Alive", "Proxy-Connection",
+		"Set-Cookie", "TE", "Trailer", "Transfer-Encoding", "Upgrade"
+	};
+
+	if (*name == ':')
+		return 0; // HTTP/2 pseudo header
+
+	for (unsigned it = 0; it < countof(skip); it++) {
+		if (strlen(skip[it]) == namelen && !wget_strncasecmp_ascii(name, skip[it], namelen))
+			return 0;
+	}
+
+	return 1;
+}
+
+// convert the received header (LF or CRLF separated, HTTP/2 without status line) into what we store
+static void _cache_normalize_header(const wget_http_response_t *resp, wget_buffer_t *buf)
+{
+	const char *line, *eol;
+
+	line = resp->header ? resp->header->data : "";
+
+	if (wget_strncasecmp_ascii(line, "HTTP/", 5))
+		wget_buffer_printf_append(buf, "HTTP/1.1 %d %s\r\n", resp->code, resp->reason);
+
+	for (int first = 1; *line; line = eol + 1, first = 0) {
+		size_t len;
+		const char *colon;
+
+		if (!(eol = strchr(line, '\n')))
+			eol = line + strlen(line) - 1;
+
+		len = eol - line + 1;
+		while (len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			len--;
+
+		if (!len)
+			break; // end of header
+
+		if (!(first && !wget_strncasecmp_ascii(line, "HTTP/", 5))) {
+			if (!(colon = memchr(line, ':', len)) || colon == line)
+				continue;
+
+			if (!_cache_is_stored_field(line, colon - line))
+				continue;
+		}
+
+		wget_buffer_memcat(buf, line, len);
+		wget_buffer_memcat(buf, "\r\n", 2);
+	}
+
+	wget_buffer_memcat(buf, "\r\n", 2);
+}
+
+static void _cache_parse_cache_control(CACHE_ENTRY *entry, const char *s, size_t len, long long *max_age)
+{
+	const char *end = s + len, *token;
+
+	while (s < end) {
+		while (s < end && (c_isblank(*s) || *s == ','))
+			s++;
+
+		for (token = s; s < end && *s != ','; s++);
+
+		len = s - token;
+		while (len && c_isblank(token[len - 1]))
+			len--;
+
+		if (len >= 8 && !wget_strncasecmp_ascii(token, "no-cache", 8) && (len == 8 || token[8] == '='))
+			entry->no_cache = 1; // also with a field list, revalidation is the safe choice
+		else if (len == 8 && !wget_strncasecmp_ascii(token, "no-store", 8))
+			entry->no_store = 1;
+		else if (len > 8 && !wget_strncasecmp_ascii(token, "max-age=", 8))
+			*max_age = atoll(token + 8 + (token[8] == '"'));
+	}
+}
+
+// extract the caching relevant fields from the stored header, RFC 9111 4.2
+// returns 1 if the server gave the lifetime (max-age, Expires)
+static int _cache_parse_header(CACHE_ENTRY *entry)
+{
+	_cache_field_t field;
+	const char *p;
+	long long max_age = -1;
+	time_t expires = 0, base;
+	int has_expires = 0;
+
+	entry->date = entry->age = entry->last_modified = entry->lifetime = 0;
+	entry->no_cache = entry->no_store = entry->vary_any = 0;
+	xfree(entry->etag);
+
+	for (p = _cache_first_field(entry->header); (p = _cache_next_field(p, &field)); ) {
+		if (_cache_field_is(&field, "Date"))
+			entry->date = _cache_parse_date(field.value, field.valuelen);
+		else if (_cache_field_is(&field, "Age"))
+			entry->age = (time_t) atoll(field.value);
+		else if (_cache_field_is(&field, "Expires")) {
+			has_expires = 1;
+			expires = _cache_parse_date(field.value, field.valuelen); // invalid dates mean 'already expired'
+		} else if (_cache_field_is(&field, "Last-Modified"))
+			entry->last_modified = _cache_parse_date(field.value, field.valuelen);
+		else if (_cache_field_is(&field, "ETag")) {
+			xfree(entry->etag);
+			entry->etag = wget_strmemdup(field.value, field.valuelen);
+		} else if (_cache_field_is(&field, "Cache-Control"))
+			_cache_parse_cache_control(entry, field.value, field.valuelen, &max_age);
+		else if (_cache_field_is(&field, "Vary") && memchr(field.value, '*', field.valuelen))
+			entry->vary_any = 1;
+	}
+
+	base = entry->date ? entry->date : entry->response_time;
+
+	if (max_age >= 0)
+		entry->lifetime = (time_t) max_age;
+	else if (has_expires)
+		entry->lifetime = expires > base ? expires - base : 0;
+	else if (entry->last_modified && entry->last_modified < base)
+		entry->lifetime = (base - entry->last_modified) / 10; // heuristic freshness, RFC 9111 4.2.2
+
+	return max_age >= 0 || has_expires;
+}
+
+// takes ownership of 'data'
+static int _cache_entry_parse(CACHE_ENTRY *entry, char *data, size_t size)
+{
+	char *p, *end;
+	long long request_time, response_time;
+
+	xfree(entry->data);
+	entry->data = data;
+
+	if (size < sizeof(CACHE_MAGIC) - 1 || memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC) - 1))
+		return -1;
+
+	p = data + sizeof(CACHE_MAGIC) - 1;
+	if (sscanf(p, "%lld %lld", &request_time, &response_time) != 2 || !(p = strchr(p, '\n')))
+		return -1;
+
+	entry->request_time = (time_t) request_time;
+	entry->response_time = (time_t) response_time;
+
+	entry->uri = ++p;
+	if (!(p = strchr(p, '\n')))
+		return -1;
+	*p++ = 0;
+
+	for (entry->vary = p; *p != '\n'; p++) {
+		if (!(p = strchr(p, '\n')))
+			return -1;
+	}
+	entry->vary_length = p++ - entry->vary;
+
+	entry->header = p;
+	if (!(end = strstr(p, "\r\n\r\n")))
+		return -1;
+
+	entry->header_length = end + 4 - p;
+	entry->body = end + 4;
+	entry->body_length = size - (entry->body - data);
+
+	_cache_parse_header(entry);
+
+	return 0;
+}
+
+// normalized URL, sha1(url) is the name of the entry file
+static void _cache_key(const wget_iri_t *iri, wget_buffer_t *buf)
+{
+	wget_buffer_strcpy(buf, iri->scheme);
+	wget_buffer_memcat(buf, "://", 3);
+	wget_buffer_strcat(buf, iri->host);
+	if (iri->resolv_port) {
+		wget_buffer_memcat(buf, ":", 1);
+		wget_buffer_strcat(buf, iri->resolv_port);
+	}
+	wget_buffer_memcat(buf, "/", 1);
+	wget_iri_get_escaped_resource(iri, buf);
+}
+
+static char *_cache_filename(const char *key)
+{
+	unsigned char digest[20];
+	char hex[sizeof(digest) * 2 + 1];
+
+	wget_hash_fast(WGET_DIGTYPE_SHA1, key, strlen(key), digest);
+	wget_memtohex(digest, sizeof(digest), hex, sizeof(hex));
+
+	// two levels to keep directories small on large mirrors
+	return wget_aprintf("%s/%.2s/%s", config.cache_dir, hex, hex + 2);
+}
+
+// the value of a request header field, multiple fields are combined
+static void _cache_request_field(const wget_http_request_t *req, const char *name, size_t namelen, wget_buffer_t *buf)
+{
+	int found = 0;
+
+	for (int it = 0; it < wget_vector_size(req->headers); it++) {
+		wget_http_header_param_t *param = wget_vector_get(req->headers, it);
+
+		if (!wget_strncasecmp_ascii(param->name, name, namelen) && !param->name[namelen]) {
+			if (found++)
+				wget_buffer_memcat(buf, ", ", 2);
+			wget_buffer_strcat(buf, param->value);
+		}
+	}
+}
+
+// check that the request selects the stored response (RFC 9111 4.1)
+static int _cache_vary_matches(const CACHE_ENTRY *entry, const wget_http_request_t *req)
+{
+	const char *p, *end, *eol, *colon;
+	wget_buffer_t buf;
+	char sbuf[256];
+	int ok = 1;
+
+	wget_buffer_init(&buf, sbuf, sizeof(sbuf));
+
+	for (p = entry->vary, end = p + entry->vary_length; ok && p < end; p = eol + 1) {
+		eol = memchr(p, '\n', end - p);
+
+		if (!(colon = memchr(p, ':', eol - p)))
+			continue;
+
+		wget_buffer_reset(&buf);
+		_cache_request_field(req, p, colon - p, &buf);
+
+		ok = buf.length == (size_t) (eol - colon - 2) && !memcmp(buf.data, colon + 2, buf.length);
+	}
+
+	wget_buffer_deinit(&buf);
+
+	return ok;
+}
+
+static char *_cache_read(const char *fname, size_t *size)
+{
+	struct stat st;
+	char *buf = NULL;
+	int fd;
+
+	if ((fd = open(fname, O_RDONLY)) == -1) {
+		if (errno != ENOENT)
+			debug_printf("Failed to open cache entry %s (errno=%d)\n", fname, errno);
+		return NULL;
+	}
+
+	if (fstat(fd, &st) == 0) {
+		ssize_t nbytes;
+		size_t total = 0;
+
+		if (!(buf = wget_malloc(st.st_size + 1))) {
+			close(fd);
+			return NULL;
+		}
+
+		while (total < (size_t) st.st_size && (nbytes = read(fd, buf + total, st.st_size - total)) > 0)
+			total += nbytes;
+		buf[total] = 0;
+		*size = total;
+	}
+
+	close(fd);
+
+	return buf;
+}
+
+static int _cache_write(const char *fname, const wget_buffer_t *content)
+{
+	char *tmpname, *slash;
+	unsigned int serial;
+	int fd, rc = -1;
+
+	wget_thread_mutex_lock(&mutex);
+	serial = tmp_serial++;
+	wget_thread_mutex_unlock(&mutex);
+
+	tmpname = wget_aprintf("%s.%d.%u", fname, (int) getpid(), serial);
+
+	// create the fan-out directory
+	if ((slash = strrchr(tmpname, '/'))) {
+		*slash = 0;
+		if (mkdir(tmpname, 0755) != 0 && errno != EEXIST)
+			debug_printf("Failed to create cache directory %s (errno=%d)\n", tmpname, errno);
+		*slash = '/';
+	}
+
+	if ((fd = open(tmpname, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) != -1) {
+		if (safe_write(fd, content->data, content->length) == content->length) {
+			close(fd);
+			if (rename(tmpname, fname) == 0)
+				rc = 0;
+		} else
+			close(fd);
+
+		if (rc)
+			unlink(tmpname);
+	}
+
+	if (rc)
+		error_printf(_("Failed to write cache entry %s (errno=%d)\n"), fname, errno);
+
+	xfree(tmpname);
+	return rc;
+}
+
+static void _cache_serialize(wget_buffer_t *buf, time_t request_time, time_t response_time, const char *uri,
+	const char *vary, size_t vary_length, const char *header, size_t header_length, const char *body, size_t body_length)
+{
+	wget_buffer_strcpy(buf, CACHE_MAGIC);
+	wget_buffer_printf_append(buf, "%lld %lld\n%s\n", (long long) request_time, (long long) response_time, uri);
+	wget_buffer_memcat(buf, vary, vary_length);
+	wget_buffer_memcat(buf, "\n", 1);
+	wget_buffer_memcat(buf, header, header_length);
+	wget_buffer_memcat(buf, body, body_length);
+}
+
+CACHE_ENTRY *cache_lookup(const wget_iri_t *iri, const wget_http_request_t *req)
+{
+	CACHE_ENTRY *entry;
+	wget_buffer_t key;
+	char sbuf[256], *data;
+	size_t size;
+
+	wget_buffer_init(&key, sbuf, sizeof(sbuf));
+	_cache_key(iri, &key);
+
+	entry = wget_calloc(1, sizeof(CACHE_ENTRY));
+	entry->fname = _cache_filename(key.data);
+
+	if (!(data = _cache_read(entry->fname, &size))) {
+		cache_entry_free(&entry);
+	} else if (_cache_entry_parse(entry, data, size) || strcmp(entry->uri, key.data)) {
+		debug_printf("Ignoring unusable cache entry %s\n", entry->fname);
+		cache_entry_free(&entry);
+	} else if (!_cache_vary_matches(entry, req)) {
+		debug_printf("Cache entry for %s doesn't match the request (Vary)\n", key.data);
+		cache_entry_free(&entry);
+	}
+
+	wget_buffer_deinit(&key);
+
+	return entry;
+}
+
+/*
+ * Seconds a just received response may be reused without asking the server, e.g. a permanent redirect.
+ * 'heuristic' is taken if the server doesn't give a lifetime (max-age, Expires), RFC 9111 4.2.2.
+ * Returns 0 if the response must not be reused (no-store, no-cache or already stale).
+ */
+time_t cache_response_lifetime(const wget_http_response_t *resp, time_t heuristic)
+{
+	CACHE_ENTRY entry = { .header = NULL };
+	wget_buffer_t *header;
+	time_t lifetime, age;
+
+	header = wget_buffer_alloc(resp->header ? resp->header->length + 64 : 128);
+	_cache_normalize_header(resp, header);
+
+	entry.header = header->data;
+	entry.response_time = time(NULL);
+	lifetime = _cache_parse_header(&entry) ? entry.lifetime : heuristic;
+
+	// RFC 9111 4.2.3, the request time is close enough to the response time here
+	age = entry.date && entry.response_time > entry.date ? entry.response_time - entry.date : 0;
+	if (age < entry.age)
+		age = entry.age;
+
+	if (entry.no_store || entry.no_cache || lifetime <= age)
+		lifetime = 0;
+	else
+		lifetime -= age;
+
+	xfree(entry.etag);
+	wget_buffer_free(&header);
+
+	return lifetime;
+}
+
+int cache_entry_is_fresh(const CACHE_ENTRY *entry)
+{
+	time_t now = time(NULL), apparent_age, corrected_age, current_age;
+
+	// --no-cache: we send 'Pragma: no-cache', stored responses need revalidation
+	if (entry->no_cache || !config.cache)
+		return 0;
+
+	// RFC 9111 4.2.3
+	apparent_age = entry->date && entry->response_time > entry->date ? entry->response_time - entry->date : 0;
+	corrected_age = entry->age + (entry->response_time - entry->request_time);
+	current_age = (apparent_age > corrected_age ? apparent_age : corrected_age) + (now - entry->response_time);
+
+	return entry->lifetime > current_age;
+}
+
+static int _cache_has_field(const wget_http_request_t *req, const char *name)
+{
+	for (int it = 0; it < wget_vector_size(req->headers); it++) {
+		wget_http_header_param_t *param = wget_vector_get(req->headers, it);
+
+		if (!wget_strcasecmp_ascii(param->name, name))
+			return 1;
+	}
+
+	return 0;
+}
+
+void cache_entry_add_validators(const CACHE_ENTRY *entry, wget_http_request_t *req)
+{
+	if (entry->etag && !_cache_has_field(req, "If-None-Match"))
+		wget_http_add_header(req, "If-None-Match", entry->etag);
+
+	if (entry->last_modified && !_cache_has_field(req, "If-Modified-Since")) {
+		char http_date[32];
+
+		wget_http_print_date(entry->last_modified, http_date, sizeof(http_date));
+		wget_http_add_header(req, "If-Modified-Since", http_date);
+	}
+}
+
+wget_http_response_t *cache_entry_get_response(const CACHE_ENTRY *entry)
+{
+	wget_http_response_t *resp;
+	char *header = wget_strmemdup(entry->header, entry->header_length);
+
+	resp = wget_http_parse_response_header(header); // modifies 'header'
+	xfree(header);
+
+	if (resp) {
+		resp->header = wget_buffer_alloc(entry->header_length);
+		wget_buffer_memcpy(resp->header, entry->header, entry->header_length);
+		resp->content_length = entry->body_length;
+		resp->content_length_valid = 1;
+	}
+
+	return resp;
+}
+
+const char *cache_entry_get_body(const CACHE_ENTRY *entry, size_t *length)
+{
+	*length = entry->body_length;
+	return entry->body;
+}
+
+// merge the fields of a 304 response into the stored header (RFC 9111 4.3.4) and save the entry
+void cache_entry_update(CACHE_ENTRY *entry, const wget_http_response_t *resp, time_t request_time)
+{
+	wget_buffer_t *update = wget_buffer_alloc(1024), *header = wget_buffer_alloc(entry->header_length + 256), *content;
+	_cache_field_t field, field2;
+	const char *p, *p2, *fields;
+
+	_cache_normalize_header(resp, update);
+	fields = _cache_first_field(update->data);
+
+	// keep the stored status line and all fields not sent with the 304
+	p = _cache_first_field(entry->header);
+	wget_buffer_memcpy(header, entry->header, p - entry->header);
+
+	while ((p = _cache_next_field(p, &field))) {
+		for (p2 = fields; (p2 = _cache_next_field(p2, &field2)); ) {
+			if (field.namelen == field2.namelen && !wget_strncasecmp_ascii(field.name, field2.name, field.namelen))
+				break;
+		}
+
+		if (!p2) {
+			wget_buffer_memcat(header, field.line, field.linelen);
+			wget_buffer_memcat(header, "\r\n", 2);
+		}
+	}
+
+	// append the fields of the 304 (they already end with an empty line)
+	wget_buffer_strcat(header, fields);
+
+	content = wget_buffer_alloc(header->length + entry->vary_length + entry->body_length + 256);
+	_cache_serialize(content, request_time, time(NULL), entry->uri, entry->vary, entry->vary_length,
+		header->data, header->length, entry->body, entry->body_length);
+
+	_cache_write(entry->fname, content);
+
+	// the entry now refers to the new content
+	_cache_entry_parse(entry, content->data, content->length);
+	content->data = NULL; // ownership moved into entry
+	wget_buffer_free(&content);
+
+	wget_buffer_free(&header);
+	wget_buffer_free(&update);
+}
+
+void cache_store(const wget_iri_t *iri, const wget_http_request_t *req, const wget_http_response_t *resp,
+	const char *body, size_t length, time_t request_time)
+{
+	CACHE_ENTRY entry = { .header = NULL };
+	wget_buffer_t *header, *vary, *key;
+	_cache_field_t field;
+	const char *p;
+
+	if (resp->code != 200 || strcmp(req->method, "GET"))
+		return;
+
+	header = wget_buffer_alloc(resp->header ? resp->header->length + 64 : 128);
+	_cache_normalize_header(resp, header);
+
+	entry.header = header->data;
+	entry.response_time = time(NULL);
+	_cache_parse_header(&entry);
+
+	if (entry.no_store || entry.vary_any || (!entry.lifetime && !entry.etag && !entry.last_modified)) {
+		debug_printf("Response for %s is not cacheable\n", iri->uri);
+		xfree(entry.etag);
+		wget_buffer_free(&header);
+		return;
+	}
+
+	// remember the request fields that select this response
+	vary = wget_buffer_alloc(128);
+	for (p = _cache_first_field(header->data); (p = _cache_next_field(p, &field)); ) {
+		const char *s, *end, *name;
+
+		if (!_cache_field_is(&field, "Vary"))
+			continue;
+
+		for (s = field.value, end = s + field.valuelen; s < end; ) {
+			while (s < end && (c_isblank(*s) || *s == ','))
+				s++;
+			for (name = s; s < end && *s != ',' && !c_isblank(*s); s++);
+
+			if (s > name) {
+				wget_buffer_memcat(vary, name, s - name);
+				wget_buffer_memcat(vary, ": ", 2);
+				_cache_request_field(req, name, s - name, vary);
+				wget_buffer_memcat(vary, "\n", 1);
+			}
+		}
+	}
+
+	key = wget_buffer_alloc(256);
+	_cache_key(iri, key);
+
+	wget_buffer_t *content = wget_buffer_alloc(header->length + vary->length + length + 256);
+	_cache_serialize(content, request_time, entry.response_time, key->data, vary->data, vary->length,
+		header->data, header->length, body ? body : "", body ? length : 0);
+
+	char *fname = _cache_filename(key->data);
+	if (!_cache_write(fname, content))
+		debug_printf("Stored %s in cache (%zu bytes)\n", key->data, length);
+	xfree(fname);
+
+	wget_buffer_free(&content);
+	wget_buffer_free(&key);
+	wget_buffer_free(&vary);
+	wget_buffer_free(&header);
+	xfree(entry.etag);
+}
+
+void cache_entry_free(CACHE_ENTRY **entry)
+{
+	if (entry && *entry) {
+		xfree((*entry)->fname);
+		xfree((*entry)->data);
+		xfree((*entry)->etag);
+		xfree(*entry);
+	}
+}
+
+void cache_count(cache_result_t result)
+{
+	wget_thread_mutex_lock(&mutex);
+	if (result == CACHE_HIT)
+		nhits++;
+	else if (result == CACHE_REVALIDATED)
+		nrevalidated++;
+	else
+		nmisses++;
+	wget_thread_mutex_unlock(&mutex);
+}
+
+int cache_init(void)
+{
+	if (mkdir(config.cache_dir, 0755) != 0 && errno != EEXIST) {
+		error_printf(_("Failed to create cache directory '%s' (errno=%d)\n"), config.cache_dir, errno);
+		return -1;
+	}
+
+	return 0;
+}
+
+void cache_exit(void)
+{
+	info_printf(_("HTTP cache: %d hits, %d revalidated, %d misses\n"), nhits, nrevalidated, nmisses);
+}
@@ -0,0 +1,528 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Compressed file output (--compress-output)
+ *
+ * The data of a file is cut into chunks, each chunk is compressed into a gzip
+ * member of its own by a small pool of threads and the members are appended
+ * to the file in order. Concatenated members are a valid gzip file, and after
+ * an interruption the file can be cut back to the last complete member to
+ * continue from there (--continue).
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include "safe-write.h"
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include <wget.h>
+
+#include "wget_main.h"
+#include "wget_options.h"
+#include "wget_compress.h"
+#include "wget_probes.h"
+
+#define COMPRESS_CHUNK_SIZE (1024 * 1024) // uncompressed size of a gzip member
+#define COMPRESS_THREADS 2 // number of compression threads
+#define COMPRESS_QUEUE_MAX (4 * COMPRESS_THREADS) // max. number of chunks waiting for compression
+
+struct COMPRESSED_FILE {
+	char
+		*fname;
+	wget_buffer_t
+		*chunk; // data collected for the next gzip member
+	long long
+		bytes_in,
+		bytes_out;
+	time_t
+		mtime; // modification time to be set when the file is complete, 0 if none
+	int
+		fd,
+		pending; // number of chunks queued or being compressed
+	unsigned
+		next_seq, // sequence number of the next chunk
+		write_seq; // sequence number of the next chunk to be written
+	unsigned char
+		error : 1,
+		closing : 1; // no more data, the file is closed after the last member
+};
+
+typedef struct {
+	COMPRESSED_FILE
+		*file;
+	wget_buffer_t
+		*data;
+	unsigned
+		seq;
+} _compress_chunk_t;
+
+static wget_thread_mutex_t
+	mutex = WGET_THREAD_MUTEX_INITIALIZER;
+static wget_thread_cond_t
+	cond;
+static wget_list_t
+	*queue;
+static wget_thread_t
+	compress_threads[COMPRESS_THREADS];
+static int
+	compress_nthreads,
+	queued,
+	stop_threads;
+static long long
+	total_in,
+	total_out;
+
+#ifdef WITH_ZLIB
+static int _compress_member(const wget_buffer_t *in, wget_buffer_t *out)
+{
+	z_stream z = { .next_in = NULL };
+	int rc;
+
+	if (deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return -1;
+
+	wget_buffer_ensure_capacity(out, deflateBound(&z, in->length));
+
+	z.next_in = (unsigned char *) in->data;
+	z.avail_in = (unsigned) in->length;
+	z.next_out = (unsigned char *) out->data;
+	z.avail_out = (unsigned) out->size;
+
+	rc = deflate(&z, Z_FINISH);
+	out->length = z.total_out;
+	deflateEnd(&z);
+
+	return rc == Z_STREAM_END ? 0 : -1;
+}
+#else
+static int _compress_member(const wget_buffer_t *in G_GNUC_WGET_UNUSED, wget_buffer_t *out G_GNUC_WGET_UNUSED)
+{
+	return -1;
+}
+#endif
+
+// all members have been written: set the file date and close the file
+static void _compress_finish(COMPRESSED_FILE *file)
+{
+	debug_printf("compressed %lld bytes into %lld bytes for %s\n", file->bytes_in, file->bytes_out, file->fname);
+
+	if (file->mtime)
+		set_file_mtime(file->fd, file->mtime);
+
+	if (config.fsync_policy) {
+		if (fsync(file->fd) < 0 && errno == EIO) {
+			error_printf(_("Failed to fsync errno=%d\n"), errno);
+			set_exit_status(3);
+		}
+	}
+
+	WGET_PROBE1(file_close, file->fd);
+	close(file->fd);
+
+	xfree(file->fname);
+	xfree(file);
+}
+
+static void _compress_chunk(_compress_chunk_t *chunk)
+{
+	COMPRESSED_FILE *file = chunk->file;
+	wget_buffer_t *out = wget_buffer_alloc(chunk->data->length / 2 + 64);
+	int rc = _compress_member(chunk->data, out);
+	bool finish;
+
+	// chunks of a file are compressed in parallel, but written in order
+	wget_thread_mutex_lock(&mutex);
+	while (file->write_seq != chunk->seq)
+		wget_thread_cond_wait(&cond, &mutex, 0);
+	wget_thread_mutex_unlock(&mutex);
+
+	if (file->error)
+		rc = -1;
+	else if (rc)
+		error_printf(_("Failed to compress data for %s\n"), file->fname);
+	else if (safe_write(file->fd, out->data, out->length) != out->length) {
+		error_printf(_("Failed to write file %s (errno=%d)\n"), file->fname, errno);
+		rc = -1;
+	}
+
+	if (rc)
+		set_exit_status(3);
+
+	wget_thread_mutex_lock(&mutex);
+	if (rc)
+		file->error = 1;
+	else {
+		file->bytes_out += out->length;
+		total_in += chunk->data->length;
+		total_out += out->length;
+	}
+	file->write_seq++;
+	file->pending--;
+	finish = file->closing && !file->pending;
+	wget_thread_cond_signal(&cond);
+	wget_thread_mutex_unlock(&mutex);
+
+	wget_buffer_free(&out);
+	wget_buffer_free(&chunk->data);
+
+	if (finish)
+		_compress_finish(file);
+}
+
+static void *_compress_thread(void *p G_GNUC_WGET_UNUSED)
+{
+	wget_thread_mutex_lock(&mutex);
+
+	for (;;) {
+		_compress_chunk_t *first = wget_list_getfirst(queue);
+
+		if (first) {
+			_compress_chunk_t chunk = *first;
+
+			wget_list_remove(&queue, first);
+			queued--;
+			wget_thread_cond_signal(&cond); // there is space in the queue again
+			wget_thread_mutex_unlock(&mutex);
+
+			_compress_chunk(&chunk);
+
+			wget_thread_mutex_lock(&mutex);
+		} else if (stop_threads)
+			break;
+		else
+			wget_thread_cond_wait(&cond, &mutex, 0);
+	}
+
+	wget_thread_mutex_unlock(&mutex);
+
+	return NULL;
+}
+
+static void _compress_submit(COMPRESSED_FILE *file)
+{
+	_compress_chunk_t chunk = { .file = file, .data = file->chunk };
+
+	file->chunk = NULL;
+
+	wget_thread_mutex_lock(&mutex);
+	chunk.seq = file->next_seq++;
+	file->pending++;
+
+	if (!compress_nthreads) {
+		wget_thread_mutex_unlock(&mutex);
+		_compress_chunk(&chunk);
+		return;
+	}
+
+	// the queue is bounded, if compression can't keep up the download has to wait
+	while (queued >= COMPRESS_QUEUE_MAX)
+		wget_thread_cond_wait(&cond, &mutex, 0);
+
+	wget_list_append(&queue, &chunk, sizeof(chunk));
+	queued++;
+	wget_thread_cond_signal(&cond);
+	wget_thread_mutex_unlock(&mutex);
+}
+
+COMPRESSED_FILE *compress_open(int fd, const char *fname)
+{
+	COMPRESSED_FILE *file = wget_calloc(1, sizeof(COMPRESSED_FILE));
+
+	file->fd = fd;
+	file->fname = wget_strdup(fname);
+
+	return file;
+}
+
+void compress_write(COMPRESSED_FILE *file, const void *data, size_t length)
+{
+	file->bytes_in += length;
+
+	while (length) {
+		size_t n;
+
+		if (!file->chunk)
+			file->chunk = wget_buffer_alloc(16384);
+
+		if ((n = COMPRESS_CHUNK_SIZE - file->chunk->length) > length)
+			n = length;
+
+		wget_buffer_memcat(file->chunk, data, n);
+		data = (const char *) data + n;
+		length -= n;
+
+		if (file->chunk->length >= COMPRESS_CHUNK_SIZE)
+			_compress_submit(file);
+	}
+}
+
+/*
+ * Flush the last chunk without waiting for it, the file descriptor is owned by 'file' from now on.
+ * When the last member has been written, the file gets 'mtime' (if not 0) as modification time
+ * and is closed. compress_exit() waits for all files to be complete.
+ */
+void compress_close(COMPRESSED_FILE **file, time_t mtime)
+{
+	COMPRESSED_FILE *f = *file;
+	bool finish;
+
+	f->mtime = mtime;
+
+	// an empty file still becomes a valid gzip file
+	if ((f->chunk && f->chunk->length) || !f->next_seq) {
+		if (!f->chunk)
+			f->chunk = wget_buffer_alloc(16);
+		_compress_submit(f);
+	} else
+		wget_buffer_free(&f->chunk);
+
+	wget_thread_mutex_lock(&mutex);
+	f->closing = 1;
+	finish = !f->pending;
+	wget_thread_mutex_unlock(&mutex);
+
+	if (finish)
+		_compress_finish(f);
+
+	*file = NULL;
+}
+
+#ifdef WITH_ZLIB
+/*
+ * Scan a file written by --compress-output: returns the number of uncompressed bytes
+ * in the complete gzip members and the end of the last complete member in '*complete'.
+ * Returns -1 if the file doesn't start with a gzip member (e.g. a plain file).
+ */
+static long long _compress_scan(int fd, off_t *complete)
+{
+	static const unsigned char gzip_magic[3] = { 0x1f, 0x8b, 0x08 };
+	z_stream z = { .next_in = NULL };
+	unsigned char in[16384], out[16384];
+	long long length = 0, member_length = 0;
+	off_t pos = 0; // bytes read
+	ssize_t nbytes;
+
+	*complete = 0;
+
+	if ((nbytes = read(fd, in, sizeof(in))) <= 0)
+		return nbytes == 0 ? 0 : -1; // an empty file has no data yet
+
+	if (memcmp(in, gzip_magic, nbytes < 3 ? (size_t) nbytes : 3))
+		return -1;
+
+	if (inflateInit2(&z, 15 + 16) != Z_OK)
+		return -1;
+
+	do {
+		z.next_in = in;
+		z.avail_in = (unsigned) nbytes;
+		pos += nbytes;
+
+		while (z.avail_in) {
+			int rc;
+
+			z.next_out = out;
+			z.avail_out = sizeof(out);
+
+			rc = inflate(&z, Z_NO_FLUSH);
+			member_length += sizeof(out) - z.avail_out;
+
+			if (rc == Z_STREAM_END) {
+				*complete = pos - z.avail_in;
+				length += member_length;
+				member_length = 0;
+				inflateReset(&z);
+			} else if (rc != Z_OK)
+				goto out; // a broken member, e.g. partly written
+		}
+	} while ((nbytes = read(fd, in, sizeof(in))) > 0);
+
+out:
+	inflateEnd(&z);
+
+	return length;
+}
+#endif
+
+/*
+ * Return the number of uncompressed bytes in the complete gzip members of a file
+ * written by --compress-output, -1 if there is no such file.
+ * The file is not modified, it is cut back by compress_resume() when the data arrives.
+ */
+long long compress_resume_offset(const char *fname)
+{
+#ifdef WITH_ZLIB
+	long long length;
+	off_t complete;
+	int fd;
+
+	if ((fd = open(fname, O_RDONLY)) == -1)
+		return -1;
+
+	length = _compress_scan(fd, &complete);
+	close(fd);
+
+	return length;
+#else
+	(void) fname;
+	return -1;
+#endif
+}
+
+/*
+ * Cut a file written by --compress-output back to its last complete gzip member and
+ * return the number of uncompressed bytes it contains.
+ * Returns -1 without touching the file if it doesn't start with a gzip member.
+ */
+long long compress_resume(const char *fname)
+{
+#ifdef WITH_ZLIB
+	long long length;
+	off_t complete;
+	int fd;
+
+	if ((fd = open(fname, O_RDWR)) == -1)
+		return -1;
+
+	if ((length = _compress_scan(fd, &complete)) >= 0 && lseek(fd, 0, SEEK_END) > complete) {
+		info_printf(_("Removing incomplete data from the end of %s\n"), fname);
+		if (ftruncate(fd, complete) == -1) {
+			error_printf(_("Failed to truncate %s (errno=%d)\n"), fname, errno);
+			length = -1;
+		}
+	}
+
+	close(fd);
+
+	return length;
+#else
+	(void) fname;
+	return -1;
+#endif
+}
+
+/*
+ * Read a file written by --compress-output and return its decompressed content, 0-terminated.
+ * An incomplete last member is decompressed as far as possible.
+ * Returns NULL if the file can't be read or doesn't start with a gzip member.
+ */
+char *compress_read_file(const char *fname, size_t *length)
+{
+#ifdef WITH_ZLIB
+	z_stream z = { .next_in = NULL };
+	wget_buffer_t buf;
+	char *data;
+	size_t size;
+	int rc;
+
+	if (!(data = wget_read_file(fname, &size)))
+		return NULL;
+
+	if (inflateInit2(&z, 15 + 16) != Z_OK) {
+		xfree(data);
+		return NULL;
+	}
+
+	wget_buffer_init(&buf, NULL, size * 4 + 1024);
+
+	z.next_in = (unsigned char *) data;
+	z.avail_in = (unsigned) size;
+
+	do {
+		if (buf.size - buf.length < 4096)
+			wget_buffer_ensure_capacity(&buf, buf.size * 2);
+
+		z.next_out = (unsigned char *) buf.data + buf.length;
+		z.avail_out = (unsigned) (buf.size - buf.length);
+
+		rc = inflate(&z, Z_NO_FLUSH);
+		buf.length = (char *) z.next_out - buf.data;
+
+		// the next member follows
+		if (rc == Z_STREAM_END && z.avail_in)
+			rc = inflateReset(&z);
+	} while (rc == Z_OK);
+
+	inflateEnd(&z);
+	xfree(data);
+
+	if (!buf.length && rc != Z_STREAM_END) {
+		wget_buffer_deinit(&buf);
+		return NULL;
+	}
+
+	buf.data[buf.length] = 0;
+	*length = buf.length;
+
+	return buf.data;
+#else
+	(void) fname;
+	(void) length;
+	return NULL;
+#endif
+}
+
+int compress_init(void)
+{
+#ifdef WITH_ZLIB
+	int rc;
+
+	if (wget_thread_support()) {
+		wget_thread_cond_init(&cond);
+
+		for (compress_nthreads = 0; compress_nthreads < COMPRESS_THREADS; compress_nthreads++) {
+			if ((rc = wget_thread_start(&compress_threads[compress_nthreads], _compress_thread, NULL, 0)) != 0) {
+				error_printf(_("Failed to start compression thread, error %d\n"), rc);
+				break;
+			}
+		}
+	}
+#else
+	info_printf(_("No zlib support, --compress-output is ignored\n"));
+	config.compress_output = 0;
+#endif
+
+	return 0;
+}
+
+void compress_exit(void)
+{
+	// let the threads finish the queue
+	wget_thread_mutex_lock(&mutex);
+	stop_threads = 1;
+	wget_thread_cond_signal(&cond);
+	wget_thread_mutex_unlock(&mutex);
+
+	for (int it = 0; it < compress_nthreads; it++)
+		wget_thread_join(compress_threads[it]);
+	compress_nthreads = 0;
+
+	if (total_in)
+		info_printf(_("Compressed output: %lld bytes written for %lld bytes of data\n"), total_out, total_in);
+}
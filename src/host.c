@@ -29,7 +29,10 @@
 # include <config.h>
 #endif
 
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <c-ctype.h>
 
 #include <wget.h>
 
@@ -37,13 +40,74 @@
 #include "wget_host.h"
 #include "wget_options.h"
 #include "wget_job.h"
+#include "wget_probes.h"
+
+// max. number of jobs in a row for a host via connection affinity, before other hosts get a chance
+#define HOST_AFFINITY_MAX 32
+
+// seconds a host is skipped by later runs after it has been blocked, doubled each time it is blocked again
+#define HOST_HEALTH_BACKOFF 60
+#define HOST_HEALTH_BACKOFF_MAX 86400
+// seconds after the last failure an entry of a host that hasn't been tried again is dropped
+#define HOST_HEALTH_EXPIRE (30 * 86400)
 
 static wget_hashmap_t
-	*hosts;
+	*hosts,
+	*health; // HOST_HEALTH entries, only with --host-health-file
 static wget_thread_mutex_t
 	hosts_mutex = WGET_THREAD_MUTEX_INITIALIZER;
 static int
-	qsize; // overall number of jobs
+	qsize, // overall number of jobs
+	health_changed;
+
+// names of the error classes in the host health file
+static const char *host_errors[] = {
+	[HOST_ERROR_NONE] = "-",
+	[HOST_ERROR_DNS] = "dns",
+	[HOST_ERROR_REFUSED] = "refused",
+	[HOST_ERROR_TIMEOUT] = "timeout",
+	[HOST_ERROR_TLS] = "tls",
+	[HOST_ERROR_CONNECTION] = "connection",
+};
+
+#ifdef WITH_THREAD_LOCAL
+static __thread unsigned int
+	_rnd_state;
+#endif
+
+// cheap xorshift PRNG, used for --random-wait
+static unsigned int _host_random(void)
+{
+#ifdef WITH_THREAD_LOCAL
+	unsigned int x = _rnd_state;
+
+	// seed once per thread, only this needs the lock within wget_random()
+	if (!x && !(x = (unsigned int) wget_random() ^ (unsigned int) wget_get_timemillis()))
+		x = 2463534242U;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	return _rnd_state = x;
+#else
+	return (unsigned int) wget_random();
+#endif
+}
+
+// delay between two requests to the same host: the larger one of --wait and Crawl-delay
+static long long _host_delay(HOST *host)
+{
+	long long delay = config.wait;
+
+	if (host->robots && host->robots->crawl_delay > delay)
+		delay = host->robots->crawl_delay;
+
+	if (delay && config.random_wait)
+		delay = _host_random() % delay + delay / 2; // (0.5 - 1.5) * delay
+
+	return delay;
+}
 
 static int _host_compare(const HOST *host1, const HOST *host2)
 {
@@ -84,6 +148,92 @@ static unsigned int _host_hash(const HOST *host)
 	return hash;
 }
 
+static int _health_compare(const HOST_HEALTH *h1, const HOST_HEALTH *h2)
+{
+	int n;
+
+	if ((n = wget_strcmp(h1->scheme, h2->scheme)))
+		return n;
+
+	if ((n = wget_strcmp(h1->host, h2->host)))
+		return n;
+
+	return wget_strcmp(h1->port, h2->port);
+}
+
+static unsigned int _health_hash(const HOST_HEALTH *h)
+{
+	unsigned int hash = 0;
+	const unsigned char *p;
+
+	for (p = (unsigned char *)h->scheme; p && *p; p++)
+		hash = hash * 101 + *p;
+
+	for (p = (unsigned char *)h->host; p && *p; p++)
+		hash = hash * 101 + *p;
+
+	for (p = (unsigned char *)h->port; p && *p; p++)
+		hash = hash * 101 + *p;
+
+	return hash;
+}
+
+static void _free_health_entry(HOST_HEALTH *h)
+{
+	if (h) {
+		xfree(h->scheme);
+		xfree(h->host);
+		xfree(h->port);
+		xfree(h);
+	}
+}
+
+static HOST_HEALTH *_health_add(const char *scheme, const char *hostname, const char *port)
+{
+	HOST_HEALTH *h = wget_calloc(1, sizeof(HOST_HEALTH));
+
+	h->scheme = wget_strdup(scheme);
+	h->host = wget_strdup(hostname);
+	h->port = wget_strdup(port);
+	wget_hashmap_put_noalloc(health, h, h);
+
+	return h;
+}
+
+// the health entry of 'host', created on its first failure
+static HOST_HEALTH *_host_health(HOST *host)
+{
+	if (!host->health)
+		host->health = _health_add(host->scheme, host->host, host->port);
+
+	return host->health;
+}
+
+// A host that has been blocked by a former run is skipped until its backoff time has passed.
+// After that, a single try shows whether it is back.
+static void _host_health_check(HOST *host)
+{
+	HOST_HEALTH *h, key = { .scheme = host->scheme, .host = host->host, .port = host->port };
+	long long now = time(NULL);
+
+	if (!(h = wget_hashmap_get(health, &key)))
+		return;
+
+	host->health = h;
+
+	if (!h->backoff)
+		return; // the host has not been blocked
+
+	if (now < h->last_failure + h->backoff) {
+		info_printf(_("Host %s:%s skipped for %lld more seconds (%d failures, last error: %s)\n"),
+			host->host, host->port, h->last_failure + h->backoff - now, h->failures, host_errors[h->error]);
+		host->blocked = 1; // there are no jobs yet to be removed from qsize
+	} else if (config.tries > 1) {
+		host->failures = config.tries - 1;
+		debug_printf("%s: one try for %s (%d failures)\n", __func__, host->host, h->failures);
+	}
+}
+
 static void _free_host_entry(HOST *host)
 {
 	if (host) {
@@ -108,6 +258,9 @@ HOST *host_add(wget_iri_t *iri)
 		// info_printf("Add to hosts: %s\n", hostname);
 		hostp = wget_memdup(&host, sizeof(host));
 		wget_hashmap_put_noalloc(hosts, hostp, hostp);
+
+		if (health)
+			_host_health_check(hostp);
 	}
 
 	wget_thread_mutex_unlock(&hosts_mutex);
@@ -165,16 +318,43 @@ static int _search_queue_for_free_job(struct _find_free_job_context *ctx, JOB *j
 	return 0;
 }
 
+static int _is_free_job(void *context G_GNUC_WGET_UNUSED, JOB *job)
+{
+	if (job->parts) {
+		for (int it = 0; it < wget_vector_size(job->parts); it++) {
+			PART *part = wget_vector_get(job->parts, it);
+
+			if (!part->inuse)
+				return 1;
+		}
+
+		return 0;
+	}
+
+	return !job->inuse;
+}
+
+// whether the host has a job to hand out, robots.txt comes first
+static int _host_has_free_job(HOST *host)
+{
+	if (host->robot_job)
+		return !host->robot_job->inuse;
+
+	return wget_list_browse(host->queue, (wget_list_browse_t)_is_free_job, NULL) > 0;
+}
+
 static int G_GNUC_WGET_NONNULL_ALL _search_host_for_free_job(struct _find_free_job_context *ctx, HOST *host)
 {
 	debug_printf("qsize=%d blocked=%d\n", host->qsize, host->blocked);
 	if (host->blocked)
 		return 0;
 
-	long long pause = host->retry_ts - ctx->now;
+	// wait for failure retries and for politeness delays
+	long long pause = (host->retry_ts > host->next_ts ? host->retry_ts : host->next_ts) - ctx->now;
 	debug_printf("pause=%lld\n", pause);
 	if (pause > 0) {
-		if (!ctx->pause || ctx->pause < pause)
+		// wake up when the first host with work to do becomes ready
+		if ((!ctx->pause || ctx->pause > pause) && _host_has_free_job(host))
 			ctx->pause = pause;
 		return 0;
 	}
@@ -193,10 +373,19 @@ static int G_GNUC_WGET_NONNULL_ALL _search_host_for_free_job(struct _find_free_j
 
 	wget_list_browse(host->queue, (wget_list_browse_t)_search_queue_for_free_job, ctx);
 
+	if (ctx->job && (config.wait || host->robots))
+		host->next_ts = ctx->now + _host_delay(host);
+
 	return !!ctx->job;
 }
 
-JOB *host_get_job(HOST *host, long long *pause)
+/*
+ * With 'host' given, get a job for this host only (e.g. to send more requests over the same connection).
+ * Else jobs for the host the caller is connected to via 'conn' come first, to avoid closing a warm
+ * connection just to open another one. After HOST_AFFINITY_MAX of these in a row, all hosts are searched
+ * once, so that downloaders connected to a busy host also help out with the others.
+ */
+JOB *host_get_job(HOST *host, const wget_http_connection_t *conn, long long *pause)
 {
 	struct _find_free_job_context ctx = { .now = wget_get_timemillis() };
 
@@ -204,13 +393,31 @@ JOB *host_get_job(HOST *host, long long *pause)
 		_search_host_for_free_job(&ctx, host);
 	} else {
 		wget_thread_mutex_lock(&hosts_mutex);
-		wget_hashmap_browse(hosts, (wget_hashmap_browse_t)_search_host_for_free_job, &ctx);
+
+		if (conn && hosts) {
+			HOST *connected, key = { .scheme = conn->scheme, .host = conn->esc_host, .port = conn->port };
+
+			if ((connected = wget_hashmap_get(hosts, &key))) {
+				if (connected->affine_jobs < HOST_AFFINITY_MAX) {
+					if (_search_host_for_free_job(&ctx, connected))
+						connected->affine_jobs++;
+				} else
+					connected->affine_jobs = 0;
+			}
+		}
+
+		if (!ctx.job)
+			wget_hashmap_browse(hosts, (wget_hashmap_browse_t)_search_host_for_free_job, &ctx);
+
 		wget_thread_mutex_unlock(&hosts_mutex);
 	}
 
 	if (pause)
 		*pause = ctx.pause;
 
+	if (ctx.job)
+		WGET_PROBE2(job_dequeue, ctx.job->iri ? ctx.job->iri->uri : NULL, ctx.job->level);
+
 	return ctx.job;
 }
 
@@ -268,6 +475,7 @@ JOB *host_add_job(HOST *host, JOB *job)
 
 	wget_thread_mutex_lock(&hosts_mutex);
 	jobp = wget_list_append(&host->queue, job, sizeof(JOB));
+	memstats_alloc(WGET_MEMTAG_FRONTIER, sizeof(JOB));
 	host->qsize++;
 	if (!host->blocked)
 		qsize++;
@@ -294,6 +502,7 @@ JOB *host_add_robotstxt_job(HOST *host, wget_iri_t *iri, const char *encoding)
 
 	wget_thread_mutex_lock(&hosts_mutex);
 	host->robot_job = job;
+	memstats_alloc(WGET_MEMTAG_FRONTIER, sizeof(JOB));
 	host->qsize++;
 	if (!host->blocked)
 		qsize++;
@@ -355,6 +564,7 @@ void host_remove_job(HOST *host, JOB *job)
 		wget_list_remove(&host->queue, job);
 	}
 
+	memstats_free(WGET_MEMTAG_FRONTIER, sizeof(JOB));
 	host->qsize--;
 	if (!host->blocked)
 		qsize--;
@@ -367,14 +577,24 @@ void hosts_free(void)
 {
 	// We don't need mutex locking here - this function is called on exit when all threads have ceased.
 	wget_hashmap_free(&hosts);
+	wget_hashmap_free(&health);
 }
 
-void host_increase_failure(HOST *host)
+void host_increase_failure(HOST *host, enum host_error error)
 {
 	wget_thread_mutex_lock(&hosts_mutex);
 	host->failures++;
 	host->retry_ts = wget_get_timemillis() + host->failures * 1000;
-	debug_printf("%s: %s failures=%d\n", __func__, host->host, host->failures);
+	debug_printf("%s: %s failures=%d error=%s\n", __func__, host->host, host->failures, host_errors[error]);
+
+	if (health) {
+		HOST_HEALTH *h = _host_health(host);
+
+		h->failures++;
+		h->error = error;
+		h->last_failure = time(NULL);
+		health_changed = 1;
+	}
 
 	if (config.tries && host->failures >= config.tries) {
 		if (!host->blocked) {
@@ -397,11 +617,30 @@ void host_final_failure(HOST *host)
 	wget_thread_mutex_unlock(&hosts_mutex);
 }
 
+// the server refused to serve 'host' over a connection to another host name (421 Misdirected Request)
+void host_set_misdirected(HOST *host)
+{
+	wget_thread_mutex_lock(&hosts_mutex);
+	host->misdirected = 1;
+	wget_thread_mutex_unlock(&hosts_mutex);
+}
+
 void host_reset_failure(HOST *host)
 {
 	wget_thread_mutex_lock(&hosts_mutex);
 	host->failures = 0;
 	host->retry_ts = 0;
+
+	// only hosts that failed have an entry, a response clears it (it is dropped on save)
+	if (host->health && (host->health->failures || host->health->backoff)) {
+		HOST_HEALTH *h = host->health;
+
+		h->failures = 0;
+		h->error = HOST_ERROR_NONE;
+		h->backoff = 0;
+		health_changed = 1;
+	}
+
 	if (host->blocked) {
 		host->blocked = 0;
 		qsize += host->qsize;
@@ -410,6 +649,135 @@ void host_reset_failure(HOST *host)
 	wget_thread_mutex_unlock(&hosts_mutex);
 }
 
+static int _host_health_load(void *context G_GNUC_WGET_UNUSED, FILE *fp)
+{
+	HOST_HEALTH h, *old;
+	char *buf = NULL, *linep, scheme[16], hostname[256], port[16], error[16];
+	size_t bufsize = 0;
+
+	while (wget_getline(&buf, &bufsize, fp) >= 0) {
+		for (linep = buf; c_isspace(*linep); linep++); // ignore leading whitespace
+		if (!*linep || *linep == '#')
+			continue; // skip empty lines and comments
+
+		memset(&h, 0, sizeof(h));
+
+		if (sscanf(linep, "%15s %255s %15s %d %15s %lld %lld", scheme, hostname, port,
+			&h.failures, error, &h.last_failure, &h.backoff) != 7)
+		{
+			error_printf(_("Failed to parse host health line: '%s'\n"), linep);
+			continue;
+		}
+
+		h.error = HOST_ERROR_CONNECTION;
+		for (unsigned it = 0; it < countof(host_errors); it++) {
+			if (!strcmp(error, host_errors[it]))
+				h.error = (enum host_error) it;
+		}
+
+		h.scheme = scheme;
+		h.host = hostname;
+		h.port = port;
+
+		if (!(old = wget_hashmap_get(health, &h)))
+			old = _health_add(scheme, hostname, port);
+		else if (h.last_failure <= old->last_failure)
+			continue; // what we know is up-to-date, the file may also have been updated by another run
+
+		old->failures = h.failures;
+		old->error = h.error;
+		old->last_failure = h.last_failure;
+		old->backoff = h.backoff;
+	}
+
+	xfree(buf);
+
+	return ferror(fp) ? -1 : 0;
+}
+
+// Load the health of hosts from former runs, this also enables collecting it
+int host_health_load(const char *fname)
+{
+	if (!health) {
+		health = wget_hashmap_create(16, -2, (wget_hashmap_hash_t)_health_hash, (wget_hashmap_compare_t)_health_compare);
+		wget_hashmap_set_key_destructor(health, (wget_hashmap_key_destructor_t)_free_health_entry);
+	}
+
+	if (wget_update_file(fname, _host_health_load, NULL, NULL)) {
+		error_printf(_("Failed to read host health data from '%s'\n"), fname);
+		return -1;
+	}
+
+	health_changed = 0;
+	debug_printf("Fetched host health data from '%s'\n", fname);
+
+	return 0;
+}
+
+// hosts that failed until they were blocked are skipped by later runs for an exponentially growing time
+static int _host_raise_backoff(void *context G_GNUC_WGET_UNUSED, HOST *host)
+{
+	HOST_HEALTH *h = host->health;
+
+	if (host->blocked && host->failures && h && h->failures) {
+		h->backoff = h->backoff ? h->backoff * 2 : HOST_HEALTH_BACKOFF;
+		if (h->backoff > HOST_HEALTH_BACKOFF_MAX)
+			h->backoff = HOST_HEALTH_BACKOFF_MAX;
+		health_changed = 1;
+		debug_printf("%s: %s skipped by later runs for %lld seconds\n", __func__, host->host, h->backoff);
+	}
+
+	return 0;
+}
+
+static int _host_health_save_entry(FILE *fp, const HOST_HEALTH *h)
+{
+	// healthy hosts are not kept, neither are hosts that haven't been tried for a long time
+	if ((!h->failures && !h->backoff) || h->last_failure + h->backoff + HOST_HEALTH_EXPIRE < time(NULL))
+		return 0;
+
+	if (h->scheme && h->host && h->port) {
+		fprintf(fp, "%s %s %s %d %s %lld %lld\n", h->scheme, h->host, h->port,
+			h->failures, host_errors[h->error], h->last_failure, h->backoff);
+	}
+
+	return 0;
+}
+
+static int _host_health_save(void *context G_GNUC_WGET_UNUSED, FILE *fp)
+{
+	fputs("#Host health 1.0 file\n", fp);
+	fputs("#Generated by Wget2 " PACKAGE_VERSION ". Edit at your own risk.\n", fp);
+	fputs("# <scheme> <host> <port> <failures> <last error> <last failure> <backoff>\n", fp);
+
+	wget_hashmap_browse(health, (wget_hashmap_browse_t)_host_health_save_entry, fp);
+
+	return ferror(fp) ? -1 : 0;
+}
+
+// Save the health of the hosts of this run, merged with the entries of the file
+// Called on exit when all threads have ceased
+int host_health_save(const char *fname)
+{
+	if (!health)
+		return 0;
+
+	if (hosts)
+		wget_hashmap_browse(hosts, (wget_hashmap_browse_t)_host_raise_backoff, NULL);
+
+	if (!health_changed)
+		return 0;
+
+	if (wget_update_file(fname, _host_health_load, _host_health_save, NULL)) {
+		error_printf(_("Failed to write host health file '%s'\n"), fname);
+		return -1;
+	}
+
+	debug_printf("Saved %d host health entries into '%s'\n", wget_hashmap_size(health), fname);
+
+	return 0;
+}
+
 struct find_free_job_context {
 	JOB **job;
 	wget_http_connection_t *conn;
@@ -426,6 +794,7 @@ int queue_empty(void)
 static int _queue_free_func(void *context G_GNUC_WGET_UNUSED, JOB *job)
 {
 	job_free(job);
+	memstats_free(WGET_MEMTAG_FRONTIER, sizeof(JOB));
 	return 0;
 }
 
@@ -438,6 +807,7 @@ void host_queue_free(HOST *host)
 		wget_iri_free(&host->robot_job->iri);
 		job_free(host->robot_job);
 		xfree(host->robot_job);
+		memstats_free(WGET_MEMTAG_FRONTIER, sizeof(JOB));
 	}
 	if (!host->blocked)
 		qsize -= host->qsize;
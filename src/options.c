@@ -202,7 +202,10 @@ static int G_GNUC_WGET_NORETURN print_help(G_GNUC_WGET_UNUSED option_t opt, G_GN
 		"  -r  --recursive         Recursive download. (default: off)\n"
 		"  -H  --span-hosts        Span hosts that were not given on the command line. (default: off)\n"
 		"      --max-threads       Max. concurrent download threads. (default: 5) (NEW!)\n"
+		"      --min-threads       Min. concurrent download threads, the number adapts to the load. (default: 0 = off) (NEW!)\n"
 		"      --max-redirect      Max. number of redirections to follow. (default: 20)\n"
+		"      --redirect-cache    Follow known permanent redirects (301, 308) without asking the server. (default: off)\n"
+		"      --redirect-cache-file  Set file for the permanent redirect cache. (default: ~/.wget-redirects)\n"
 		"  -T  --timeout           General network timeout in seconds.\n"
 		"      --dns-timeout       DNS lookup timeout in seconds.\n"
 		"      --connect-timeout   Connect timeout in seconds.\n"
@@ -224,8 +227,11 @@ static int G_GNUC_WGET_NORETURN print_help(G_GNUC_WGET_UNUSED option_t opt, G_GN
 		"  -6  --inet6-only        Use IPv6 connections only. (default: off)\n"
 		"      --prefer-family     Prefer IPv4 or IPv6. (default: none)\n"
 		"      --cache             Enabled using of server cache. (default: on)\n"
+		"      --cache-dir         Directory for a persistent HTTP cache, shared across runs. (default: off)\n"
 		"      --clobber           Enable file clobbering. (default: on)\n"
 		"      --bind-address      Bind to sockets to local address. (default: automatic)\n"
+		"                          Use comma to separate addresses, the least used is taken.\n"
+		"      --bind-address-no-port  Allocate local port at connect time. (default: off)\n"
 		"  -D  --domains           Comma-separated list of domains to follow.\n"
 		"      --exclude-domains   Comma-separated list of domains NOT to follow.\n"
 		"      --user              Username for Authentication. (default: empty username)\n"
@@ -241,16 +247,23 @@ static int G_GNUC_WGET_NORETURN print_help(G_GNUC_WGET_UNUSED option_t opt, G_GN
 		"      --local-encoding    Character encoding of environment and filenames.\n"
 		"      --remote-encoding   Character encoding of remote files (if not specified in Content-Type HTTP header or in document itself)\n"
 		"  -t  --tries             Number of tries for each download. (default 20)\n"
+		"      --host-health-file  Skip hosts that failed in former runs, keeping track of them in this file. (default: off)\n"
 		"  -A  --accept            Comma-separated list of file name suffixes or patterns.\n"
 		"  -R  --reject            Comma-separated list of file name suffixes or patterns.\n"
 		"      --ignore-case       Ignore case when matching files. (default: off)\n"
 		"  -k  --convert-links     Convert embedded URLs to local URLs. (default: off)\n"
 		"  -K  --backup-converted  When converting, keep the original file with a .orig suffix. (default: off)\n"
-		"  -w  --wait              Wait number of seconds between downloads (per thread). (default: 0)\n"
+		"  -w  --wait              Wait number of seconds between downloads (per host). (default: 0)\n"
 		"      --waitretry         Wait up to number of seconds after error (per thread). (default: 10)\n"
-		"      --random-wait       Wait 0.5 up to 1.5*<--wait> seconds between downloads (per thread). (default: off)\n"
+		"      --random-wait       Wait 0.5 up to 1.5*<--wait> seconds between downloads (per host). (default: off)\n"
 		"      --dns-caching       Caching of domain name lookups. (default: on)\n"
 		"      --tcp-fastopen      Enable TCP Fast Open (TFO). (default: on)\n"
+		"      --tcp-receive-buffer  Socket receive buffer size (SO_RCVBUF). (default: system)\n"
+		"      --tcp-send-buffer   Socket send buffer size (SO_SNDBUF). (default: system)\n"
+		"      --tcp-congestion    TCP congestion control algorithm, e.g. bbr or cubic. (default: system)\n"
+		"      --tcp-notsent-lowat Limit of unsent bytes in the socket (TCP_NOTSENT_LOWAT). (default: system)\n"
+		"      --tcp-quickack      Disable delayed ACKs (TCP_QUICKACK). (default: off)\n"
+		"      --tcp-busy-poll     Busy poll microseconds on socket reads (SO_BUSY_POLL). (default: 0)\n"
 		"      --iri               Wget dummy option, you can't switch off international support\n"
 		"      --robots            Respect robots.txt standard for recursive downloads. (default: on)\n"
 		"      --restrict-file-names  unix, windows, nocontrol, ascii, lowercase, uppercase, none\n"
@@ -262,6 +275,9 @@ static int G_GNUC_WGET_NORETURN print_help(G_GNUC_WGET_UNUSED option_t opt, G_GN
 		"      --post-file         File with data to be sent in a POST request.\n"
 		"      --netrc             Load credentials from ~/.netrc if not given. (default: on)\n"
 		"      --content-on-error  Save response body even on error status. (default: off)\n"
+		"      --decompress        Decompress Content-Encoded bodies. With --no-decompress, bodies that are not\n"
+		"                          parsed are saved as received with a matching suffix (.gz, .br, ...). (default: on)\n"
+		"      --compress-output   Gzip files while saving them, '.gz' is appended to the file names. (default: off)\n"
 		"      --cut-url-get-vars  Cut HTTP GET vars from URLs. (default: off)\n"
 		"      --cut-file-get-vars Cut HTTP GET vars from file names. (default: off)\n"
 		"\n");
@@ -289,6 +305,9 @@ static int G_GNUC_WGET_NORETURN print_help(G_GNUC_WGET_UNUSED option_t opt, G_GN
 		"      --default-page      Default file name if name isn't known. (default: index.html)\n"
 		"      --netrc-file        Set file for login/password to use instead of ~/.netrc. (default: ~/.netrc)\n"
 		"      --metalink          Follow a metalink file instead of storing it (default: on)\n"
+		"      --warc-file         Save requests and responses into <file>.warc.gz (WARC/1.0).\n"
+		"      --warc-max-size     Start a new WARC file when reaching this size, 0 = no limit. (default: 0)\n"
+		"      --warc-compression  Compress each WARC record with gzip. (default: on)\n"
 		"\n");
 	puts(
 		"HTTPS (SSL/TLS) related options:\n"
@@ -315,6 +334,8 @@ static int G_GNUC_WGET_NORETURN print_help(G_GNUC_WGET_UNUSED option_t opt, G_GN
 		"      --ocsp              Use OCSP server access to verify server's certificate. (default: on)\n"
 		"      --ocsp-file         Set file for OCSP chaching. (default: ~/.wget-ocsp)\n"
 		"      --http2             Use HTTP/2 protocol if possible. (default: on)\n"
+		"      --http2-prior-knowledge  Use HTTP/2 without TLS for these hosts, \"*\" for all. (default: none)\n"
+		"      --http2-request-window  Max. number of parallel requests per HTTP/2 connection. (default: 30)\n"
 		"      --tls-false-start   Enable TLS False Start (needs GnuTLS 3.5+). (default: on)\n"
 		"      --tls-resume        Enable TLS Session Resumption. (default: on)\n"
 		"      --tls-session-file  Set file for TLS Session caching. (default: ~/.wget-session)\n"
@@ -788,6 +809,7 @@ struct config config = {
 	.directories = 1,
 	.host_directories = 1,
 	.cache = 1,
+	.decompress = 1,
 	.clobber = 1,
 	.default_page = "index.html",
 	.level = 5,
@@ -805,6 +827,7 @@ struct config config = {
 	.ocsp_stapling = 1,
 	.netrc = 1,
 	.waitretry = 10 * 1000,
+	.warc_compression = 1,
 	.metalink = 1,
 	.tls_false_start = 1,
 	.tls_resume = 1
@@ -822,15 +845,18 @@ static const struct optionw options[] = {
 	{ "backups", &config.backups, parse_integer, 1, 0 },
 	{ "base", &config.base_url, parse_string, 1, 'B' },
 	{ "bind-address", &config.bind_address, parse_string, 1, 0 },
+	{ "bind-address-no-port", &config.bind_address_no_port, parse_bool, 0, 0 },
 	{ "ca-certificate", &config.ca_cert, parse_string, 1, 0 },
 	{ "ca-directory", &config.ca_directory, parse_string, 1, 0 },
 	{ "cache", &config.cache, parse_bool, 0, 0 },
+	{ "cache-dir", &config.cache_dir, parse_filename, 1, 0 },
 	{ "certificate", &config.cert_file, parse_string, 1, 0 },
 	{ "certificate-type", &config.cert_type, parse_cert_type, 1, 0 },
 	{ "check-certificate", &config.check_certificate, parse_bool, 0, 0 },
 	{ "check-hostname", &config.check_hostname, parse_bool, 0, 0 },
 	{ "chunk-size", &config.chunk_size, parse_numbytes, 1, 0 },
 	{ "clobber", &config.clobber, parse_bool, 0, 0 },
+	{ "compress-output", &config.compress_output, parse_bool, 0, 0 },
 	{ "config", &config.config_files, parse_filenames, 1, 0}, // for backward compatibility only
 	{ "config-file", &config.config_files, parse_filenames, 1, 0},
 	{ "connect-timeout", &config.connect_timeout, parse_timeout, 1, 0 },
@@ -845,6 +871,7 @@ static const struct optionw options[] = {
 	{ "cut-file-get-vars", &config.cut_file_get_vars, parse_bool, 0, 0 },
 	{ "cut-url-get-vars", &config.cut_url_get_vars, parse_bool, 0, 0 },
 	{ "debug", &config.debug, parse_bool, 0, 'd' },
+	{ "decompress", &config.decompress, parse_bool, 0, 0 },
 	{ "default-page", &config.default_page, parse_string, 1, 0 },
 	{ "delete-after", &config.delete_after, parse_bool, 0, 0 },
 	{ "directories", &config.directories, parse_bool, 0, 0 },
@@ -868,6 +895,7 @@ static const struct optionw options[] = {
 	{ "header", &config.headers, parse_header, 1, 0 },
 	{ "help", NULL, print_help, 0, 'h' },
 	{ "host-directories", &config.host_directories, parse_bool, 0, 0 },
+	{ "host-health-file", &config.host_health_file, parse_filename, 1, 0 },
 	{ "hpkp", &config.hpkp, parse_bool, 0, 0 },
 	{ "hpkp-file", &config.hpkp_file, parse_filename, 1, 0 },
 	{ "hsts", &config.hsts, parse_bool, 0, 0 },
@@ -878,6 +906,8 @@ static const struct optionw options[] = {
 	{ "http-proxy", &config.http_proxy, parse_string, 1, 0 },
 	{ "http-user", &config.http_username, parse_string, 1, 0 },
 	{ "http2", &config.http2, parse_bool, 0, 0 },
+	{ "http2-prior-knowledge", &config.http2_prior_knowledge, parse_string, 1, 0 },
+	{ "http2-request-window", &config.http2_request_window, parse_integer, 1, 0 },
 	{ "https-only", &config.https_only, parse_bool, 0, 0 },
 	{ "https-proxy", &config.https_proxy, parse_string, 1, 0 },
 	{ "ignore-case", &config.ignore_case, parse_bool, 0, 0 },
@@ -894,6 +924,7 @@ static const struct optionw options[] = {
 	{ "max-redirect", &config.max_redirect, parse_integer, 1, 0 },
 	{ "max-threads", &config.max_threads, parse_integer, 1, 0 },
 	{ "metalink", &config.metalink, parse_bool, 0, 0 },
+	{ "min-threads", &config.min_threads, parse_integer, 1, 0 },
 	{ "mirror", &config.mirror, parse_mirror, 0, 'm' },
 	{ "n", NULL, parse_n_option, 1, 'n' }, // special Wget compatibility option
 	{ "netrc", &config.netrc, parse_bool, 0, 0 },
@@ -919,6 +950,8 @@ static const struct optionw options[] = {
 	{ "random-wait", &config.random_wait, parse_bool, 0, 0 },
 	{ "read-timeout", &config.read_timeout, parse_timeout, 1, 0 },
 	{ "recursive", &config.recursive, parse_bool, 0, 'r' },
+	{ "redirect-cache", &config.redirect_cache, parse_bool, 0, 0 },
+	{ "redirect-cache-file", &config.redirect_cache_file, parse_filename, 1, 0 },
 	{ "referer", &config.referer, parse_string, 1, 0 },
 	{ "reject", &config.reject_patterns, parse_stringlist, 1, 'R' },
 	{ "remote-encoding", &config.remote_encoding, parse_string, 1, 0 },
@@ -931,7 +964,13 @@ static const struct optionw options[] = {
 	{ "span-hosts", &config.span_hosts, parse_bool, 0, 'H' },
 	{ "spider", &config.spider, parse_bool, 0, 0 },
 	{ "strict-comments", &config.strict_comments, parse_bool, 0, 0 },
+	{ "tcp-busy-poll", &config.tcp_busy_poll, parse_integer, 1, 0 },
+	{ "tcp-congestion", &config.tcp_congestion, parse_string, 1, 0 },
 	{ "tcp-fastopen", &config.tcp_fastopen, parse_bool, 0, 0 },
+	{ "tcp-notsent-lowat", &config.tcp_notsent_lowat, parse_numbytes, 1, 0 },
+	{ "tcp-quickack", &config.tcp_quickack, parse_bool, 0, 0 },
+	{ "tcp-receive-buffer", &config.tcp_receive_buffer, parse_numbytes, 1, 0 },
+	{ "tcp-send-buffer", &config.tcp_send_buffer, parse_numbytes, 1, 0 },
 	{ "timeout", NULL, parse_timeout, 1, 'T' },
 	{ "timestamping", &config.timestamping, parse_bool, 0, 'N' },
 	{ "tls-false-start", &config.tls_false_start, parse_bool, 0, 0 },
@@ -944,9 +983,11 @@ static const struct optionw options[] = {
 	{ "user-agent", &config.user_agent, parse_string, 1, 'U' },
 	{ "verbose", &config.verbose, parse_bool, 0, 'v' },
 	{ "version", NULL, print_version, 0, 'V' },
-	{ "help", NULL, print_help, 0, 'h' },
 	{ "wait", &config.wait, parse_timeout, 1, 'w' },
-	{ "waitretry", &config.waitretry, parse_timeout, 1, 0 }
+	{ "waitretry", &config.waitretry, parse_timeout, 1, 0 },
+	{ "warc-compression", &config.warc_compression, parse_bool, 0, 0 },
+	{ "warc-file", &config.warc_file, parse_string, 1, 0 },
+	{ "warc-max-size", &config.warc_max_size, parse_numbytes, 1, 0 }
 };
 
 static int G_GNUC_WGET_PURE G_GNUC_WGET_NONNULL_ALL opt_compare(const void *key, const void *option)
@@ -1404,6 +1445,9 @@ int init(int argc, const char **argv)
 	if (!config.hpkp_file)
 		config.hpkp_file = wget_aprintf("%s/.wget-hpkp", home_dir);
 
+	if (!config.redirect_cache_file)
+		config.redirect_cache_file = wget_aprintf("%s/.wget-redirects", home_dir);
+
 	if (config.tls_resume && !config.tls_session_file)
 		config.tls_session_file = wget_aprintf("%s/.wget-session", home_dir);
 
@@ -1439,6 +1483,11 @@ int init(int argc, const char **argv)
 	if (config.max_threads < 1)
 		config.max_threads = 1;
 
+	if (config.min_threads < 0)
+		config.min_threads = 0;
+	else if (config.min_threads > config.max_threads)
+		config.min_threads = config.max_threads;
+
 	// truncate output document
 	if (config.output_document && strcmp(config.output_document,"-")) {
 		int fd = open(config.output_document, O_WRONLY | O_TRUNC);
@@ -1467,9 +1516,14 @@ int init(int argc, const char **argv)
 		error_printf(_("Failed to set proxy exceptions %s\n"), config.no_proxy);
 		return -1;
 	}
+	if (config.http2 && config.http2_prior_knowledge && wget_http_set_http2_prior_knowledge(config.http2_prior_knowledge, config.local_encoding) < 0) {
+		error_printf(_("Failed to set HTTP/2 prior knowledge hosts %s\n"), config.http2_prior_knowledge);
+		return -1;
+	}
 	xfree(config.http_proxy);
 	xfree(config.https_proxy);
 	xfree(config.no_proxy);
+	xfree(config.http2_prior_knowledge);
 
 	if (config.cookies) {
 		config.cookie_db = wget_cookie_db_init(NULL);
@@ -1490,6 +1544,11 @@ int init(int argc, const char **argv)
 		wget_hpkp_db_load(config.hpkp_db, config.hpkp_file);
 	}
 
+	if (config.redirect_cache) {
+		config.redirect_db = wget_redirect_db_init(NULL);
+		wget_redirect_db_load(config.redirect_db, config.redirect_cache_file);
+	}
+
 	if (config.tls_resume) {
 		config.tls_session_db = wget_tls_session_db_init(NULL);
 		wget_tls_session_db_load(config.tls_session_db, config.tls_session_file);
@@ -1517,6 +1576,11 @@ int init(int argc, const char **argv)
 	if (config.mirror)
 		config.metalink = 0;
 
+	if (config.compress_output && config.convert_links) {
+		error_printf(_("--compress-output can't be combined with --convert-links\n"));
+		return -1;
+	}
+
 	if ((rc = wget_net_init()))
 		wget_error_printf_exit(_("Failed to init networking (%d)"), rc);
 
@@ -1526,8 +1590,15 @@ int init(int argc, const char **argv)
 	wget_tcp_set_dns_timeout(NULL, config.dns_timeout);
 	wget_tcp_set_dns_caching(NULL, config.dns_caching);
 	wget_tcp_set_tcp_fastopen(NULL, config.tcp_fastopen);
+	wget_tcp_set_receive_buffer_size(NULL, (int) config.tcp_receive_buffer);
+	wget_tcp_set_send_buffer_size(NULL, (int) config.tcp_send_buffer);
+	wget_tcp_set_notsent_lowat(NULL, (int) config.tcp_notsent_lowat);
+	wget_tcp_set_busy_poll(NULL, config.tcp_busy_poll);
+	wget_tcp_set_quickack(NULL, config.tcp_quickack);
+	wget_tcp_set_congestion_control(NULL, config.tcp_congestion);
 	wget_tcp_set_tls_false_start(NULL, config.tls_false_start);
 	wget_tcp_set_bind_address(NULL, config.bind_address);
+	wget_tcp_set_bind_address_no_port(NULL, config.bind_address_no_port);
 	if (config.inet4_only)
 		wget_tcp_set_family(NULL, WGET_NET_FAMILY_IPV4);
 	else if (config.inet6_only)
@@ -1602,10 +1673,12 @@ void deinit(void)
 {
 	wget_dns_cache_free(); // frees DNS cache
 	wget_tcp_set_bind_address(NULL, NULL); // free global bind address
+	wget_tcp_set_congestion_control(NULL, NULL); // free global congestion control name
 
 	wget_cookie_db_free(&config.cookie_db);
 	wget_hsts_db_free(&config.hsts_db);
 	wget_hpkp_db_free(&config.hpkp_db);
+	wget_redirect_db_free(&config.redirect_db);
 	wget_tls_session_db_free(&config.tls_session_db);
 	wget_ocsp_db_free(&config.ocsp_db);
 	wget_netrc_db_free(&config.netrc_db);
@@ -1616,6 +1689,8 @@ void deinit(void)
 	xfree(config.save_cookies);
 	xfree(config.hsts_file);
 	xfree(config.hpkp_file);
+	xfree(config.redirect_cache_file);
+	xfree(config.host_health_file);
 	xfree(config.tls_session_file);
 	xfree(config.ocsp_file);
 	xfree(config.netrc_file);
@@ -1643,6 +1718,9 @@ void deinit(void)
 	xfree(config.http_password);
 	xfree(config.post_data);
 	xfree(config.post_file);
+	xfree(config.tcp_congestion);
+	xfree(config.warc_file);
+	xfree(config.cache_dir);
 
 	wget_iri_free(&config.base);
 
@@ -1658,6 +1736,7 @@ void deinit(void)
 	wget_http_set_http_proxy(NULL, NULL);
 	wget_http_set_https_proxy(NULL, NULL);
 	wget_http_set_no_proxy(NULL, NULL);
+	wget_http_set_http2_prior_knowledge(NULL, NULL);
 }
 
 // self test some functions, called by using --self-test
@@ -0,0 +1,653 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * WARC output routines (ISO 28500, WARC/1.0)
+ *
+ * Records are collected while downloading, the block digest is computed on the way.
+ * Complete records are handed over to a small pool of threads that compress each
+ * record into its own gzip member and append it to the current WARC file.
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "safe-write.h"
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include <wget.h>
+
+#include "wget_main.h"
+#include "wget_options.h"
+#include "wget_warc.h"
+
+#define WARC_MAX_MEMORY (1024 * 1024) // larger records are kept in a temporary file
+#define WARC_THREADS 2 // number of compression threads
+
+struct WARC_RECORD {
+	const char
+		*type;
+	char
+		*uri;
+	wget_buffer_t
+		*block; // HTTP message while it fits into memory
+	FILE
+		*spill; // HTTP message beyond WARC_MAX_MEMORY
+	wget_hash_hd_t
+		*digest; // SHA1 of the block, updated with each append
+	size_t
+		length;
+	char
+		id[48],
+		concurrent_to[48],
+		date[24];
+};
+
+// output for a serialized record: memory, temporary file or the WARC file itself
+typedef struct {
+	wget_buffer_t
+		*buf;
+	FILE
+		*fp;
+	int
+		fd;
+	size_t
+		length;
+#ifdef WITH_ZLIB
+	z_stream
+		z;
+#endif
+	unsigned char
+		compress : 1,
+		error : 1;
+} _warc_sink_t;
+
+static wget_thread_mutex_t
+	queue_mutex = WGET_THREAD_MUTEX_INITIALIZER,
+	file_mutex = WGET_THREAD_MUTEX_INITIALIZER;
+static wget_thread_cond_t
+	queue_cond;
+static wget_list_t
+	*queue;
+static wget_thread_t
+	warc_threads[WARC_THREADS];
+static int
+	warc_nthreads,
+	stop_threads,
+	warc_fd = -1,
+	warc_serial;
+static long long
+	warc_size;
+static char
+	*warc_filename;
+
+static void _warc_uuid(char *buf, size_t size)
+{
+	unsigned char r[16];
+
+	for (int it = 0; it < 16; it += 2) {
+		int x = wget_random();
+
+		r[it] = (unsigned char) x;
+		r[it + 1] = (unsigned char) (x >> 8);
+	}
+
+	// version 4 (random), variant RFC 4122
+	r[6] = (r[6] & 0x0F) | 0x40;
+	r[8] = (r[8] & 0x3F) | 0x80;
+
+	snprintf(buf, size, "<urn:uuid:%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x>",
+		r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8], r[9], r[10], r[11], r[12], r[13], r[14], r[15]);
+}
+
+// RFC 4648 base32, as used for WARC digests
+static void _warc_base32(const unsigned char *src, size_t n, char *dst)
+{
+	static const char alphabet[32] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+	unsigned int value = 0, bits = 0;
+
+	for (size_t it = 0; it < n; it++) {
+		value = ((value << 8) | src[it]) & 0xFFFF;
+		for (bits += 8; bits >= 5; bits -= 5)
+			*dst++ = alphabet[(value >> (bits - 5)) & 31];
+	}
+
+	if (bits)
+		*dst++ = alphabet[(value << (5 - bits)) & 31];
+
+	*dst = 0;
+}
+
+WARC_RECORD *warc_record_create(const char *type, const char *uri, const char *concurrent_to)
+{
+	WARC_RECORD *record = wget_calloc(1, sizeof(WARC_RECORD));
+	struct tm tm;
+	time_t now = time(NULL);
+
+	record->type = type;
+	record->uri = wget_strdup(uri);
+	record->block = wget_buffer_alloc(1024);
+
+	if (wget_hash_init((record->digest = wget_hash_alloc()), WGET_DIGTYPE_SHA1))
+		wget_hash_free(&record->digest);
+
+	_warc_uuid(record->id, sizeof(record->id));
+	if (concurrent_to)
+		snprintf(record->concurrent_to, sizeof(record->concurrent_to), "%s", concurrent_to);
+
+	if (gmtime_r(&now, &tm))
+		strftime(record->date, sizeof(record->date), "%Y-%m-%dT%H:%M:%SZ", &tm);
+
+	return record;
+}
+
+const char *warc_record_get_id(const WARC_RECORD *record)
+{
+	return record->id;
+}
+
+void warc_record_free(WARC_RECORD **record)
+{
+	if (record && *record) {
+		if ((*record)->digest) {
+			unsigned char digest[20];
+
+			wget_hash_deinit((*record)->digest, digest);
+			wget_hash_free(&(*record)->digest);
+		}
+		wget_buffer_free(&(*record)->block);
+		if ((*record)->spill)
+			fclose((*record)->spill);
+		xfree((*record)->uri);
+		xfree(*record);
+	}
+}
+
+void warc_record_append(WARC_RECORD *record, const void *data, size_t length)
+{
+	if (!length)
+		return;
+
+	if (record->digest && wget_hash(record->digest, data, length))
+		wget_hash_free(&record->digest);
+
+	if (!record->spill && record->length + length > WARC_MAX_MEMORY) {
+		if ((record->spill = tmpfile())) {
+			if (fwrite(record->block->data, 1, record->block->length, record->spill) != record->block->length) {
+				error_printf(_("Failed to write WARC temporary file (errno=%d)\n"), errno);
+				set_exit_status(3);
+			}
+			wget_buffer_free(&record->block);
+		} else {
+			error_printf(_("Failed to create WARC temporary file (errno=%d)\n"), errno);
+			set_exit_status(3);
+		}
+	}
+
+	if (record->spill) {
+		if (fwrite(data, 1, length, record->spill) != length) {
+			error_printf(_("Failed to write WARC temporary file (errno=%d)\n"), errno);
+			set_exit_status(3);
+		}
+	} else
+		wget_buffer_memcat(record->block, data, length);
+
+	record->length += length;
+}
+
+// the request as it has been sent over 'conn'
+void warc_record_append_request(WARC_RECORD *record, wget_http_request_t *req, const wget_http_connection_t *conn)
+{
+	wget_buffer_t buf;
+	char sbuf[1024];
+
+	wget_buffer_init(&buf, sbuf, sizeof(sbuf));
+
+	if (conn->protocol == WGET_PROTOCOL_HTTP_2_0) {
+		// same fields as sent by wget_http_send_request(), which doesn't send a body over HTTP/2
+		wget_buffer_printf(&buf, "%s /%s HTTP/2\r\n", req->method, req->esc_resource.data ? req->esc_resource.data : "");
+
+		for (int it = 0; it < wget_vector_size(req->headers); it++) {
+			wget_http_header_param_t *param = wget_vector_get(req->headers, it);
+
+			if (wget_strcasecmp_ascii(param->name, "Connection") && wget_strcasecmp_ascii(param->name, "Transfer-Encoding"))
+				wget_buffer_printf_append(&buf, "%s: %s\r\n", param->name, param->value);
+		}
+
+		wget_buffer_memcat(&buf, "\r\n", 2);
+	} else
+		wget_http_request_to_buffer(req, &buf, conn->proxied); // including the body
+
+	warc_record_append(record, buf.data, buf.length);
+
+	wget_buffer_deinit(&buf);
+}
+
+// the response header as received, the body is appended as received from the wire
+void warc_record_append_response_header(WARC_RECORD *record, const wget_http_response_t *resp)
+{
+	const char *line, *eol;
+	wget_buffer_t buf;
+	char sbuf[1024];
+
+	if (!resp->header)
+		return;
+
+	// an HTTP/1 header is kept as received
+	if (!wget_strncasecmp_ascii(resp->header->data, "HTTP/", 5)) {
+		warc_record_append(record, resp->header->data, resp->header->length);
+		return;
+	}
+
+	// HTTP/2 headers come without status line, as 'name: value' lines with pseudo headers
+	wget_buffer_init(&buf, sbuf, sizeof(sbuf));
+	wget_buffer_printf(&buf, "HTTP/%d %d\r\n", resp->major, resp->code);
+
+	for (line = resp->header->data; *line; line = eol + 1) {
+		size_t len;
+
+		if (!(eol = strchr(line, '\n')))
+			eol = line + strlen(line) - 1;
+
+		len = eol - line + 1;
+		while (len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			len--;
+
+		if (!len)
+			break; // end of header
+
+		if (*line == ':')
+			continue; // pseudo header
+
+		wget_buffer_memcat(&buf, line, len);
+		wget_buffer_memcat(&buf, "\r\n", 2);
+	}
+
+	wget_buffer_memcat(&buf, "\r\n", 2);
+
+	warc_record_append(record, buf.data, buf.length);
+
+	wget_buffer_deinit(&buf);
+}
+
+static void _warc_sink_raw(_warc_sink_t *sink, const void *data, size_t length)
+{
+	if (sink->error || !length)
+		return;
+
+	if (sink->buf)
+		wget_buffer_memcat(sink->buf, data, length);
+	else if (sink->fp) {
+		if (fwrite(data, 1, length, sink->fp) != length)
+			sink->error = 1;
+	} else if (safe_write(sink->fd, data, length) != length)
+		sink->error = 1;
+
+	sink->length += length;
+}
+
+#ifdef WITH_ZLIB
+static void _warc_deflate(_warc_sink_t *sink, const void *data, size_t length, int flush)
+{
+	char out[16384];
+
+	sink->z.next_in = (unsigned char *) data;
+	sink->z.avail_in = (unsigned int) length;
+
+	do {
+		sink->z.next_out = (unsigned char *) out;
+		sink->z.avail_out = sizeof(out);
+
+		if (deflate(&sink->z, flush) == Z_STREAM_ERROR) {
+			sink->error = 1;
+			return;
+		}
+
+		_warc_sink_raw(sink, out, sizeof(out) - sink->z.avail_out);
+	} while (sink->z.avail_out == 0);
+}
+#endif
+
+static void _warc_sink_write(_warc_sink_t *sink, const void *data, size_t length)
+{
+#ifdef WITH_ZLIB
+	if (sink->compress) {
+		_warc_deflate(sink, data, length, Z_NO_FLUSH);
+		return;
+	}
+#endif
+
+	_warc_sink_raw(sink, data, length);
+}
+
+static void _warc_sink_begin(_warc_sink_t *sink)
+{
+#ifdef WITH_ZLIB
+	if (config.warc_compression) {
+		// each record becomes a gzip member of its own, so readers can seek to records
+		memset(&sink->z, 0, sizeof(sink->z));
+		if (deflateInit2(&sink->z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+			sink->compress = 1;
+		else
+			sink->error = 1;
+	}
+#else
+	(void) sink;
+#endif
+}
+
+static void _warc_sink_end(_warc_sink_t *sink)
+{
+#ifdef WITH_ZLIB
+	if (sink->compress) {
+		_warc_deflate(sink, NULL, 0, Z_FINISH);
+		deflateEnd(&sink->z);
+		sink->compress = 0;
+	}
+#else
+	(void) sink;
+#endif
+}
+
+// compute the WARC header, including the block digest
+static void _warc_record_header(WARC_RECORD *record, wget_buffer_t *head)
+{
+	unsigned char digest[20];
+	char digest_b32[40];
+	int ok = 0;
+
+	if (record->digest) {
+		wget_hash_deinit(record->digest, digest);
+		wget_hash_free(&record->digest);
+		ok = 1;
+	}
+
+	wget_buffer_printf(head, "WARC/1.0\r\nWARC-Type: %s\r\nWARC-Record-ID: %s\r\nWARC-Date: %s\r\n",
+		record->type, record->id, record->date);
+
+	if (record->uri)
+		wget_buffer_printf_append(head, "WARC-Target-URI: %s\r\n", record->uri);
+
+	if (*record->concurrent_to)
+		wget_buffer_printf_append(head, "WARC-Concurrent-To: %s\r\n", record->concurrent_to);
+
+	if (ok) {
+		_warc_base32(digest, sizeof(digest), digest_b32);
+		wget_buffer_printf_append(head, "WARC-Block-Digest: sha1:%s\r\n", digest_b32);
+	}
+
+	if (!strcmp(record->type, "warcinfo"))
+		wget_buffer_strcat(head, "Content-Type: application/warc-fields\r\n");
+	else
+		wget_buffer_printf_append(head, "Content-Type: application/http;msgtype=%s\r\n", record->type);
+
+	wget_buffer_printf_append(head, "Content-Length: %zu\r\n\r\n", record->length);
+}
+
+static void _warc_serialize(WARC_RECORD *record, wget_buffer_t *head, _warc_sink_t *sink)
+{
+	_warc_sink_begin(sink);
+	_warc_sink_write(sink, head->data, head->length);
+
+	if (record->spill) {
+		char buf[65536];
+		size_t n;
+
+		rewind(record->spill);
+		while ((n = fread(buf, 1, sizeof(buf), record->spill)) > 0)
+			_warc_sink_write(sink, buf, n);
+	} else
+		_warc_sink_write(sink, record->block->data, record->block->length);
+
+	_warc_sink_write(sink, "\r\n\r\n", 4);
+	_warc_sink_end(sink);
+}
+
+static int _warc_write_fd(const void *data, size_t length)
+{
+	if (safe_write(warc_fd, data, length) != length) {
+		error_printf(_("Failed to write WARC file '%s' (errno=%d)\n"), warc_filename, errno);
+		set_exit_status(3);
+		return -1;
+	}
+
+	warc_size += length;
+	return 0;
+}
+
+// called with file_mutex locked
+static int _warc_open(void)
+{
+	const char *ext = config.warc_compression ? "warc.gz" : "warc";
+
+	if (warc_fd >= 0)
+		close(warc_fd);
+
+	xfree(warc_filename);
+	if (config.warc_max_size)
+		warc_filename = wget_aprintf("%s-%05d.%s", config.warc_file, warc_serial++, ext);
+	else
+		warc_filename = wget_aprintf("%s.%s", config.warc_file, ext);
+
+	if ((warc_fd = open(warc_filename, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) < 0) {
+		error_printf(_("Failed to open WARC file '%s' (errno=%d)\n"), warc_filename, errno);
+		set_exit_status(3);
+		return -1;
+	}
+
+	warc_size = 0;
+
+	// each file starts with a warcinfo record
+	WARC_RECORD *info = warc_record_create("warcinfo", NULL, NULL);
+	wget_buffer_t *head = wget_buffer_alloc(512);
+	_warc_sink_t sink = { .fd = warc_fd };
+
+	char *fields = wget_aprintf("software: %s\r\nformat: WARC File Format 1.0\r\n", config.user_agent);
+
+	warc_record_append(info, fields, strlen(fields));
+	xfree(fields);
+	_warc_record_header(info, head);
+	_warc_serialize(info, head, &sink);
+	warc_size = sink.length;
+
+	wget_buffer_free(&head);
+	warc_record_free(&info);
+
+	if (sink.error) {
+		error_printf(_("Failed to write WARC file '%s' (errno=%d)\n"), warc_filename, errno);
+		set_exit_status(3);
+		return -1;
+	}
+
+	return 0;
+}
+
+// called with file_mutex locked, rotate if the next record doesn't fit into the current file
+static int _warc_prepare(size_t length)
+{
+	if (warc_fd < 0 || (config.warc_max_size && warc_size > 0 && warc_size + (long long) length > config.warc_max_size))
+		return _warc_open();
+
+	return 0;
+}
+
+static void _warc_process_record(WARC_RECORD *record)
+{
+	wget_buffer_t *head = wget_buffer_alloc(1024);
+
+	_warc_record_header(record, head);
+
+	if (config.warc_compression) {
+		// compress outside of the lock, records of several threads are compressed in parallel
+		_warc_sink_t sink = { .fd = -1 };
+
+		if (record->spill) {
+			if (!(sink.fp = tmpfile()))
+				sink.error = 1;
+		} else
+			sink.buf = wget_buffer_alloc(record->length / 2 + 1024);
+
+		if (!sink.error)
+			_warc_serialize(record, head, &sink);
+
+		if (sink.error) {
+			error_printf(_("Failed to compress WARC record for %s\n"), record->uri ? record->uri : "-");
+			set_exit_status(3);
+		} else {
+			wget_thread_mutex_lock(&file_mutex);
+			if (!_warc_prepare(sink.length)) {
+				if (sink.buf)
+					_warc_write_fd(sink.buf->data, sink.buf->length);
+				else {
+					char buf[65536];
+					size_t n;
+
+					rewind(sink.fp);
+					while ((n = fread(buf, 1, sizeof(buf), sink.fp)) > 0 && !_warc_write_fd(buf, n));
+				}
+			}
+			wget_thread_mutex_unlock(&file_mutex);
+		}
+
+		if (sink.fp)
+			fclose(sink.fp);
+		wget_buffer_free(&sink.buf);
+	} else {
+		wget_thread_mutex_lock(&file_mutex);
+		if (!_warc_prepare(head->length + record->length + 4)) {
+			_warc_sink_t sink = { .fd = warc_fd };
+
+			_warc_serialize(record, head, &sink);
+			warc_size += sink.length;
+
+			if (sink.error) {
+				error_printf(_("Failed to write WARC file '%s' (errno=%d)\n"), warc_filename, errno);
+				set_exit_status(3);
+			}
+		}
+		wget_thread_mutex_unlock(&file_mutex);
+	}
+
+	wget_buffer_free(&head);
+	warc_record_free(&record);
+}
+
+static void *_warc_thread(void *p G_GNUC_WGET_UNUSED)
+{
+	wget_thread_mutex_lock(&queue_mutex);
+
+	for (;;) {
+		WARC_RECORD **first = wget_list_getfirst(queue);
+
+		if (first) {
+			WARC_RECORD *record = *first;
+
+			wget_list_remove(&queue, first);
+			wget_thread_mutex_unlock(&queue_mutex);
+
+			_warc_process_record(record);
+
+			wget_thread_mutex_lock(&queue_mutex);
+		} else if (stop_threads)
+			break;
+		else
+			wget_thread_cond_wait(&queue_cond, &queue_mutex, 0);
+	}
+
+	wget_thread_mutex_unlock(&queue_mutex);
+
+	return NULL;
+}
+
+void warc_record_write(WARC_RECORD *record)
+{
+	if (!warc_nthreads) {
+		_warc_process_record(record);
+		return;
+	}
+
+	wget_thread_mutex_lock(&queue_mutex);
+	wget_list_append(&queue, &record, sizeof(WARC_RECORD *));
+	wget_thread_cond_signal(&queue_cond);
+	wget_thread_mutex_unlock(&queue_mutex);
+}
+
+int warc_init(void)
+{
+	int rc;
+
+#ifndef WITH_ZLIB
+	if (config.warc_compression) {
+		info_printf(_("No zlib support, writing uncompressed WARC files\n"));
+		config.warc_compression = 0;
+	}
+#endif
+
+	wget_thread_mutex_lock(&file_mutex);
+	rc = _warc_open();
+	wget_thread_mutex_unlock(&file_mutex);
+
+	if (rc)
+		return rc;
+
+	if (wget_thread_support()) {
+		wget_thread_cond_init(&queue_cond);
+
+		for (warc_nthreads = 0; warc_nthreads < WARC_THREADS; warc_nthreads++) {
+			if ((rc = wget_thread_start(&warc_threads[warc_nthreads], _warc_thread, NULL, 0)) != 0) {
+				error_printf(_("Failed to start WARC thread, error %d\n"), rc);
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
+
+void warc_exit(void)
+{
+	// let the threads finish the queue
+	wget_thread_mutex_lock(&queue_mutex);
+	stop_threads = 1;
+	wget_thread_cond_signal(&queue_cond);
+	wget_thread_mutex_unlock(&queue_mutex);
+
+	for (int it = 0; it < warc_nthreads; it++)
+		wget_thread_join(warc_threads[it]);
+	warc_nthreads = 0;
+
+	if (warc_fd >= 0) {
+		close(warc_fd);
+		warc_fd = -1;
+	}
+
+	xfree(warc_filename);
+}
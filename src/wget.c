@@ -56,11 +56,19 @@
 #include "wget_blacklist.h"
 #include "wget_host.h"
 #include "wget_bar.h"
+#include "wget_warc.h"
+#include "wget_cache.h"
+#include "wget_compress.h"
+#include "wget_probes.h"
 
 #define URL_FLG_REDIRECTION  (1<<0)
 #define URL_FLG_SITEMAP      (1<<1)
 
 #define _CONTENT_TYPE_HTML 1
+
+#define DECOMPRESS_BUFFER_SIZE (128 * 1024) // size of file writes for Content-Encoded bodies
+#define REDIRECT_MAXAGE (30 * 86400) // lifetime of a learned permanent redirect if the server gives none (seconds)
+
 typedef struct {
 	const char *
 		filename;
@@ -79,26 +87,35 @@ typedef struct {
 	int
 		ndownloads; // file downloads with 200 response
 	int
-		nredirects; // 301, 302
+		nredirects; // 301, 302, 307, 308
+	int
+		nredirects_cached; // permanent redirects followed from the redirect cache
 	int
 		nnotmodified; // 304
 	int
 		nerrors;
 	int
 		nchunks; // chunk downloads with 200 response
+	int
+		nconnections; // connections opened
 	long long
 		bytes_body_uncompressed; // uncompressed bytes in body
 } _statistics_t;
 static _statistics_t stats;
 
 static int G_GNUC_WGET_NONNULL((1))
-	_prepare_file(wget_http_response_t *resp, const char *fname, int flag);
+	_prepare_file(wget_http_response_t *resp, const char *fname, int flag, COMPRESSED_FILE **compressor);
+static time_t G_GNUC_WGET_NONNULL_ALL
+	get_file_mtime(const char *fname);
+static char * G_GNUC_WGET_NONNULL_ALL
+	_read_compressed_copy(const char *fname, size_t *length);
 
 static void
 	sitemap_parse_xml(JOB *job, const char *data, const char *encoding, wget_iri_t *base),
 	sitemap_parse_xml_gz(JOB *job, wget_buffer_t *data, const char *encoding, wget_iri_t *base),
 	sitemap_parse_xml_localfile(JOB *job, const char *fname, const char *encoding, wget_iri_t *base),
 	sitemap_parse_text(JOB *job, const char *data, const char *encoding, wget_iri_t *base),
+	sitemap_parse_localcopy(JOB *job, const char *fname, const char *encoding, wget_iri_t *base),
 	atom_parse(JOB *job, const char *data, const char *encoding, wget_iri_t *base),
 	atom_parse_localfile(JOB *job, const char *fname, const char *encoding, wget_iri_t *base),
 	rss_parse(JOB *job, const char *data, const char *encoding, wget_iri_t *base),
@@ -110,10 +127,16 @@ static void
 	css_parse_localfile(JOB *job, const char *fname, const char *encoding, wget_iri_t *base);
 static unsigned int G_GNUC_WGET_PURE
 	hash_url(const char *url);
+static void
+	_free_known_url(char *url);
 static int
-	http_send_request(wget_iri_t *iri, DOWNLOADER *downloader);
-wget_http_response_t
-	*http_receive_response(wget_http_connection_t *conn);
+	http_send_request(wget_iri_t *iri, DOWNLOADER *downloader, CACHE_ENTRY **cache_entry);
+static wget_http_response_t
+	*http_get_cached_response(DOWNLOADER *downloader, CACHE_ENTRY **stale);
+static wget_http_response_t
+	*http_receive_response(DOWNLOADER *downloader);
+static void
+	http_abort_responses(DOWNLOADER *downloader);
 
 static wget_stringmap_t
 	*etags;
@@ -128,12 +151,34 @@ static long long
 static int
 	exit_status,
 	hsts_changed,
-	hpkp_changed;
+	hpkp_changed,
+	redirect_changed;
 static volatile int
 	terminate;
 int
 	nthreads;
 
+// adaptive downloader pool (--min-threads), protected by main_mutex
+#define POOL_INTERVAL_MIN 500 // min. length of a measurement window in ms
+#define POOL_INTERVAL_MAX 5000 // max. length of a measurement window in ms
+#define POOL_HOLD 3 // number of windows to wait after growing didn't pay off
+
+static struct {
+	long long
+		window_start, // begin of the current measurement window (ms)
+		idle_ms, // sum of the time downloaders waited for a job, without politeness pauses
+		latency_ms, // sum of the time from sending a request to a finished response
+		throughput; // responses per 1000s in the last window of growth
+	int
+		size, // target number of downloaders
+		running, // number of running downloaders
+		retire, // number of downloaders asked to leave the pool
+		completed, // responses finished in the current window
+		peak, // max. size of the pool
+		hold, // windows to wait before growing again
+		grown; // number of downloaders added at the end of the last window
+} pool;
+
 void set_exit_status(int status)
 {
 	// use Wget exit status scheme:
@@ -455,11 +500,75 @@ static int in_host_pattern_list(const wget_vector_t *v, const char *hostname)
 	return 0;
 }
 
+// normalized URL, key of the redirect cache
+static void _redirect_key(const wget_iri_t *iri, wget_buffer_t *buf)
+{
+	wget_buffer_strcpy(buf, iri->scheme);
+	wget_buffer_memcat(buf, "://", 3);
+	wget_buffer_strcat(buf, iri->host);
+	if (iri->resolv_port) {
+		wget_buffer_memcat(buf, ":", 1);
+		wget_buffer_strcat(buf, iri->resolv_port);
+	}
+	wget_buffer_memcat(buf, "/", 1);
+	wget_iri_get_escaped_resource(iri, buf);
+}
+
+// Replace 'iri' by the target of known permanent redirects (--redirect-cache).
+// The replaced IRIs are blacklisted, '*source' is set to the first of them.
+// Returns NULL if a replaced URL is known already.
+static wget_iri_t *_follow_known_redirects(wget_iri_t *iri, wget_iri_t **source)
+{
+	wget_buffer_t key;
+	char key_sbuf[1024], *target;
+	int max = config.max_redirect ? config.max_redirect : 20;
+
+	*source = NULL;
+	wget_buffer_init(&key, key_sbuf, sizeof(key_sbuf));
+
+	for (int it = 0; it < max && iri->host; it++) {
+		wget_iri_t *target_iri;
+
+		_redirect_key(iri, &key);
+		if (!(target = wget_redirect_db_get(config.redirect_db, key.data, NULL)))
+			break;
+
+		target_iri = wget_iri_parse(target, "utf-8");
+		xfree(target);
+
+		if (!target_iri || (target_iri->scheme != WGET_IRI_SCHEME_HTTP && target_iri->scheme != WGET_IRI_SCHEME_HTTPS)
+			|| !wget_iri_compare(iri, target_iri))
+		{
+			wget_iri_free(&target_iri);
+			break;
+		}
+
+		debug_printf("known permanent redirect %s -> %s\n", iri->uri, target_iri->uri);
+
+		// the redirected URL won't be requested, but it is known from now on
+		if (!blacklist_add(iri)) {
+			wget_iri_free(&target_iri);
+			iri = NULL;
+			break;
+		}
+
+		_atomic_increment_int(&stats.nredirects_cached);
+
+		if (!*source)
+			*source = iri;
+		iri = target_iri;
+	}
+
+	wget_buffer_deinit(&key);
+
+	return iri;
+}
+
 // Add URLs given by user (command line, file or -i option).
 // Needs to be thread-save.
 static void add_url_to_queue(const char *url, wget_iri_t *base, const char *encoding)
 {
-	wget_iri_t *iri;
+	wget_iri_t *iri, *redirect_source = NULL;
 	JOB *new_job = NULL, job_buf;
 	HOST *host;
 
@@ -476,6 +585,10 @@ static void add_url_to_queue(const char *url, wget_iri_t *base, const char *enco
 		return;
 	}
 
+	// a known permanent redirect is followed without asking the server, the target counts as given by the user
+	if (config.redirect_db && !(iri = _follow_known_redirects(iri, &redirect_source)))
+		return;
+
 	wget_thread_mutex_lock(&downloader_mutex);
 
 	if (!blacklist_add(iri)) {
@@ -483,6 +596,7 @@ static void add_url_to_queue(const char *url, wget_iri_t *base, const char *enco
 		wget_thread_mutex_unlock(&downloader_mutex);
 		return;
 	}
+	WGET_PROBE1(url_blacklist, iri->uri);
 
 	// only download content from hosts given on the command line or from input file
 	if (wget_vector_contains(config.exclude_domains, iri->host)) {
@@ -523,7 +637,10 @@ static void add_url_to_queue(const char *url, wget_iri_t *base, const char *enco
 	}
 
 	new_job = job_init(&job_buf, iri);
-	new_job->local_filename = get_local_filename(iri);
+	if (redirect_source && !config.trust_server_names)
+		new_job->local_filename = get_local_filename(redirect_source); // the name a followed redirect would get
+	else
+		new_job->local_filename = get_local_filename(iri);
 
 	if (config.recursive) {
 		if (config.accept_patterns && !in_pattern_list(config.accept_patterns, new_job->iri->uri))
@@ -538,6 +655,7 @@ static void add_url_to_queue(const char *url, wget_iri_t *base, const char *enco
 	if (config.spider || config.chunk_size)
 		new_job->head_first = 1;
 
+	WGET_PROBE2(url_enqueue, new_job->iri->uri, new_job->level);
 	host_add_job(host, new_job);
 
 	wget_thread_mutex_unlock(&downloader_mutex);
@@ -556,10 +674,11 @@ static void
 
 // Add URLs parsed from downloaded files
 // Needs to be thread-save
-static void add_url(JOB *job, const char *encoding, const char *url, int flags)
+// 'lastmod' is the modification time given by a sitemap, 0 if unknown
+static void _add_url(JOB *job, const char *encoding, const char *url, int flags, time_t lastmod)
 {
 	JOB *new_job = NULL, job_buf;
-	wget_iri_t *iri;
+	wget_iri_t *iri, *redirect_source = NULL;
 	HOST *host;
 
 	if (flags & URL_FLG_REDIRECTION) { // redirect
@@ -598,6 +717,10 @@ static void add_url(JOB *job, const char *encoding, const char *url, int flags)
 		return;
 	}
 
+	// a known permanent redirect is followed without asking the server
+	if (config.redirect_db && !(iri = _follow_known_redirects(iri, &redirect_source)))
+		return;
+
 	if (config.https_only && iri->scheme != WGET_IRI_SCHEME_HTTPS) {
 		info_printf(_("URL '%s' not followed (https-only requested)\n"), url);
 		wget_iri_free(&iri);
@@ -611,6 +734,7 @@ static void add_url(JOB *job, const char *encoding, const char *url, int flags)
 		wget_thread_mutex_unlock(&downloader_mutex);
 		return;
 	}
+	WGET_PROBE1(url_blacklist, iri->uri);
 
 	if (config.recursive) {
 		// only download content from given hosts
@@ -684,10 +808,27 @@ static void add_url(JOB *job, const char *encoding, const char *url, int flags)
 	new_job = job_init(&job_buf, iri);
 
 	if (!config.output_document) {
-		if (!(flags & URL_FLG_REDIRECTION) || config.trust_server_names || !job)
-			new_job->local_filename = get_local_filename(new_job->iri);
-		else
+		if ((flags & URL_FLG_REDIRECTION) && !config.trust_server_names && job)
 			new_job->local_filename = wget_strdup(job->local_filename);
+		else if (redirect_source && !config.trust_server_names)
+			new_job->local_filename = get_local_filename(redirect_source); // the name a followed redirect would get
+		else
+			new_job->local_filename = get_local_filename(new_job->iri);
+	}
+
+	// --timestamping: the sitemap says our copy is up-to-date, no need to ask the server
+	if (lastmod && config.timestamping && new_job->local_filename && get_file_mtime(new_job->local_filename) >= lastmod) {
+		wget_thread_mutex_unlock(&downloader_mutex);
+		info_printf(_("URL '%s' not requested (local copy is not older than sitemap lastmod)\n"), iri->uri);
+
+		// the URLs of a nested sitemap are taken from the local copy
+		if (flags & URL_FLG_SITEMAP) {
+			new_job->level = job ? job->level + 1 : 0;
+			sitemap_parse_localcopy(new_job, new_job->local_filename, encoding, new_job->iri);
+		}
+
+		job_free(new_job);
+		return;
 	}
 
 	if (job) {
@@ -717,6 +858,7 @@ static void add_url(JOB *job, const char *encoding, const char *url, int flags)
 		new_job->sitemap = 1;
 
 	// now add the new job to the queue (thread-safe))
+	WGET_PROBE2(url_enqueue, new_job->iri->uri, new_job->level);
 	new_job = host_add_job(host, new_job);
 
 	// and wake up all waiting threads
@@ -725,6 +867,11 @@ static void add_url(JOB *job, const char *encoding, const char *url, int flags)
 	wget_thread_mutex_unlock(&downloader_mutex);
 }
 
+static void add_url(JOB *job, const char *encoding, const char *url, int flags)
+{
+	_add_url(job, encoding, url, flags, 0);
+}
+
 static void _convert_links(void)
 {
 	FILE *fpout = NULL;
@@ -845,6 +992,21 @@ static void print_status(DOWNLOADER *downloader G_GNUC_WGET_UNUSED, const char *
 	}
 }
 
+#ifdef ENABLE_MEMSTATS
+static void _print_memstats(int from_signal)
+{
+	char buf[1024];
+	size_t len = wget_memstats_report(buf, sizeof(buf));
+
+	if (from_signal) {
+		// stdio and the logger are not async-signal-safe
+		if (write(STDERR_FILENO, buf, len) < 0)
+			return;
+	} else
+		info_printf("%s", buf);
+}
+#endif
+
 static void nop(int sig)
 {
 	if (sig == SIGTERM) {
@@ -858,10 +1020,118 @@ static void nop(int sig)
 #ifdef SIGWINCH
 	} else if (sig == SIGWINCH) {
 		wget_bar_screen_resized();
+#endif
+#if defined ENABLE_MEMSTATS && defined SIGUSR1
+	} else if (sig == SIGUSR1) {
+		_print_memstats(1);
 #endif
 	}
 }
 
+// called with main_mutex locked: start downloaders up to the pool size, but not more than there are jobs
+static void _start_downloaders(void)
+{
+	int rc;
+
+	for (int n = 0; n < config.max_threads && pool.running < pool.size && pool.running < queue_size(); n++) {
+		DOWNLOADER *downloader = &downloaders[n];
+
+		if (n < nthreads) {
+			if (!downloader->retired && !downloader->failed)
+				continue;
+
+			// reuse the slot of a downloader that left the pool or could not be started
+			if (downloader->retired)
+				wget_thread_join(downloader->tid);
+			memset(downloader, 0, sizeof(*downloader));
+		} else
+			nthreads = n + 1;
+
+		downloader->id = n;
+
+		if (config.progress)
+			bar_update_slots(nthreads + 2);
+
+		// start worker threads (I call them 'downloaders')
+		if ((rc = wget_thread_start(&downloader->tid, downloader_thread, downloader, 0)) != 0) {
+			error_printf(_("Failed to start downloader, error %d\n"), rc);
+			downloader->failed = 1;
+			break;
+		}
+
+		pool.running++;
+	}
+
+	if (pool.running > pool.peak)
+		pool.peak = pool.running;
+}
+
+/*
+ * Called with main_mutex locked.
+ * Resize the downloader pool (--min-threads) once per measurement window, which lasts a few response latencies.
+ * Idle downloaders are retired. If downloaders are busy and jobs are waiting, the pool grows as long as
+ * this increases the throughput - if not, the last step is taken back (hill climbing).
+ */
+static void _adapt_pool(void)
+{
+	long long now = wget_get_timemillis(), elapsed = now - pool.window_start;
+	long long latency = pool.completed ? pool.latency_ms / pool.completed : 0;
+	long long interval = latency * 4, throughput;
+	int idle; // percentage of the time downloaders waited for a job
+
+	if (interval < POOL_INTERVAL_MIN)
+		interval = POOL_INTERVAL_MIN;
+	else if (interval > POOL_INTERVAL_MAX)
+		interval = POOL_INTERVAL_MAX;
+
+	if (elapsed < interval)
+		return;
+
+	idle = (int) (pool.idle_ms * 100 / (elapsed * (pool.running ? pool.running : 1)));
+
+	// without finished responses there is nothing to compare, unless downloaders are idle
+	if (!pool.completed && idle <= 50 && elapsed < POOL_INTERVAL_MAX)
+		return;
+
+	throughput = pool.completed * 1000000LL / elapsed;
+
+	debug_printf("pool: %d downloaders, %lld responses/1000s, latency %lld ms, idle %d%%, queue %d\n",
+		pool.running, throughput, latency, idle, queue_size());
+
+	if (idle > 50) {
+		// more downloaders than work
+		if (pool.size > config.min_threads)
+			pool.size--;
+		pool.grown = 0;
+	} else if (pool.grown && throughput * 100 < pool.throughput * 105) {
+		// the last step didn't pay off (e.g. the server or the network is the bottleneck)
+		pool.size -= pool.grown;
+		pool.grown = 0;
+		pool.hold = POOL_HOLD;
+	} else if (pool.hold) {
+		pool.hold--;
+		pool.grown = 0;
+	} else if (idle < 10 && queue_size() > pool.running && pool.size < config.max_threads) {
+		int step = pool.size / 2 ? pool.size / 2 : 1;
+
+		if (step > config.max_threads - pool.size)
+			step = config.max_threads - pool.size;
+
+		pool.size += step;
+		pool.grown = step;
+		pool.throughput = throughput;
+	} else
+		pool.grown = 0;
+
+	// idle downloaders leave the pool first, busy ones when they finished their job
+	if ((pool.retire = pool.running > pool.size ? pool.running - pool.size : 0))
+		wget_thread_cond_signal(&worker_cond);
+
+	pool.window_start = now;
+	pool.idle_ms = pool.latency_ms = 0;
+	pool.completed = 0;
+}
+
 int main(int argc, const char **argv)
 {
 	int n, rc;
@@ -892,9 +1162,13 @@ int main(int argc, const char **argv)
 	sigaction(SIGTERM, &sig_action, NULL);
 	sigaction(SIGINT, &sig_action, NULL);
 	sigaction(SIGWINCH, &sig_action, NULL);
+#ifdef ENABLE_MEMSTATS
+	sigaction(SIGUSR1, &sig_action, NULL); // print memory usage by subsystem
+#endif
 #endif
 
 	known_urls = wget_hashmap_create(128, -2, (wget_hashmap_hash_t)hash_url, (wget_hashmap_compare_t)strcmp);
+	wget_hashmap_set_key_destructor(known_urls, (wget_hashmap_key_destructor_t)_free_known_url);
 
 	n = init(argc, argv);
 	if (n < 0) {
@@ -902,6 +1176,10 @@ int main(int argc, const char **argv)
 		goto out;
 	}
 
+	// hosts that failed in former runs may be skipped right away
+	if (config.host_health_file)
+		host_health_load(config.host_health_file);
+
 	for (; n < argc; n++) {
 		add_url_to_queue(argv[n], config.base, config.local_encoding);
 	}
@@ -990,6 +1268,7 @@ int main(int argc, const char **argv)
 	// threads.
 	if (!wget_thread_support()) {
 		config.max_threads = 1;
+		config.min_threads = 0;
 	}
 
 	if (config.progress) {
@@ -997,8 +1276,27 @@ int main(int argc, const char **argv)
 		bar_init();
 	}
 
+	if (config.warc_file && warc_init()) {
+		set_exit_status(3);
+		goto out;
+	}
+
+	if (config.cache_dir && cache_init()) {
+		set_exit_status(3);
+		goto out;
+	}
+
+	if (config.compress_output && compress_init()) {
+		set_exit_status(3);
+		goto out;
+	}
+
 	downloaders = wget_calloc(config.max_threads, sizeof(DOWNLOADER));
 
+	// with --min-threads the pool starts small and adapts to the measured load
+	pool.size = config.min_threads ? config.min_threads : config.max_threads;
+	pool.window_start = wget_get_timemillis();
+
 	wget_thread_mutex_lock(&main_mutex);
 	while (!terminate) {
 		// queue_print();
@@ -1006,17 +1304,10 @@ int main(int argc, const char **argv)
 			break;
 		}
 
-		for (;nthreads < config.max_threads && nthreads < queue_size(); nthreads++) {
-			downloaders[nthreads].id = nthreads;
-
-			if (config.progress)
-				bar_update_slots(nthreads + 2);
+		if (config.min_threads)
+			_adapt_pool();
 
-			// start worker threads (I call them 'downloaders')
-			if ((rc = wget_thread_start(&downloaders[nthreads].tid, downloader_thread, &downloaders[nthreads], 0)) != 0) {
-				error_printf(_("Failed to start downloader, error %d\n"), rc);
-			}
-		}
+		_start_downloaders();
 
 		if (config.progress)
 			bar_printf(nthreads, "Files: %d  Bytes: %s  Redirects: %d  Todo: %d",
@@ -1028,7 +1319,7 @@ int main(int argc, const char **argv)
 		}
 
 		// here we sit and wait for an event from our worker threads
-		wget_thread_cond_wait(&main_cond, &main_mutex, 0);
+		wget_thread_cond_wait(&main_cond, &main_mutex, config.min_threads ? 100 : 0);
 		debug_printf("%s: wake up\n", __func__);
 	}
 	debug_printf("%s: done\n", __func__);
@@ -1038,6 +1329,9 @@ int main(int argc, const char **argv)
 	wget_thread_cond_signal(&worker_cond);
 	wget_thread_mutex_unlock(&main_mutex);
 
+	if (config.min_threads)
+		info_printf(_("Downloader pool: %d threads at most, %d at the end\n"), pool.peak, pool.running);
+
 	for (n = 0; n < nthreads; n++) {
 		//		struct timespec ts;
 		//		gettime(&ts);
@@ -1045,6 +1339,8 @@ int main(int argc, const char **argv)
 		// if the thread is not detached, we have to call pthread_join()/pthread_timedjoin_np()
 		// else we will have a huge memory leak
 		//		if ((rc=pthread_timedjoin_np(downloader[n].tid, NULL, &ts))!=0)
+		if (downloaders[n].failed)
+			continue;
 		if ((rc = wget_thread_join(downloaders[n].tid)) != 0)
 			error_printf(_("Failed to wait for downloader #%d (%d %d)\n"), n, rc, errno);
 	}
@@ -1057,6 +1353,34 @@ int main(int argc, const char **argv)
 			stats.ndownloads, wget_human_readable(quota_buf, sizeof(quota_buf), quota), stats.nredirects, stats.nerrors);
 	}
 
+	if (config.recursive || config.page_requisites || config.input_file) {
+		int nresponses = stats.ndownloads + stats.nchunks + stats.nredirects + stats.nnotmodified + stats.nerrors;
+
+		if (nresponses) {
+			// in hundredths, wget's printf functions have no floating point support
+			int ratio = (int) ((stats.nconnections * 100LL + nresponses / 2) / nresponses);
+
+			info_printf(_("Connections: %d opened for %d responses (%d.%02d per response)\n"),
+				stats.nconnections, nresponses, ratio / 100, ratio % 100);
+		}
+	}
+
+	if (stats.nredirects_cached)
+		info_printf(_("Redirect cache: %d permanent redirects followed without a request\n"), stats.nredirects_cached);
+
+	if (config.warc_file)
+		warc_exit();
+
+	if (config.cache_dir)
+		cache_exit();
+
+	if (config.compress_output)
+		compress_exit();
+
+#ifdef ENABLE_MEMSTATS
+	_print_memstats(0);
+#endif
+
 	if (config.save_cookies)
 		wget_cookie_db_save(config.cookie_db, config.save_cookies);
 
@@ -1066,6 +1390,12 @@ int main(int argc, const char **argv)
 	if (config.hpkp && config.hpkp_file && hpkp_changed)
 		wget_hpkp_db_save(config.hpkp_db, config.hpkp_file);
 
+	if (config.redirect_cache && config.redirect_cache_file && redirect_changed)
+		wget_redirect_db_save(config.redirect_db, config.redirect_cache_file);
+
+	if (config.host_health_file)
+		host_health_save(config.host_health_file);
+
 	if (config.tls_resume && config.tls_session_file && wget_tls_session_db_changed(config.tls_session_db))
 		wget_tls_session_db_save(config.tls_session_db, config.tls_session_file);
 
@@ -1122,9 +1452,17 @@ void *input_thread(void *p G_GNUC_WGET_UNUSED)
 	return NULL;
 }
 
+// the connection has been opened for 'host' itself, it is not coalesced from another host name
+static int _is_own_connection(const wget_http_connection_t *conn, const HOST *host)
+{
+	return !wget_strcmp(conn->esc_host, host->host) && !wget_strcmp(conn->scheme, host->scheme)
+		&& !wget_strcmp(conn->port, host->port);
+}
+
 static int try_connection(DOWNLOADER *downloader, wget_iri_t *iri)
 {
 	wget_http_connection_t *conn;
+	HOST *host = downloader->job->host;
 	int rc;
 
 	if (config.hsts && iri->scheme == WGET_IRI_SCHEME_HTTP && wget_hsts_host_match(config.hsts_db, iri->host, atoi(iri->resolv_port))) {
@@ -1133,11 +1471,10 @@ static int try_connection(DOWNLOADER *downloader, wget_iri_t *iri)
 	}
 
 	if ((conn = downloader->conn)) {
-		if (!wget_strcmp(conn->esc_host, iri->host) &&
-			conn->scheme == iri->scheme &&
-			!wget_strcmp(conn->port, iri->resolv_port))
-		{
+		// same host or a HTTP/2 connection that also serves iri->host (unless the server refused that)
+		if (wget_http_match_connection(conn, iri) && !(host && host->misdirected && !_is_own_connection(conn, host))) {
 			debug_printf("reuse connection %s\n", conn->esc_host);
+			downloader->new_connection = 0;
 			return WGET_E_SUCCESS;
 		}
 
@@ -1147,6 +1484,8 @@ static int try_connection(DOWNLOADER *downloader, wget_iri_t *iri)
 
 	if ((rc = wget_http_open(&downloader->conn, iri)) == WGET_E_SUCCESS) {
 		debug_printf("established connection %s\n", downloader->conn->esc_host);
+		_atomic_increment_int(&stats.nconnections);
+		downloader->new_connection = 1;
 	} else {
 		debug_printf("Failed to connect (%d)\n", rc);
 	}
@@ -1154,6 +1493,25 @@ static int try_connection(DOWNLOADER *downloader, wget_iri_t *iri)
 	return rc;
 }
 
+// Classify a connection failure for the host health, 'rc' is a WGET_E_* code.
+// With a non-blocking connect (or TCP Fast Open) a refused connection shows up when sending the request.
+static enum host_error _host_error(int rc)
+{
+	switch (rc) {
+	case WGET_E_ADDRESS:
+		return HOST_ERROR_DNS;
+	case WGET_E_CONNREFUSED:
+		return HOST_ERROR_REFUSED;
+	case WGET_E_TIMEOUT:
+		return HOST_ERROR_TIMEOUT;
+	case WGET_E_HANDSHAKE:
+	case WGET_E_CERTIFICATE:
+		return HOST_ERROR_TLS;
+	default:
+		return HOST_ERROR_CONNECTION;
+	}
+}
+
 static int establish_connection(DOWNLOADER *downloader, wget_iri_t **iri)
 {
 	int rc = WGET_E_UNKNOWN;
@@ -1221,7 +1579,7 @@ static void add_statistics(wget_http_response_t *resp)
 		else
 			_atomic_increment_int(&stats.ndownloads);
 	}
-	else if (resp->code == 301 || resp->code == 302)
+	else if (resp->code == 301 || resp->code == 302 || resp->code == 307 || resp->code == 308)
 		_atomic_increment_int(&stats.nredirects);
 	else if (resp->code == 304)
 		_atomic_increment_int(&stats.nnotmodified);
@@ -1237,6 +1595,14 @@ static int process_response_header(wget_http_response_t *resp)
 
 	print_status(downloader, "HTTP response %d %s\n", resp->code, resp->reason);
 
+	// 421 Misdirected Request: the coalesced connection doesn't serve this host (RFC 9110 15.5.20).
+	// Try again on a connection of its own.
+	if (resp->code == 421 && job->host && downloader->conn && !_is_own_connection(downloader->conn, job->host)) {
+		host_set_misdirected(job->host);
+		job->inuse = 0;
+		return 1;
+	}
+
 	// Wget1.x compatibility
 	if (resp->code/100 == 4 && resp->code!=416) {
 		if (job->head_first)
@@ -1305,6 +1671,22 @@ static int process_response_header(wget_http_response_t *resp)
 
 		wget_iri_relative_to_abs(iri, resp->location, strlen(resp->location), &uri_buf);
 
+		// remember permanent redirects for later links and runs (--redirect-cache)
+		if (config.redirect_db && (resp->code == 301 || resp->code == 308) && !job->part && iri->host
+			&& (!strcmp(resp->req->method, "GET") || !strcmp(resp->req->method, "HEAD")))
+		{
+			wget_buffer_t key;
+			char key_sbuf[1024];
+
+			wget_buffer_init(&key, key_sbuf, sizeof(key_sbuf));
+			_redirect_key(iri, &key);
+			// Cache-Control and Expires rule, 30 days if the server doesn't say (a maxage of 0 removes the entry)
+			wget_redirect_db_add(config.redirect_db,
+				wget_redirect_new(key.data, uri_buf.data, resp->code, cache_response_lifetime(resp, REDIRECT_MAXAGE)));
+			wget_buffer_deinit(&key);
+			redirect_changed = 1;
+		}
+
 //			if (!part) {
 		add_url(job, "utf-8", uri_buf.data, URL_FLG_REDIRECTION);
 		wget_buffer_deinit(&uri_buf);
@@ -1607,11 +1989,23 @@ static void process_response(wget_http_response_t *resp)
 				ext = strrchr(job->local_filename, '.');
 
 			if (ext) {
+				const char *encoding = resp->content_type_encoding ? resp->content_type_encoding : config.remote_encoding;
+				char *data = NULL;
+				size_t length;
+
 				if (!wget_strcasecmp_ascii(ext, ".html") || !wget_strcasecmp_ascii(ext, ".htm")) {
-					html_parse_localfile(job, job->level, job->local_filename, resp->content_type_encoding ? resp->content_type_encoding : config.remote_encoding, job->iri);
+					if ((data = _read_compressed_copy(job->local_filename, &length)))
+						html_parse(job, job->level, data, length, encoding, job->iri);
+					else
+						html_parse_localfile(job, job->level, job->local_filename, encoding, job->iri);
 				} else if (!wget_strcasecmp_ascii(ext, ".css")) {
-					css_parse_localfile(job, job->local_filename, resp->content_type_encoding ? resp->content_type_encoding : config.remote_encoding, job->iri);
+					if ((data = _read_compressed_copy(job->local_filename, &length)))
+						css_parse(job, data, length, encoding, job->iri);
+					else
+						css_parse_localfile(job, job->local_filename, encoding, job->iri);
 				}
+
+				xfree(data);
 			}
 		}
 	}
@@ -1624,14 +2018,88 @@ enum actions {
 	ACTION_ERROR
 };
 
+// request window of an HTTP/2 connection, local to a downloader and kept while the connection is reused
+typedef struct {
+	long long
+		start, // connection established (ms), 0 if not HTTP/2
+		rtt, // lowest latency of a request so far (ms)
+		last, // last response (ms) while more requests were pending, else 0
+		interval; // moving average of the time between two responses (1/16 ms)
+	int
+		samples; // intervals measured
+} _http2_window_t;
+
+/*
+ * Number of requests to keep in flight on an HTTP/2 connection.
+ *
+ * At most what the peer allows (SETTINGS_MAX_CONCURRENT_STREAMS, which can change
+ * with every SETTINGS frame) and --http2-request-window. Below that, enough to cover
+ * the latency/bandwidth product counted in responses: rate * lowest latency. More
+ * requests would just queue on the server and hold jobs other connections could take.
+ * The rate is measured with the current window, so there is room to grow to twice of it.
+ */
+static int _http2_request_window(const wget_http_connection_t *conn, const _http2_window_t *w)
+{
+	int window = config.http2_request_window, streams = wget_http_get_max_streams(conn);
+
+	if (streams < window)
+		window = streams;
+
+	// no interval means more than one response per millisecond, nothing to limit
+	if (w->samples && w->rtt > 0 && w->interval > 0) {
+		long long needed = 2 * ((w->rtt * 16 + w->interval - 1) / w->interval) + 1;
+
+		if (needed < window)
+			window = (int) needed;
+	}
+
+	return window > 0 ? window : 1;
+}
+
+/*
+ * Account a response on an HTTP/2 connection, 'pending' includes this response.
+ *
+ * Only the time between responses that were requested at the same time counts,
+ * so the rate follows the last few responses and an idle connection
+ * (e.g. waiting for --wait or Crawl-delay) doesn't drag it down.
+ */
+static void _http2_response(_http2_window_t *w, long long latency, int pending)
+{
+	long long now = wget_get_timemillis();
+
+	if (latency > 0 && (!w->rtt || latency < w->rtt))
+		w->rtt = latency;
+
+	if (w->last) {
+		long long sample = (now - w->last) * 16;
+
+		if (w->samples++)
+			w->interval += (sample - w->interval) / 4;
+		else
+			w->interval = sample;
+	}
+
+	w->last = pending > 1 ? now : 0;
+}
+
+// called with main_mutex locked
+static void _wait_for_job(long long pause)
+{
+	if (wget_thread_support())
+		wget_thread_cond_wait(&worker_cond, &main_mutex, pause);
+	else
+		wget_millisleep(pause);
+}
+
 void *downloader_thread(void *p)
 {
 	DOWNLOADER *downloader = p;
 	wget_http_response_t *resp = NULL;
 	JOB *job;
 	HOST *host = NULL;
-	int pending = 0, max_pending = 1, locked;
-	long long pause = 0;
+	int pending = 0, max_pending = 1, locked, rc;
+	long long pause = 0, latency = 0;
+	_http2_window_t http2 = { .start = 0 };
 	enum actions action = ACTION_GET_JOB;
 
 	downloader->tid = wget_thread_self(); // to avoid race condition
@@ -1643,63 +2111,105 @@ void *downloader_thread(void *p)
 
 		switch (action) {
 		case ACTION_GET_JOB: // Get a job, connect, send request
-			if (!(job = host_get_job(host, &pause))) {
+			if (pool.retire && !pending) {
+				// the pool shrinks (--min-threads)
+				pool.retire--;
+				pool.running--;
+				downloader->retired = 1;
+				goto out;
+			}
+
+			if (!(job = host_get_job(host, downloader->conn, &pause))) {
 				if (pending) {
 					wget_thread_mutex_unlock(&main_mutex); locked = 0;
 					action = ACTION_GET_RESPONSE;
-				} else if (host) {
-					wget_http_close(&downloader->conn);
+					break;
+				}
+
+				if (host) {
+					// nothing to do for our host right now (or it has to wait for --wait, Crawl-delay):
+					// look for other work, jobs for our host are still preferred while the connection is open
 					host = NULL;
+					break;
 				} else {
-					if (!wget_thread_support()) {
+					long long start;
+
+					// keep the connection over a politeness pause only
+					if (!pause)
+						wget_http_close(&downloader->conn);
+
+					if (!wget_thread_support() && !pause) {
 						goto out;
 					}
-					wget_thread_cond_wait(&worker_cond, &main_mutex, pause); locked = 1;
+
+					start = wget_get_timemillis();
+					_wait_for_job(pause);
+
+					// a politeness pause (--wait, Crawl-delay) doesn't mean there are too many downloaders
+					if (!pause)
+						pool.idle_ms += wget_get_timemillis() - start;
+					break;
 				}
-				break;
 			}
 
 			wget_thread_mutex_unlock(&main_mutex); locked = 0;
 
 			{
 				wget_iri_t *iri = job->iri;
+				CACHE_ENTRY *cache_entry = NULL; // stored response to be revalidated
 				downloader->job = job;
 				job->downloader = downloader;
 
+				// a fresh response from the HTTP cache doesn't need a connection
+				if (config.cache_dir && (resp = http_get_cached_response(downloader, &cache_entry))) {
+					add_statistics(resp);
+					process_response(resp);
+
+					wget_http_free_request(&resp->req);
+					wget_http_free_response(&resp);
+
+					wget_thread_mutex_lock(&main_mutex); locked = 1;
+
+					if (job->inuse)
+						host_remove_job(job->host, job);
+
+					pool.completed++;
+					wget_thread_cond_signal(&main_cond);
+					break;
+				}
+
 				if (++pending == 1) {
 					host = job->host;
 
-					if (establish_connection(downloader, &iri)) {
-						host_increase_failure(host);
+					if ((rc = establish_connection(downloader, &iri))) {
+						cache_entry_free(&cache_entry);
+						host_increase_failure(host, _host_error(rc));
 						action = ACTION_ERROR;
 						break;
 					}
 
 					job->iri = iri;
 
-					if (config.wait || job->metalink || !downloader->conn || downloader->conn->protocol != WGET_PROTOCOL_HTTP_2_0)
+					// with --wait or Crawl-delay the requests are spaced by host_get_job()
+					if (job->metalink || !downloader->conn || downloader->conn->protocol != WGET_PROTOCOL_HTTP_2_0) {
+						http2.start = 0;
 						max_pending = 1;
-					else
-						max_pending = config.http2_request_window;
-				}
-
-				// wait between sending requests
-				if (config.wait) {
-					if (config.random_wait)
-						wget_millisleep(rand() % config.wait + config.wait / 2); // (0.5 - 1.5) * config.wait
-					else
-						wget_millisleep(config.wait);
-
-					if (terminate)
-						break;
+					} else {
+						// the measurements belong to the connection, not to a burst of requests
+						if (downloader->new_connection || !http2.start)
+							http2 = (_http2_window_t) { .start = wget_get_timemillis() };
+						max_pending = _http2_request_window(downloader->conn, &http2);
+					}
 				}
 
-				if (http_send_request(job->iri, downloader)) {
-					host_increase_failure(host);
+				if ((rc = http_send_request(job->iri, downloader, &cache_entry))) {
+					host_increase_failure(host, _host_error(rc));
 					action = ACTION_ERROR;
 					break;
 				}
 
+				job->request_ts = wget_get_timemillis();
+
 				if (pending >= max_pending) {
 					action = ACTION_GET_RESPONSE;
 				} else {
@@ -1709,17 +2219,25 @@ void *downloader_thread(void *p)
 			break;
 
 		case ACTION_GET_RESPONSE:
-			resp = http_receive_response(downloader->conn);
+			resp = http_receive_response(downloader);
 			if (!resp) {
 				// likely that the other side closed the connection, try again
-				host_increase_failure(host);
+				host_increase_failure(host, _host_error(wget_tcp_get_error(downloader->conn->tcp)));
 				action = ACTION_ERROR;
 				break;
 			}
 
+			job = resp->req->user_data;
+
+			latency = job ? wget_get_timemillis() - job->request_ts : 0;
+
 			host_reset_failure(host);
 
-			job = resp->req->user_data;
+			// the peer's SETTINGS have been processed by now, and there is a new measurement
+			if (http2.start) {
+				_http2_response(&http2, latency, pending);
+				max_pending = _http2_request_window(downloader->conn, &http2);
+			}
 
 			// general response check to see if we need further processing
 			if (process_response_header(resp) == 0) {
@@ -1742,15 +2260,25 @@ void *downloader_thread(void *p)
 				host_remove_job(host, job);
 			}
 
+			pool.completed++;
+			pool.latency_ms += latency;
+
 			wget_thread_cond_signal(&main_cond);
 
 			pending--;
 			action = ACTION_GET_JOB;
 
+			// the requests still in flight over a connection that misdirected our host would fail the same way
+			if (pending && host->misdirected && downloader->conn && !_is_own_connection(downloader->conn, host)) {
+				wget_thread_mutex_unlock(&main_mutex); locked = 0;
+				action = ACTION_ERROR;
+			}
+
 			break;
 
 		case ACTION_ERROR:
 			wget_http_close(&downloader->conn);
+			http_abort_responses(downloader);
 
 			wget_thread_mutex_lock(&main_mutex); locked = 1;
 			host_release_jobs(host);
@@ -1772,6 +2300,8 @@ out:
 	if (locked)
 		wget_thread_mutex_unlock(&main_mutex);
 	wget_http_close(&downloader->conn);
+	http_abort_responses(downloader);
+	wget_vector_free(&downloader->responses);
 
 	// if we terminate, tell the other downloaders
 	wget_thread_cond_signal(&worker_cond);
@@ -1779,11 +2309,18 @@ out:
 	return NULL;
 }
 
+// the parsed URLs are kept until the end with --convert-links
+static inline size_t _parsed_size(const WGET_HTML_PARSED_RESULT *parsed)
+{
+	return sizeof(WGET_HTML_PARSED_RESULT) + wget_vector_size(parsed->uris) * sizeof(WGET_HTML_PARSED_URL);
+}
+
 static void _free_conversion_entry(_conversion_t *conversion)
 {
 	xfree(conversion->filename);
 	xfree(conversion->encoding);
 	wget_iri_free(&conversion->base_url);
+	memstats_free(WGET_MEMTAG_PARSERS, _parsed_size(conversion->parsed));
 	wget_html_free_urls_inline(&conversion->parsed);
 }
 
@@ -1821,6 +2358,30 @@ static unsigned int G_GNUC_WGET_PURE hash_url(const char *url)
 	return hash;
 }
 
+static void _free_known_url(char *url)
+{
+	memstats_free(WGET_MEMTAG_KNOWN_URLS, strlen(url) + 1);
+	xfree(url);
+}
+
+// Blacklist for URLs before they are processed, the caller holds known_urls_mutex.
+// Returns the 0-terminated copy of the new URL (kept until the end), NULL if it is known already.
+static const char *_add_known_url(const char *url, size_t len)
+{
+	char *p = wget_strmemdup(url, len);
+
+	// known keys are never replaced, the returned copies stay valid
+	if (wget_hashmap_contains(known_urls, p)) {
+		xfree(p);
+		return NULL;
+	}
+
+	wget_hashmap_put_noalloc(known_urls, p, NULL);
+	memstats_alloc(WGET_MEMTAG_KNOWN_URLS, len + 1);
+
+	return p;
+}
+
 /*
  * helper function: percent-unescape, convert to utf-8, create URL string using base
  */
@@ -1922,6 +2483,7 @@ void html_parse(JOB *job, int level, const char *html, size_t html_len, const ch
 	}
 
 	WGET_HTML_PARSED_RESULT *parsed  = wget_html_get_urls_inline(html, config.follow_tags, config.ignore_tags);
+	memstats_alloc(WGET_MEMTAG_PARSERS, _parsed_size(parsed));
 
 	if (config.robots && !parsed->follow)
 		goto cleanup;
@@ -1987,8 +2549,7 @@ void html_parse(JOB *job, int level, const char *html, size_t html_len, const ch
 		if (!base && !buf.length)
 			info_printf(_("URL '%.*s' not followed (missing base URI)\n"), (int)url->len, url->p);
 		else {
-			// Blacklist for URLs before they are processed
-			if (wget_hashmap_put_noalloc(known_urls, wget_strmemdup(buf.data, buf.length), NULL) == 0)
+			if (_add_known_url(buf.data, buf.length))
 				add_url(job, "utf-8", buf.data, 0);
 		}
 	}
@@ -2008,6 +2569,8 @@ void html_parse(JOB *job, int level, const char *html, size_t html_len, const ch
 	wget_iri_free(&allocated_base);
 
 cleanup:
+	if (parsed)
+		memstats_free(WGET_MEMTAG_PARSERS, _parsed_size(parsed));
 	wget_html_free_urls_inline(&parsed);
 	xfree(utf8);
 }
@@ -2030,7 +2593,8 @@ void sitemap_parse_xml(JOB *job, const char *data, const char *encoding, wget_ir
 	const char *p;
 	size_t baselen = 0;
 
-	wget_sitemap_get_urls_inline(data, &urls, &sitemap_urls);
+	wget_sitemap_get_entries_inline(data, &urls, &sitemap_urls);
+	memstats_alloc(WGET_MEMTAG_PARSERS, (wget_vector_size(urls) + wget_vector_size(sitemap_urls)) * sizeof(wget_sitemap_url_t));
 
 	if (base) {
 		if ((p = strrchr(base->uri, '/')))
@@ -2043,7 +2607,8 @@ void sitemap_parse_xml(JOB *job, const char *data, const char *encoding, wget_ir
 	info_printf(_("found %d url(s) (base=%s)\n"), wget_vector_size(urls), base ? base->uri : NULL);
 	wget_thread_mutex_lock(&known_urls_mutex);
 	for (int it = 0; it < wget_vector_size(urls); it++) {
-		wget_string_t *url = wget_vector_get(urls, it);;
+		wget_sitemap_url_t *entry = wget_vector_get(urls, it);
+		wget_string_t *url = &entry->url;
 
 		// A Sitemap file located at https://example.com/catalog/sitemap.xml can include any URLs starting with https://example.com/catalog/
 		// but not any other.
@@ -2052,58 +2617,74 @@ void sitemap_parse_xml(JOB *job, const char *data, const char *encoding, wget_ir
 			continue;
 		}
 
-		// Blacklist for URLs before they are processed
-		if (wget_hashmap_put_noalloc(known_urls, (p = wget_strmemdup(url->p, url->len)), NULL)) {
-			// the dup'ed url has already been freed when we come here
+		if (!(p = _add_known_url(url->p, url->len))) {
 			info_printf(_("URL '%.*s' not followed (already known)\n"), (int)url->len, url->p);
 			continue;
 		}
 
-		add_url(job, encoding, p, 0);
+		_add_url(job, encoding, p, 0, entry->lastmod);
 	}
+	wget_thread_mutex_unlock(&known_urls_mutex);
 
 	// process the sitemap index urls here
+	// known_urls_mutex is not held while adding, an up-to-date nested sitemap is parsed from its local copy right away
 	info_printf(_("found %d sitemap url(s) (base=%s)\n"), wget_vector_size(sitemap_urls), base ? base->uri : NULL);
 	for (int it = 0; it < wget_vector_size(sitemap_urls); it++) {
-		wget_string_t *url = wget_vector_get(sitemap_urls, it);;
+		wget_sitemap_url_t *entry = wget_vector_get(sitemap_urls, it);
+		wget_string_t *url = &entry->url;
 
 		// TODO: url must have same scheme, port and host as base
 
-		// Blacklist for URLs before they are processed
-		if (wget_hashmap_put_noalloc(known_urls, (p = wget_strmemdup(url->p, url->len)), NULL)) {
-			// the dup'ed url has already been freed when we come here
+		wget_thread_mutex_lock(&known_urls_mutex);
+		p = _add_known_url(url->p, url->len);
+		wget_thread_mutex_unlock(&known_urls_mutex);
+
+		if (!p) {
 			info_printf(_("URL '%.*s' not followed (already known)\n"), (int)url->len, url->p);
 			continue;
 		}
 
-		add_url(job, encoding, p, URL_FLG_SITEMAP);
+		_add_url(job, encoding, p, URL_FLG_SITEMAP, entry->lastmod);
 	}
-	wget_thread_mutex_unlock(&known_urls_mutex);
 
+	memstats_free(WGET_MEMTAG_PARSERS, (wget_vector_size(urls) + wget_vector_size(sitemap_urls)) * sizeof(wget_sitemap_url_t));
 	wget_vector_free(&urls);
 	wget_vector_free(&sitemap_urls);
 	// wget_sitemap_free_urls_inline(&res);
 }
 
-static int _get_unzipped(void *userdata, const char *data, size_t length)
+// the gzip trailer has the uncompressed size (modulo 4GB), 0 if it doesn't look like one
+static size_t _gzip_size(const wget_buffer_t *data)
 {
-	wget_buffer_memcat((wget_buffer_t *)userdata, data, length);
+	if (data->length >= 18) {
+		const unsigned char *isize = (unsigned char *) data->data + data->length - 4;
+		size_t n = isize[0] | (isize[1] << 8) | (isize[2] << 16) | ((size_t) isize[3] << 24);
+
+		if (n >= data->length && n <= data->length * 1032)
+			return n;
+	}
 
 	return 0;
 }
 
 void sitemap_parse_xml_gz(JOB *job, wget_buffer_t *gzipped_data, const char *encoding, wget_iri_t *base)
 {
-	wget_buffer_t *plain = wget_buffer_alloc(gzipped_data->length * 10);
-	wget_decompressor_t *dc = NULL;
+	size_t size = _gzip_size(gzipped_data);
+	wget_buffer_t *plain;
 
-	if ((dc = wget_decompress_open(wget_content_encoding_gzip, _get_unzipped, plain))) {
-		wget_decompress(dc, gzipped_data->data, gzipped_data->length);
-		wget_decompress_close(dc);
+	// the whole body is in memory, so decompress it in one go
+	plain = wget_buffer_alloc(size ? size : gzipped_data->length * 10);
 
+	// on errors (reported by libwget), parse what could be decompressed
+	if (wget_decompress_buffer(wget_content_encoding_gzip, gzipped_data->data, gzipped_data->length, plain) == 0 || plain->length)
 		sitemap_parse_xml(job, plain->data, encoding, base);
-	} else
-		error_printf("Can't scan '%s' because no libz support enabled at compile time\n", job->iri->uri);
+	else {
+#ifdef WITH_ZLIB
+		error_printf(_("Failed to decompress sitemap '%s'\n"), job->iri->uri);
+#else
+		error_printf(_("Can't scan '%s' because no libz support enabled at compile time\n"), job->iri->uri);
+#endif
+	}
 
 	wget_buffer_free(&plain);
 }
@@ -2118,6 +2699,33 @@ void sitemap_parse_xml_localfile(JOB *job, const char *fname, const char *encodi
 	xfree(data);
 }
 
+// parse a sitemap saved by an earlier run, which may be XML, gzipped XML or text
+void sitemap_parse_localcopy(JOB *job, const char *fname, const char *encoding, wget_iri_t *base)
+{
+	size_t length;
+	char *data;
+
+	if (!(data = wget_read_file(fname, &length)))
+		return;
+
+	if (length >= 2 && (unsigned char) data[0] == 0x1f && (unsigned char) data[1] == 0x8b) {
+		wget_buffer_t buf = { .data = data, .length = length, .size = length };
+
+		sitemap_parse_xml_gz(job, &buf, encoding, base);
+	} else {
+		const char *p;
+
+		for (p = data; c_isspace(*p); p++);
+
+		if (*p == '<')
+			sitemap_parse_xml(job, data, encoding, base);
+		else
+			sitemap_parse_text(job, data, encoding, base);
+	}
+
+	xfree(data);
+}
+
 void sitemap_parse_text(JOB *job, const char *data, const char *encoding, wget_iri_t *base)
 {
 	size_t baselen = 0;
@@ -2182,9 +2790,7 @@ static void _add_urls(JOB *job, wget_vector_t *urls, const char *encoding, wget_
 			continue;
 		}
 
-		// Blacklist for URLs before they are processed
-		if (wget_hashmap_put_noalloc(known_urls, (p = wget_strmemdup(url->p, url->len)), NULL)) {
-			// the dup'ed url has already been freed when we come here
+		if (!(p = _add_known_url(url->p, url->len))) {
 			info_printf(_("URL '%.*s' not followed (already known)\n"), (int)url->len, url->p);
 			continue;
 		}
@@ -2397,7 +3003,7 @@ int futimens(int fd, const struct timespec times[2])
 }
 #endif
 
-static void set_file_mtime(int fd, time_t modified)
+void set_file_mtime(int fd, time_t modified)
 {
 	struct timespec timespecs[2]; // [0]=last access  [1]=last modified
 
@@ -2410,7 +3016,44 @@ static void set_file_mtime(int fd, time_t modified)
 		error_printf (_("Failed to set file date: %s\n"), strerror (errno));
 }
 
-static int G_GNUC_WGET_NONNULL((1)) _prepare_file(wget_http_response_t *resp, const char *fname, int flag)
+// --compress-output: name of the compressed file for 'fname', NULL if 'fname' is a gzip file already
+static char *_compressed_filename(const char *fname)
+{
+	if (wget_match_tail_nocase(fname, ".gz") || wget_match_tail_nocase(fname, ".tgz"))
+		return NULL;
+
+	// the name given with -O is kept
+	if (fname == config.output_document)
+		return wget_strdup(fname);
+
+	return wget_aprintf("%s.gz", fname);
+}
+
+// --compress-output: the plain text of a local copy that has been saved compressed, NULL if there is none
+static char *_read_compressed_copy(const char *fname, size_t *length)
+{
+	char *compressed_fname, *data = NULL;
+
+	if (config.compress_output && (compressed_fname = _compressed_filename(fname))) {
+		data = compress_read_file(compressed_fname, length);
+		xfree(compressed_fname);
+	}
+
+	return data;
+}
+
+// --compress-output: gzip data is saved as it is instead of being compressed twice
+static int _is_gzip_body(wget_http_response_t *resp, const char *fname)
+{
+	if (wget_match_tail_nocase(fname, ".gz") || wget_match_tail_nocase(fname, ".tgz"))
+		return 1;
+
+	return resp->content_type
+		&& (!wget_strcasecmp_ascii(resp->content_type, "application/gzip")
+			|| !wget_strcasecmp_ascii(resp->content_type, "application/x-gzip"));
+}
+
+static int G_GNUC_WGET_NONNULL((1)) _prepare_file(wget_http_response_t *resp, const char *fname, int flag, COMPRESSED_FILE **compressor)
 {
 	static wget_thread_mutex_t
 		savefile_mutex = WGET_THREAD_MUTEX_INITIALIZER;
@@ -2518,6 +3161,15 @@ static int G_GNUC_WGET_NONNULL((1)) _prepare_file(wget_http_response_t *resp, co
 		return -2;
 	}
 
+	// --compress-output: the name given with -O is kept
+	if (compressor && fname != config.output_document) {
+		char *compressed_fname = wget_aprintf("%s.gz", fname);
+
+		xfree(alloced_fname);
+		fname = alloced_fname = compressed_fname;
+		fname_length += 3;
+	}
+
 	wget_thread_mutex_lock(&savefile_mutex);
 
 	fname_length += 16;
@@ -2566,9 +3218,15 @@ static int G_GNUC_WGET_NONNULL((1)) _prepare_file(wget_http_response_t *resp, co
 		ssize_t rc;
 
 		info_printf(_("Saving '%s'\n"), fnum ? unique : fname);
+		WGET_PROBE2(file_open, fnum ? unique : fname, fd);
+
+		if (compressor)
+			*compressor = compress_open(fd, fnum ? unique : fname);
 
 		if (config.save_headers) {
-			if ((rc = write(fd, resp->header->data, resp->header->length)) != (ssize_t)resp->header->length) {
+			if (compressor)
+				compress_write(*compressor, resp->header->data, resp->header->length);
+			else if ((rc = write(fd, resp->header->data, resp->header->length)) != (ssize_t)resp->header->length) {
 				error_printf(_("Failed to write file %s (%zd, errno=%d)\n"), fnum ? unique : fname, rc, errno);
 				set_exit_status(3);
 			}
@@ -2596,12 +3254,91 @@ static int G_GNUC_WGET_NONNULL((1)) _prepare_file(wget_http_response_t *resp, co
 struct _body_callback_context {
 	JOB *job;
 	wget_buffer_t *body;
+	WARC_RECORD *warc; // response record
+	char *warc_request_id;
+	CACHE_ENTRY *cache_entry; // stored response to be revalidated
+	time_t request_time;
 	uint64_t max_memory;
 	uint64_t length;
 	int outfd;
 	int progress_slot;
+	bool cacheable;
+	bool from_cache;
+	bool keep_encoding; // body is saved as received, without decompression
+	bool decompress_body; // encoded body is kept and decompressed in one go when complete
+	COMPRESSED_FILE *compressor; // --compress-output
 };
 
+// whether process_response() will look into the body of a 200 response
+static int _is_parsed(JOB *job, wget_http_response_t *resp)
+{
+	if (job->sitemap || job->robotstxt)
+		return 1;
+
+	if (!resp->content_type)
+		return 0;
+
+	if (config.metalink
+		&& (!wget_strcasecmp_ascii(resp->content_type, "application/metalink4+xml")
+			|| !wget_strcasecmp_ascii(resp->content_type, "application/metalink+xml")))
+		return 1;
+
+	if (config.recursive && (!config.level || job->level < config.level + config.page_requisites)) {
+		static const char *parsed_types[] = {
+			"text/html", "application/xhtml+xml", "text/css", "application/atom+xml", "application/rss+xml"
+		};
+
+		for (unsigned it = 0; it < countof(parsed_types); it++) {
+			if (!wget_strcasecmp_ascii(resp->content_type, parsed_types[it]))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+// file name suffix for a body saved with its Content-Encoding
+static const char *_encoding_suffix(char content_encoding)
+{
+	switch (content_encoding) {
+	case wget_content_encoding_gzip: return ".gz";
+	case wget_content_encoding_deflate: return ".zz";
+	case wget_content_encoding_bzip2: return ".bz2";
+	case wget_content_encoding_lzma: return ".xz";
+	case wget_content_encoding_brotli: return ".br";
+	default: return NULL;
+	}
+}
+
+// --page-requisites: request the preloads announced by Link headers while the body is still underway
+static void _add_preloads(JOB *job, wget_vector_t *links)
+{
+	wget_iri_t *iri = job->iri;
+	wget_buffer_t buf;
+	char sbuf[1024];
+
+	wget_buffer_init(&buf, sbuf, sizeof(sbuf));
+
+	wget_thread_mutex_lock(&known_urls_mutex);
+	for (int it = 0; it < wget_vector_size(links); it++) {
+		wget_http_link_t *link = wget_vector_get(links, it);
+		wget_string_t url = { link->uri, strlen(link->uri) };
+
+		if (link->rel != link_rel_preload || _normalize_uri(job->iri, &url, "utf-8", &buf))
+			continue;
+
+		// the document's own link to it is not followed again
+		if (_add_known_url(buf.data, buf.length)) {
+			debug_printf("preload %s\n", buf.data);
+			add_url(job, "utf-8", buf.data, 0);
+			job->iri = iri; // add_url() hands the IRI on as referer, but this job is still underway
+		}
+	}
+	wget_thread_mutex_unlock(&known_urls_mutex);
+
+	wget_buffer_deinit(&buf);
+}
+
 static int _get_header(wget_http_response_t *resp, void *context)
 {
 	struct _body_callback_context *ctx = (struct _body_callback_context *)context;
@@ -2609,6 +3346,16 @@ static int _get_header(wget_http_response_t *resp, void *context)
 	const char *dest = NULL, *name;
 	int ret = 0;
 
+	if (resp->links && (resp->code / 100 == 1 || resp->code / 100 == 2) && config.recursive && config.page_requisites
+		&& (!config.level || ctx->job->level < config.level + config.page_requisites))
+	{
+		_add_preloads(ctx->job, resp->links);
+	}
+
+	// an interim response (e.g. 103 Early Hints) has no body, the final response follows
+	if (resp->code / 100 == 1)
+		return 0;
+
 	bool metalink = resp->content_type
 	    && (!wget_strcasecmp_ascii(resp->content_type, "application/metalink4+xml") ||
 		!wget_strcasecmp_ascii(resp->content_type, "application/metalink+xml"));
@@ -2635,13 +3382,76 @@ static int _get_header(wget_http_response_t *resp, void *context)
 	else
 		name = dest = config.output_document ? config.output_document : ctx->job->local_filename;
 
+	// --no-decompress: write bodies through unchanged if nothing needs the plain text
+	if (dest && !config.decompress && resp->code == 200 && !config.continue_download
+		&& _encoding_suffix(resp->content_encoding) && !_is_parsed(ctx->job, resp))
+	{
+		const char *suffix = _encoding_suffix(resp->content_encoding);
+		size_t len = strlen(dest), suffix_len = strlen(suffix);
+
+		wget_http_request_set_int(resp->req, WGET_HTTP_RESPONSE_KEEP_ENCODING, 1);
+		ctx->keep_encoding = 1;
+
+		// the job refers to the file by the name it is saved with, e.g. for -N and -k
+		if (dest != config.output_document && (len < suffix_len || wget_strcasecmp_ascii(dest + len - suffix_len, suffix))) {
+			char *encoded_name = wget_aprintf("%s%s", dest, suffix);
+
+			xfree(ctx->job->local_filename);
+			name = dest = ctx->job->local_filename = encoded_name;
+		}
+	}
+
+	// a parsed body is needed in memory anyway: receive it encoded and decompress it in one go at the end,
+	// instead of many small decompressor calls while receiving (unknown or large sizes are streamed)
+	if (dest && !ctx->keep_encoding && !ctx->job->part && resp->code == 200
+		&& resp->content_encoding != wget_content_encoding_identity
+		&& resp->content_length_valid && resp->content_length < ctx->max_memory && _is_parsed(ctx->job, resp))
+	{
+		wget_http_request_set_int(resp->req, WGET_HTTP_RESPONSE_KEEP_ENCODING, 1);
+		ctx->decompress_body = 1;
+	}
+
 	if (dest && (resp->code == 200 || resp->code == 206 || config.content_on_error)) {
-		ctx->outfd = _prepare_file (resp, dest, resp->code == 206 ? O_APPEND : O_TRUNC);
+		// bodies kept encoded are compressed already, as are gzip files
+		bool compress = config.compress_output && !ctx->keep_encoding && !_is_gzip_body(resp, dest);
+
+		// --continue: append to the complete members of a file written by --compress-output,
+		// else the range has been requested for the plain file
+		if (compress && resp->code == 206) {
+			char *compressed_fname = _compressed_filename(dest);
+
+			compress = compressed_fname && compress_resume(compressed_fname) >= 0;
+			xfree(compressed_fname);
+		}
+
+		ctx->outfd = _prepare_file (resp, dest, resp->code == 206 ? O_APPEND : O_TRUNC, compress ? &ctx->compressor : NULL);
 		if (ctx->outfd == -1)
 			ret = -1;
+
+		// a parsed body is kept completely, its plain text is not on disk to be read back
+		if (ctx->compressor && _is_parsed(ctx->job, resp))
+			ctx->max_memory = 0;
 	}
 //	info_printf("Opened %d\n", ctx->outfd);
 
+	if (config.warc_file && !ctx->from_cache) {
+		ctx->warc = warc_record_create("response", ctx->job->iri->uri, ctx->warc_request_id);
+		warc_record_append_response_header(ctx->warc, resp);
+	}
+
+	// reserve the body memory at once instead of growing it while receiving
+	if (!ctx->job->head_first && resp->content_length_valid) {
+		size_t size = ctx->body->size;
+
+		if (ctx->job->part)
+			wget_buffer_ensure_capacity(ctx->body, (size_t) ctx->job->part->length);
+		else if (resp->content_length < ctx->max_memory)
+			wget_buffer_ensure_capacity(ctx->body, resp->content_length);
+
+		if (ctx->body->size != size)
+			memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, ctx->body->size - size);
+	}
+
 out:
 	if (config.progress)
 		bar_slot_begin(ctx->progress_slot, name, resp->content_length);
@@ -2649,19 +3459,12 @@ out:
 	return ret;
 }
 
-static int _get_body(wget_http_response_t *resp, void *context, const char *data, size_t length)
+// write (a piece of) the body to the output file
+static int _write_body(struct _body_callback_context *ctx, const char *data, size_t length)
 {
-	struct _body_callback_context *ctx = (struct _body_callback_context *)context;
-
-	if (ctx->length == 0) {
-		// first call to _get_body
-		if (config.server_response)
-			info_printf("# got header %zu bytes:\n%s\n", resp->header->length, resp->header->data);
-	}
-
-	ctx->length += length;
-
-	if (ctx->outfd >= 0) {
+	if (ctx->compressor)
+		compress_write(ctx->compressor, data, length);
+	else if (ctx->outfd >= 0) {
 		size_t written = safe_write(ctx->outfd, data, length);
 
 		if (written == SAFE_WRITE_ERROR) {
@@ -2684,16 +3487,60 @@ static int _get_body(wget_http_response_t *resp, void *context, const char *data
 		}
 	}
 
-	if (ctx->max_memory == 0 || ctx->length < ctx->max_memory)
+	return 0;
+}
+
+static int _get_body(wget_http_response_t *resp, void *context, const char *data, size_t length)
+{
+	struct _body_callback_context *ctx = (struct _body_callback_context *)context;
+
+	if (ctx->length == 0) {
+		// first call to _get_body
+		if (config.server_response)
+			info_printf("# got header %zu bytes:\n%s\n", resp->header->length, resp->header->data);
+	}
+
+	ctx->length += length;
+
+	// an encoded body is written by _decompress_body() when complete
+	if (!ctx->decompress_body && _write_body(ctx, data, length))
+		return -1;
+
+	if (ctx->max_memory == 0 || ctx->length < ctx->max_memory) {
+		size_t size = ctx->body->size;
+
 		wget_buffer_memcat(ctx->body, data, length); // append new data to body
 
+		if (ctx->body->size != size)
+			memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, ctx->body->size - size);
+	}
+
 	if (config.progress)
 		bar_set_downloaded(ctx->progress_slot, resp->cur_downloaded);
 
 	return 0;
 }
 
-static wget_http_request_t *http_create_request(wget_iri_t *iri, JOB *job)
+// --warc-file: the body as received, before de-chunking and decompression
+static int _get_raw_body(wget_http_response_t *resp G_GNUC_WGET_UNUSED, void *context, const char *data, size_t length)
+{
+	struct _body_callback_context *ctx = (struct _body_callback_context *)context;
+
+	if (ctx->warc)
+		warc_record_append(ctx->warc, data, length);
+
+	return 0;
+}
+
+static bool _is_cacheable(const JOB *job)
+{
+	return config.cache_dir && !job->head_first && !job->part && !job->metalink
+		&& !config.post_data && !config.post_file && !config.continue_download;
+}
+
+// With 'cache_entry' set, the HTTP cache is consulted unless '*cache_entry' already holds
+// the stored response for 'iri'. The entry is then revalidated by the request.
+static wget_http_request_t *http_create_request(wget_iri_t *iri, JOB *job, CACHE_ENTRY **cache_entry)
 {
 	wget_http_request_t *req;
 	wget_buffer_t buf;
@@ -2716,14 +3563,32 @@ static wget_http_request_t *http_create_request(wget_iri_t *iri, JOB *job)
 
 	if (config.continue_download || config.timestamping) {
 		const char *local_filename = config.output_document ? config.output_document : job->local_filename;
+		char *compressed_fname = NULL;
+		long long offset = -1;
+
+		// --compress-output: continue behind the complete gzip members of a file written before,
+		// the file is cut back when the data arrives
+		if (config.compress_output && local_filename && (compressed_fname = _compressed_filename(local_filename))) {
+			if ((offset = compress_resume_offset(compressed_fname)) >= 0)
+				local_filename = compressed_fname;
+		}
 
 		if (config.continue_download)
-			wget_http_add_header_printf(req, "Range", "bytes=%lld-",
-				get_file_size(local_filename));
+			wget_http_add_header_printf(req, "Range", "bytes=%lld-", offset >= 0 ? offset : get_file_size(local_filename));
 
 		if (config.timestamping) {
 			time_t mtime = get_file_mtime(local_filename);
 
+			// --no-decompress: the file might have been saved with the suffix of its Content-Encoding
+			if (!mtime && !config.decompress && local_filename && local_filename != config.output_document) {
+				for (char encoding = wget_content_encoding_gzip; !mtime && _encoding_suffix(encoding); encoding++) {
+					char *encoded_name = wget_aprintf("%s%s", local_filename, _encoding_suffix(encoding));
+
+					mtime = get_file_mtime(encoded_name);
+					xfree(encoded_name);
+				}
+			}
+
 			if (mtime) {
 				char http_date[32];
 
@@ -2732,6 +3597,7 @@ static wget_http_request_t *http_create_request(wget_iri_t *iri, JOB *job)
 			}
 		}
 
+		xfree(compressed_fname);
 	}
 
 	// 20.06.2012: www.google.de only sends gzip responses with one of the
@@ -2886,6 +3752,10 @@ static wget_http_request_t *http_create_request(wget_iri_t *iri, JOB *job)
 		}
 	}
 
+	// a stored response is revalidated with If-None-Match / If-Modified-Since (RFC 9111 4.3.1)
+	if (cache_entry && (*cache_entry || (*cache_entry = cache_lookup(iri, req))))
+		cache_entry_add_validators(*cache_entry, req);
+
 	if (config.post_data) {
 		size_t length = strlen(config.post_data);
 
@@ -2906,7 +3776,8 @@ static wget_http_request_t *http_create_request(wget_iri_t *iri, JOB *job)
 	return req;
 }
 
-int http_send_request(wget_iri_t *iri, DOWNLOADER *downloader)
+// '*cache_entry' is a stored response for 'iri' looked up before, it is taken over
+int http_send_request(wget_iri_t *iri, DOWNLOADER *downloader, CACHE_ENTRY **cache_entry)
 {
 	wget_http_connection_t *conn = downloader->conn;
 	JOB *job = downloader->job;
@@ -2928,14 +3799,24 @@ int http_send_request(wget_iri_t *iri, DOWNLOADER *downloader)
 			print_status(downloader, "[%d] Downloading '%s' ...\n", downloader->id, iri->uri);
 	}
 
-	wget_http_request_t *req = http_create_request(iri, downloader->job);
+	CACHE_ENTRY *entry = *cache_entry;
+	bool cacheable = _is_cacheable(job);
+	wget_http_request_t *req;
+	time_t request_time = time(NULL);
+
+	*cache_entry = NULL;
+	if (!cacheable)
+		cache_entry_free(&entry);
 
-	if (!req)
+	if (!(req = http_create_request(iri, downloader->job, cacheable ? &entry : NULL))) {
+		cache_entry_free(&entry);
 		return WGET_E_UNKNOWN;
+	}
 
 	wget_http_request_set_ptr(req, WGET_HTTP_USER_DATA, downloader->job);
 
 	if ((rc = wget_http_send_request(conn, req))) {
+		cache_entry_free(&entry);
 		wget_http_free_request(&req);
 		return rc;
 	}
@@ -2943,9 +3824,13 @@ int http_send_request(wget_iri_t *iri, DOWNLOADER *downloader)
 	struct _body_callback_context *context = wget_calloc(1, sizeof(struct _body_callback_context));
 
 	context->job = downloader->job;
+	context->cacheable = cacheable;
+	context->cache_entry = entry;
+	context->request_time = request_time;
 	context->max_memory = downloader->job->part ? 0 : ((uint64_t) 10) * (1 << 20);
 	context->outfd = -1;
 	context->body = wget_buffer_alloc(102400);
+	memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, context->body->size);
 	context->length = 0;
 	context->progress_slot = downloader->id;
 
@@ -2954,22 +3839,64 @@ int http_send_request(wget_iri_t *iri, DOWNLOADER *downloader)
 	wget_http_request_set_body_cb(req, _get_body, context);
 
 	// keep the received response header in 'resp->header'
-	wget_http_request_set_int(req, WGET_HTTP_RESPONSE_KEEPHEADER, config.save_headers || config.server_response);
+	wget_http_request_set_int(req, WGET_HTTP_RESPONSE_KEEPHEADER,
+		config.save_headers || config.server_response || config.warc_file || cacheable || config.redirect_db);
+
+	// decompressed data is written to the file in pieces of this size
+	wget_http_request_set_int(req, WGET_HTTP_DECOMPRESS_BUFFER_SIZE, DECOMPRESS_BUFFER_SIZE);
+
+	if (!downloader->responses)
+		downloader->responses = wget_vector_create(4, -2, NULL);
+	wget_vector_add_noalloc(downloader->responses, context);
+
+	if (config.warc_file) {
+		WARC_RECORD *record = warc_record_create("request", iri->uri, NULL);
+
+		wget_http_request_set_raw_body_cb(req, _get_raw_body, context);
+
+		warc_record_append_request(record, req, conn);
+
+		context->warc_request_id = wget_strdup(warc_record_get_id(record));
+		warc_record_write(record);
+	}
 
 	return WGET_E_SUCCESS;
 }
 
-wget_http_response_t *http_receive_response(wget_http_connection_t *conn)
+// replace the encoded body by its plain text and write that
+static void _decompress_body(wget_http_response_t *resp, struct _body_callback_context *ctx)
 {
-	wget_http_response_t *resp = wget_http_get_response_cb(conn);
+	wget_buffer_t *encoded = ctx->body;
+	size_t size = resp->content_encoding == wget_content_encoding_gzip ? _gzip_size(encoded) : 0;
 
-	if (!resp)
-		return NULL;
+	ctx->body = wget_buffer_alloc(size ? size : encoded->length * 4);
 
-	struct _body_callback_context *context = resp->req->body_user_data;
+	// on errors (reported by libwget), keep what could be decompressed
+	wget_decompress_buffer(resp->content_encoding, encoded->data, encoded->length, ctx->body);
+	debug_printf("decompressed %zu bytes of %s into %zu\n", encoded->length, ctx->job->iri->uri, ctx->body->length);
+	memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, ctx->body->size);
+	memstats_free(WGET_MEMTAG_HTTP_BUFFERS, encoded->size);
+	wget_buffer_free(&encoded);
+
+	ctx->decompress_body = 0;
+	ctx->length = ctx->body->length;
+
+	_write_body(ctx, ctx->body->data, ctx->body->length);
+}
+
+static void _finish_response(wget_http_response_t *resp, struct _body_callback_context *context)
+{
+	if (context->decompress_body)
+		_decompress_body(resp, context);
 
 	resp->body = context->body;
 
+	// errors have been reported while writing, the file is closed when the last member is written
+	if (context->compressor) {
+		compress_close(&context->compressor, resp->last_modified);
+		context->outfd = -1;
+	}
+
 	if (context->outfd >= 0) {
 		if (resp->last_modified)
 			set_file_mtime(context->outfd, resp->last_modified);
@@ -2981,6 +3908,7 @@ wget_http_response_t *http_receive_response(wget_http_connection_t *conn)
 			}
 		}
 
+		WGET_PROBE1(file_close, context->outfd);
 		close(context->outfd);
 		context->outfd = -1;
 	}
@@ -2988,7 +3916,152 @@ wget_http_response_t *http_receive_response(wget_http_connection_t *conn)
 	if (config.progress)
 		bar_slot_deregister(context->progress_slot);
 
+	if (context->warc)
+		warc_record_write(context->warc);
+	xfree(context->warc_request_id);
+}
+
+// write a stored response as if it had just been received
+static void _deliver_cached_response(wget_http_response_t *resp, const CACHE_ENTRY *entry, int progress_slot)
+{
+	struct _body_callback_context context = {
+		.job = resp->req->user_data,
+		.outfd = -1,
+		.progress_slot = progress_slot,
+		.from_cache = 1
+	};
+	size_t length;
+	const char *body = cache_entry_get_body(entry, &length);
+
+	context.body = wget_buffer_alloc(length + 1);
+	memstats_alloc(WGET_MEMTAG_HTTP_BUFFERS, context.body->size);
+
+	if (!_get_header(resp, &context))
+		_get_body(resp, &context, body, length);
+
+	_finish_response(resp, &context);
+}
+
+// serve a fresh response from the HTTP cache without any network traffic,
+// a stale stored response is handed back in '*stale' to be revalidated
+static wget_http_response_t *http_get_cached_response(DOWNLOADER *downloader, CACHE_ENTRY **stale)
+{
+	JOB *job = downloader->job;
+	CACHE_ENTRY *entry = NULL;
+	wget_http_request_t *req;
+	wget_http_response_t *resp = NULL;
+
+	if (!_is_cacheable(job) || !(req = http_create_request(job->iri, job, &entry)))
+		return NULL;
+
+	if (entry && cache_entry_is_fresh(entry) && (resp = cache_entry_get_response(entry))) {
+		if (config.progress)
+			bar_print(downloader->id, job->iri->uri);
+		else
+			print_status(downloader, "[%d] Serving '%s' from cache ...\n", downloader->id, job->iri->uri);
+
+		wget_http_request_set_ptr(req, WGET_HTTP_USER_DATA, job);
+		resp->req = req;
+		_deliver_cached_response(resp, entry, downloader->id);
+		cache_count(CACHE_HIT);
+	} else {
+		wget_http_free_request(&req);
+		*stale = entry;
+		entry = NULL;
+	}
+
+	cache_entry_free(&entry);
+
+	return resp;
+}
+
+// store a complete response or replace a 304 by the stored response it revalidated
+static wget_http_response_t *_cache_response(wget_http_response_t *resp, struct _body_callback_context *context)
+{
+	if (resp->code == 304 && context->cache_entry) {
+		wget_http_response_t *cached;
+
+		cache_entry_update(context->cache_entry, resp, context->request_time);
+
+		if ((cached = cache_entry_get_response(context->cache_entry))) {
+			cached->req = resp->req;
+			cached->keep_alive = resp->keep_alive;
+			cached->cookies = resp->cookies;
+			resp->req = NULL;
+			resp->cookies = NULL;
+			wget_http_free_response(&resp);
+
+			resp = cached;
+			_deliver_cached_response(resp, context->cache_entry, context->progress_slot);
+		}
+
+		cache_count(CACHE_REVALIDATED);
+	} else {
+		// the body has to be complete, bodies beyond max_memory are not kept in memory
+		if (resp->code == 200 && resp->body && context->length < context->max_memory && !context->keep_encoding
+			&& (!resp->content_length_valid || resp->content_encoding != wget_content_encoding_identity
+				|| resp->content_length == context->length))
+		{
+			cache_store(context->job->iri, resp->req, resp, resp->body->data, resp->body->length, context->request_time);
+		}
+
+		cache_count(CACHE_MISS);
+	}
+
+	cache_entry_free(&context->cache_entry);
+
+	return resp;
+}
+
+static wget_http_response_t *http_receive_response(DOWNLOADER *downloader)
+{
+	wget_http_response_t *resp = wget_http_get_response_cb(downloader->conn);
+
+	if (!resp)
+		return NULL;
+
+	struct _body_callback_context *context = resp->req->body_user_data;
+
+	for (int it = 0; it < wget_vector_size(downloader->responses); it++) {
+		if (wget_vector_get(downloader->responses, it) == context) {
+			wget_vector_remove_nofree(downloader->responses, it);
+			break;
+		}
+	}
+
+	_finish_response(resp, context);
+
+	if (context->cacheable)
+		resp = _cache_response(resp, context);
+
 	xfree(context);
 
 	return resp;
 }
+
+// the connection failed, release what the callbacks of the unanswered requests have set up
+static void http_abort_responses(DOWNLOADER *downloader)
+{
+	for (int it = 0; it < wget_vector_size(downloader->responses); it++) {
+		struct _body_callback_context *context = wget_vector_get(downloader->responses, it);
+
+		// the data received so far is kept, as it would be without compression
+		if (context->compressor)
+			compress_close(&context->compressor, 0);
+		else if (context->outfd >= 0)
+			close(context->outfd);
+
+		if (config.progress)
+			bar_slot_deregister(context->progress_slot);
+
+		warc_record_free(&context->warc); // an incomplete capture is not archived
+		xfree(context->warc_request_id);
+		cache_entry_free(&context->cache_entry);
+
+		memstats_free(WGET_MEMTAG_HTTP_BUFFERS, context->body->size);
+		wget_buffer_free(&context->body);
+		xfree(context);
+	}
+
+	wget_vector_clear_nofree(downloader->responses);
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Header file for the persistent HTTP cache
+ *
+ */
+
+#ifndef _WGET_CACHE_H
+#define _WGET_CACHE_H
+
+#include <time.h>
+
+#include <wget.h>
+
+typedef struct CACHE_ENTRY CACHE_ENTRY;
+
+typedef enum {
+	CACHE_HIT, // fresh response served without network traffic
+	CACHE_REVALIDATED, // stale response confirmed by 304 Not Modified
+	CACHE_MISS // full response fetched from the server
+} cache_result_t;
+
+int cache_init(void);
+void cache_exit(void);
+void cache_count(cache_result_t result);
+
+CACHE_ENTRY *cache_lookup(const wget_iri_t *iri, const wget_http_request_t *req) G_GNUC_WGET_NONNULL_ALL;
+time_t cache_response_lifetime(const wget_http_response_t *resp, time_t heuristic) G_GNUC_WGET_NONNULL_ALL;
+int cache_entry_is_fresh(const CACHE_ENTRY *entry) G_GNUC_WGET_NONNULL_ALL;
+void cache_entry_add_validators(const CACHE_ENTRY *entry, wget_http_request_t *req) G_GNUC_WGET_NONNULL_ALL;
+wget_http_response_t *cache_entry_get_response(const CACHE_ENTRY *entry) G_GNUC_WGET_NONNULL_ALL;
+const char *cache_entry_get_body(const CACHE_ENTRY *entry, size_t *length) G_GNUC_WGET_NONNULL_ALL;
+void cache_entry_update(CACHE_ENTRY *entry, const wget_http_response_t *resp, time_t request_time) G_GNUC_WGET_NONNULL_ALL;
+void cache_entry_free(CACHE_ENTRY **entry);
+void cache_store(const wget_iri_t *iri, const wget_http_request_t *req, const wget_http_response_t *resp,
+	const char *body, size_t length, time_t request_time) G_GNUC_WGET_NONNULL((1,2,3));
+
+#endif /* _WGET_CACHE_H */
@@ -0,0 +1,41 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Header file for compressed file output
+ *
+ */
+
+#ifndef _WGET_COMPRESS_H
+#define _WGET_COMPRESS_H
+
+#include <wget.h>
+
+typedef struct COMPRESSED_FILE COMPRESSED_FILE;
+
+int compress_init(void);
+void compress_exit(void);
+
+COMPRESSED_FILE *compress_open(int fd, const char *fname) G_GNUC_WGET_NONNULL_ALL;
+void compress_write(COMPRESSED_FILE *file, const void *data, size_t length) G_GNUC_WGET_NONNULL_ALL;
+void compress_close(COMPRESSED_FILE **file, time_t mtime) G_GNUC_WGET_NONNULL_ALL;
+long long compress_resume_offset(const char *fname) G_GNUC_WGET_NONNULL_ALL;
+long long compress_resume(const char *fname) G_GNUC_WGET_NONNULL_ALL;
+char *compress_read_file(const char *fname, size_t *length) G_GNUC_WGET_NONNULL_ALL;
+
+#endif /* _WGET_COMPRESS_H */
@@ -33,6 +33,31 @@
 struct JOB;
 typedef struct JOB JOB;
 
+// class of the last connection failure of a host
+enum host_error {
+	HOST_ERROR_NONE,
+	HOST_ERROR_DNS,
+	HOST_ERROR_REFUSED,
+	HOST_ERROR_TIMEOUT,
+	HOST_ERROR_TLS,
+	HOST_ERROR_CONNECTION // any other connection failure
+};
+
+// host health kept across runs (--host-health-file)
+typedef struct {
+	const char
+		*scheme,
+		*host,
+		*port;
+	long long
+		last_failure, // time of the last connection failure
+		backoff; // seconds to skip the host after last_failure, doubled each time it is blocked again
+	int
+		failures; // number of consecutive connection failures
+	enum host_error
+		error; // class of the last connection failure
+} HOST_HEALTH;
+
 // everything host/domain specific should go here
 typedef struct {
 	const char
@@ -43,29 +68,37 @@ typedef struct {
 		*robot_job; // special job for downloading robots.txt (before anything else)
 	ROBOTS
 		*robots;
+	HOST_HEALTH
+		*health; // with --host-health-file
 	wget_list_t
 		*queue; // host specific job queue
 	long long
-		retry_ts; // timestamp of earliest retry in milliseconds
+		retry_ts, // timestamp of earliest retry in milliseconds
+		next_ts; // timestamp of earliest next request in milliseconds (--wait, Crawl-delay)
 	int
 		qsize, // number of jobs in queue
-		failures; // number of consequent connection failures
+		failures, // number of consequent connection failures
+		affine_jobs; // jobs handed out in a row to downloaders already connected to this host
 	unsigned char
-		blocked : 1; // host may be blocked after too many errors or even one final error
+		blocked : 1, // host may be blocked after too many errors or even one final error
+		misdirected : 1; // answered 421 over a coalesced HTTP/2 connection, needs a connection of its own
 } HOST;
 
 HOST *host_add(wget_iri_t *iri) G_GNUC_WGET_NONNULL((1));
 HOST *host_get(wget_iri_t *iri) G_GNUC_WGET_NONNULL((1));
-JOB *host_get_job(HOST *host, long long *pause);
+JOB *host_get_job(HOST *host, const wget_http_connection_t *conn, long long *pause);
 JOB *host_add_job(HOST *host, JOB *job) G_GNUC_WGET_NONNULL((1,2));
 JOB *host_add_robotstxt_job(HOST *host, wget_iri_t *iri, const char *encoding) G_GNUC_WGET_NONNULL((1,2));
 void host_release_jobs(HOST *host);
 void host_remove_job(HOST *host, JOB *job) G_GNUC_WGET_NONNULL((1,2));
 void host_queue_free(HOST *host) G_GNUC_WGET_NONNULL((1));
 void hosts_free(void);
-void host_increase_failure(HOST *host) G_GNUC_WGET_NONNULL((1));
+void host_increase_failure(HOST *host, enum host_error error) G_GNUC_WGET_NONNULL((1));
 void host_final_failure(HOST *host) G_GNUC_WGET_NONNULL((1));
+void host_set_misdirected(HOST *host) G_GNUC_WGET_NONNULL((1));
 void host_reset_failure(HOST *host) G_GNUC_WGET_NONNULL((1));
+int host_health_load(const char *fname) G_GNUC_WGET_NONNULL((1));
+int host_health_save(const char *fname) G_GNUC_WGET_NONNULL((1));
 
 int queue_size(void) G_GNUC_WGET_PURE;
 int queue_empty(void) G_GNUC_WGET_PURE;
@@ -75,6 +75,8 @@ struct JOB {
 
 	wget_thread_t
 		used_by; // keep track of who uses this job, for host_release_jobs()
+	long long
+		request_ts; // when the request has been sent (ms), for the downloader pool
 	int
 		level, // current recursion level
 		redirection_level, // number of redirections occurred to create this job
@@ -95,6 +97,8 @@ struct DOWNLOADER {
 		*job;
 	wget_http_connection_t
 		*conn;
+	wget_vector_t
+		*responses; // body callback contexts of the requests in flight
 	char
 		*buf;
 	size_t
@@ -104,7 +108,10 @@ struct DOWNLOADER {
 	wget_thread_cond_t
 		cond;
 	char
-		final_error;
+		final_error,
+		new_connection, // the connection has been opened for the current job, not reused
+		retired, // the downloader has left the pool (--min-threads)
+		failed; // the thread could not be started, there is nothing to join
 };
 
 JOB *job_init(JOB *job, wget_iri_t *iri) G_GNUC_WGET_NONNULL((2));
@@ -46,10 +46,20 @@
 // number of elements within an array
 #define countof(a) (sizeof(a)/sizeof(*(a)))
 
+// memory accounting, compiled out unless configured with --enable-memstats
+#ifdef ENABLE_MEMSTATS
+#  define memstats_alloc(tag, size) wget_memstats_alloc(tag, size)
+#  define memstats_free(tag, size) wget_memstats_free(tag, size)
+#else
+#  define memstats_alloc(tag, size) ((void) sizeof(size))
+#  define memstats_free(tag, size) ((void) sizeof(size))
+#endif
+
 // Number of threads in the program
 extern int nthreads;
 
 void set_exit_status(int status);
+void set_file_mtime(int fd, time_t modified);
 const char * G_GNUC_WGET_NONNULL_ALL get_local_filename(wget_iri_t *iri);
 
 #endif /* _WGET_WGET_H */
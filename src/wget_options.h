@@ -56,6 +56,9 @@ struct config {
 		*local_encoding,  // encoding of the environment and file system
 		*remote_encoding, // encoding of remote files (if not specified in Content-Type HTTP header or in document itself)
 		*bind_address,
+		*tcp_congestion,
+		*warc_file,
+		*cache_dir,
 		*input_file,
 		*base_url,
 		*default_page,
@@ -64,6 +67,7 @@ struct config {
 		*http_proxy,
 		*https_proxy,
 		*no_proxy,
+		*http2_prior_knowledge,
 		*cookie_suffixes,
 		*load_cookies,
 		*save_cookies,
@@ -92,6 +96,8 @@ struct config {
 		*hsts_db; // in-memory HSTS database
 	wget_hpkp_db_t
 		*hpkp_db; // in-memory HPKP database
+	wget_redirect_db_t
+		*redirect_db; // in-memory permanent redirect database
 	wget_tls_session_db_t
 		*tls_session_db; // in-memory TLS session database
 	wget_ocsp_db_t
@@ -103,13 +109,19 @@ struct config {
 	char
 		*hsts_file,
 		*hpkp_file,
+		*redirect_cache_file,
+		*host_health_file,
 		*tls_session_file,
 		*ocsp_file,
 		*netrc_file;
 	size_t
 		chunk_size;
 	long long
-		quota;
+		quota,
+		tcp_receive_buffer,
+		warc_max_size,
+		tcp_send_buffer,
+		tcp_notsent_lowat;
 	int
 		http2_request_window,
 		http1_request_window,
@@ -125,7 +137,9 @@ struct config {
 		dns_timeout, // ms
 		read_timeout, // ms
 		max_redirect,
-		max_threads;
+		max_threads,
+		min_threads, // 0 = fixed number of downloaders
+		tcp_busy_poll; // microseconds
 	char
 		tls_resume,            // if TLS session resumption is enabled or not
 		tls_false_start,
@@ -142,6 +156,7 @@ struct config {
 		ignore_case,
 		hsts,                  // if HSTS (HTTP Strict Transport Security) is enabled or not
 		hpkp,                  // HTTP Public Key Pinning (HPKP)
+		redirect_cache,        // follow known permanent redirects locally
 		random_wait,
 		trust_server_names,
 		robots,
@@ -159,6 +174,8 @@ struct config {
 		save_headers,
 		clobber,
 		cache,
+		decompress,
+		compress_output,
 		inet4_only,
 		inet6_only,
 		delete_after,
@@ -177,6 +194,9 @@ struct config {
 		spider,
 		dns_caching,
 		tcp_fastopen,
+		bind_address_no_port,
+		tcp_quickack,
+		warc_compression,
 		check_certificate,
 		check_hostname,
 		cert_type,             // SSL_X509_FMT_PEM or SSL_X509_FMT_DER (=ASN1)
@@ -0,0 +1,42 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Header file for WARC output routines
+ *
+ */
+
+#ifndef _WGET_WARC_H
+#define _WGET_WARC_H
+
+#include <wget.h>
+
+typedef struct WARC_RECORD WARC_RECORD;
+
+int warc_init(void);
+void warc_exit(void);
+
+WARC_RECORD *warc_record_create(const char *type, const char *uri, const char *concurrent_to) G_GNUC_WGET_NONNULL((1));
+const char *warc_record_get_id(const WARC_RECORD *record) G_GNUC_WGET_NONNULL_ALL;
+void warc_record_append(WARC_RECORD *record, const void *data, size_t length) G_GNUC_WGET_NONNULL_ALL;
+void warc_record_append_request(WARC_RECORD *record, wget_http_request_t *req, const wget_http_connection_t *conn) G_GNUC_WGET_NONNULL_ALL;
+void warc_record_append_response_header(WARC_RECORD *record, const wget_http_response_t *resp) G_GNUC_WGET_NONNULL_ALL;
+void warc_record_write(WARC_RECORD *record) G_GNUC_WGET_NONNULL_ALL;
+void warc_record_free(WARC_RECORD **record);
+
+#endif /* _WGET_WARC_H */
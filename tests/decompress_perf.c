@@ -0,0 +1,201 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * testing CPU time and output size of decompressing a body vs. keeping it encoded,
+ * per encoding, output buffer size and with one-shot decompression of a body in memory
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <time.h>
+
+#include <wget.h>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WITH_BZIP2
+#include <bzlib.h>
+#endif
+#ifdef WITH_LZMA
+#include <lzma.h>
+#endif
+
+#define ROUNDS 20
+#define CHUNK 16384 // feed the data in network sized pieces
+#define PLAIN_SIZE (32 * 1024 * 1024)
+
+typedef struct {
+	size_t
+		sum,
+		calls;
+} _count_t;
+
+static int _count(void *context, const char *data, size_t length)
+{
+	_count_t *count = context;
+
+	(void) data;
+	count->sum += length;
+	count->calls++;
+
+	return 0;
+}
+
+static void _report(const char *what, size_t bytes, size_t calls, clock_t start)
+{
+	long ms = (long) ((clock() - start) * 1000 / CLOCKS_PER_SEC);
+
+	printf("%-28s %zu bytes x %d in %ld ms CPU time (%.0f MB/s, %zu callbacks per body)\n",
+		what, bytes, ROUNDS, ms, ms ? (double) bytes * ROUNDS / 1000 / ms : 0.0, calls);
+}
+
+// streaming: network sized input, output given to a sink in pieces of 'bufsize' bytes
+static void _run(const char *what, int encoding, char *data, size_t length, size_t bufsize)
+{
+	clock_t start = clock();
+	_count_t count = { 0, 0 };
+	char name[64];
+
+	for (int n = 0; n < ROUNDS; n++) {
+		wget_decompressor_t *dc = wget_decompress_open(encoding, _count, &count);
+
+		if (bufsize)
+			wget_decompress_set_buffer(dc, NULL, bufsize);
+
+		for (size_t pos = 0; pos < length; pos += CHUNK)
+			wget_decompress(dc, data + pos, length - pos < CHUNK ? length - pos : CHUNK);
+
+		wget_decompress_close(dc);
+	}
+
+	if (bufsize)
+		snprintf(name, sizeof(name), "%s/%zuk:", what, bufsize / 1024);
+	else
+		snprintf(name, sizeof(name), "%s:", what);
+	_report(name, count.sum / ROUNDS, count.calls / ROUNDS, start);
+}
+
+// one-shot: the whole body in memory, decompressed into a pre-sized buffer
+static void _run_oneshot(const char *what, int encoding, char *data, size_t length)
+{
+	clock_t start = clock();
+	wget_buffer_t *out = wget_buffer_alloc(PLAIN_SIZE + 1024);
+	char name[64];
+
+	for (int n = 0; n < ROUNDS; n++) {
+		out->length = 0;
+		if (wget_decompress_buffer(encoding, data, length, out))
+			printf("%s: decompression failed\n", what);
+	}
+
+	snprintf(name, sizeof(name), "%s/one-shot:", what);
+	_report(name, out->length, 0, start);
+
+	wget_buffer_free(&out);
+}
+
+static void _run_all(const char *what, int encoding, char *data, size_t length)
+{
+	printf("%s: %zu bytes compressed\n", what, length);
+	_run(what, encoding, data, length, 10240); // the former fixed size
+	_run(what, encoding, data, length, 64 * 1024);
+	_run(what, encoding, data, length, 256 * 1024);
+	_run_oneshot(what, encoding, data, length);
+}
+
+int main(void)
+{
+	wget_buffer_t *plain = wget_buffer_alloc(PLAIN_SIZE);
+	char *enc;
+	size_t enc_len;
+
+	// a JSON dump like body of 32MB
+	for (int it = 0; plain->length < PLAIN_SIZE; it++)
+		wget_buffer_printf_append(plain, "{\"id\":%d,\"name\":\"item %d\",\"value\":%d.%02d},\n", it, it, it * 7, it % 100);
+
+#ifdef WITH_ZLIB
+	{
+		z_stream strm = { .next_in = NULL };
+
+		if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			return 1;
+
+		enc = wget_malloc(deflateBound(&strm, plain->length));
+		strm.next_in = (unsigned char *) plain->data;
+		strm.avail_in = (unsigned) plain->length;
+		strm.next_out = (unsigned char *) enc;
+		strm.avail_out = (unsigned) deflateBound(&strm, plain->length);
+
+		if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+			return 1;
+
+		enc_len = strm.total_out;
+		deflateEnd(&strm);
+
+		_run_all("gzip", wget_content_encoding_gzip, enc, enc_len);
+		_run("kept encoded", wget_content_encoding_identity, enc, enc_len, 0);
+		wget_xfree(enc);
+	}
+#else
+	printf("Built without zlib, no gzip\n");
+#endif
+
+#ifdef WITH_BZIP2
+	{
+		unsigned int len = (unsigned int) (plain->length + plain->length / 100 + 600);
+
+		enc = wget_malloc(len);
+		if (BZ2_bzBuffToBuffCompress(enc, &len, plain->data, (unsigned int) plain->length, 9, 0, 0) != BZ_OK)
+			return 1;
+
+		_run_all("bzip2", wget_content_encoding_bzip2, enc, len);
+		wget_xfree(enc);
+	}
+#else
+	printf("Built without libbz2, no bzip2\n");
+#endif
+
+#ifdef WITH_LZMA
+	{
+		size_t len = lzma_stream_buffer_bound(plain->length);
+
+		enc = wget_malloc(len);
+		enc_len = 0;
+		if (lzma_easy_buffer_encode(6, LZMA_CHECK_CRC64, NULL, (uint8_t *) plain->data, plain->length,
+			(uint8_t *) enc, &enc_len, len) != LZMA_OK)
+			return 1;
+
+		_run_all("xz", wget_content_encoding_lzma, enc, enc_len);
+		wget_xfree(enc);
+	}
+#else
+	printf("Built without liblzma, no xz\n");
+#endif
+
+	// there is no Brotli encoder dependency, brotli_decompress() shares the buffer handling with the others
+
+	wget_buffer_free(&plain);
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * testing performance of percent-escaping, hex and base64 conversion
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <wget.h>
+
+#define ROUNDS 1000000
+
+int main(void)
+{
+	static const char *paths[] = {
+		"/static/js/app.min.js", // nothing to escape
+		"/wiki/Stra\xC3\x9F" "e mit Leerzeichen/\xE2\x82\xAC?x=1&y=\xC3\xA4", // some UTF-8 and spaces
+	};
+	wget_buffer_t *buf = wget_buffer_alloc(256);
+	unsigned char digest[64];
+	char hex[129], b64[128], tmp[256];
+	long long start;
+	size_t sum;
+
+	for (unsigned it = 0; it < sizeof(paths) / sizeof(paths[0]); it++) {
+		start = wget_get_timemillis();
+		sum = 0;
+		for (int n = 0; n < ROUNDS; n++) {
+			wget_buffer_reset(buf);
+			wget_iri_escape_path(paths[it], buf);
+			sum += buf->length;
+		}
+		printf("escaped '%s' %d times in %lld ms (%zu)\n", buf->data, ROUNDS, wget_get_timemillis() - start, sum);
+
+		start = wget_get_timemillis();
+		sum = 0;
+		for (int n = 0; n < ROUNDS; n++) {
+			strcpy(tmp, buf->data);
+			sum += wget_percent_unescape(tmp);
+		}
+		printf("unescaped '%s' %d times in %lld ms (%zu)\n", buf->data, ROUNDS, wget_get_timemillis() - start, sum);
+	}
+
+	for (unsigned it = 0; it < sizeof(digest); it++)
+		digest[it] = (unsigned char) (it * 37);
+
+	start = wget_get_timemillis();
+	for (int n = 0; n < ROUNDS; n++)
+		wget_memtohex(digest, sizeof(digest), hex, sizeof(hex));
+	printf("converted %zu bytes to hex %d times in %lld ms\n", sizeof(digest), ROUNDS, wget_get_timemillis() - start);
+
+	start = wget_get_timemillis();
+	sum = 0;
+	for (int n = 0; n < ROUNDS; n++) {
+		sum += wget_base64_encode(b64, (char *) digest, sizeof(digest));
+		sum += wget_base64_decode(tmp, b64, strlen(b64));
+	}
+	printf("base64 encoded and decoded %zu bytes %d times in %lld ms (%zu)\n", sizeof(digest), ROUNDS, wget_get_timemillis() - start, sum);
+
+	wget_buffer_free(&buf);
+
+	return 0;
+}
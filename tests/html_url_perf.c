@@ -0,0 +1,108 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * testing performance of HTML URL extraction
+ *
+ * Usage: html_url_perf [files...]
+ * Without files, a synthetic document with markup typical for today's web sites is used.
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <wget.h>
+
+// lots of attributes without URL value, as seen on modern web pages
+static const char *snippet =
+	"<div class=\"col-md-4 card shadow-sm\" id=\"item-%d\" data-toggle=\"tooltip\" data-placement=\"top\" aria-label=\"Item\" role=\"listitem\" tabindex=\"0\">\n"
+	"  <a href=\"/article/%d.html\" class=\"link\" title=\"Article %d\" rel=\"bookmark\" target=\"_blank\">Article</a>\n"
+	"  <img src=\"/img/%d.jpg\" srcset=\"/img/%d-2x.jpg 2x, /img/%d-3x.jpg 3x\" alt=\"Image\" width=\"320\" height=\"200\" loading=\"lazy\" decoding=\"async\">\n"
+	"  <span class=\"badge\" style=\"color: red\" data-count=\"%d\" aria-hidden=\"true\">new</span>\n"
+	"  <button type=\"button\" class=\"btn btn-primary\" onclick=\"doit(%d)\" data-target=\"#modal\" aria-expanded=\"false\">Go</button>\n"
+	"</div>\n";
+
+// same order as wget2's --follow-tags list, needed to search the tag list
+static int _compare_tag(const wget_html_tag_t *t1, const wget_html_tag_t *t2)
+{
+	int n;
+
+	if ((n = wget_strcasecmp_ascii(t1->name, t2->name)))
+		return n;
+
+	if (!t1->attribute)
+		return t2->attribute ? -1 : 0;
+	if (!t2->attribute)
+		return 1;
+
+	return wget_strcasecmp_ascii(t1->attribute, t2->attribute);
+}
+
+int main(int argc, const char *const *argv)
+{
+	wget_buffer_t *html = wget_buffer_alloc(1024 * 1024);
+	wget_vector_t *follow_tags = NULL;
+	int urls = 0, rounds;
+	long long start;
+
+	if (argc > 1) {
+		for (int it = 1; it < argc; it++) {
+			size_t size;
+			char *data = wget_read_file(argv[it], &size);
+
+			if (data) {
+				wget_buffer_memcat(html, data, size);
+				wget_xfree(data);
+			} else
+				fprintf(stderr, "Failed to read %s\n", argv[it]);
+		}
+		rounds = 10;
+	} else {
+		wget_buffer_strcpy(html, "<html><head><meta charset=\"utf-8\"><link rel=\"stylesheet\" href=\"/main.css\"><base href=\"/\"></head><body>\n");
+		for (int it = 0; it < 5000; it++)
+			wget_buffer_printf_append(html, snippet, it, it, it, it, it, it, it, it);
+		wget_buffer_strcat(html, "</body></html>\n");
+		rounds = 20;
+	}
+
+	// a user supplied tag to follow, to also measure lookups in the user tag list
+	follow_tags = wget_vector_create(4, -2, (wget_vector_compare_t)_compare_tag);
+	wget_vector_insert_sorted(follow_tags, &(wget_html_tag_t){ .name = "img", .attribute = "data-src" }, sizeof(wget_html_tag_t));
+
+	start = wget_get_timemillis();
+
+	for (int it = 0; it < rounds; it++) {
+		WGET_HTML_PARSED_RESULT *res = wget_html_get_urls_inline(html->data, follow_tags, NULL);
+
+		urls += wget_vector_size(res->uris);
+		wget_html_free_urls_inline(&res);
+	}
+
+	printf("parsed %zu bytes %d times, found %d URLs in %lld ms\n",
+		html->length, rounds, urls, wget_get_timemillis() - start);
+
+	wget_vector_free(&follow_tags);
+	wget_buffer_free(&html);
+
+	return 0;
+}
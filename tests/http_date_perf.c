@@ -0,0 +1,70 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of Wget.
+ *
+ * Wget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Wget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Wget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * testing performance of HTTP date parsing and printing
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <time.h>
+
+#include <wget.h>
+
+#define ROUNDS 1000000
+
+int main(void)
+{
+	static const char *dates[] = {
+		"Sun, 06 Nov 1994 08:49:37 GMT",
+		"Sunday, 06-Nov-94 08:49:37 GMT",
+		"Sun Nov  6 08:49:37 1994",
+	};
+	char buf[64];
+	long long start, sum;
+	time_t t = 784111777;
+
+	for (unsigned it = 0; it < sizeof(dates) / sizeof(dates[0]); it++) {
+		// same string over and over, like a server's Date: header
+		start = wget_get_timemillis();
+		sum = 0;
+		for (int n = 0; n < ROUNDS; n++)
+			sum += wget_http_parse_full_date(dates[it]);
+		printf("parsed '%s' %d times in %lld ms (%lld)\n", dates[it], ROUNDS, wget_get_timemillis() - start, sum);
+	}
+
+	// different values each time, bypassing the last-value cache
+	start = wget_get_timemillis();
+	sum = 0;
+	for (int n = 0; n < ROUNDS; n++) {
+		wget_http_print_date(t + n, buf, sizeof(buf));
+		sum += wget_http_parse_full_date(buf);
+	}
+	printf("printed and parsed %d different dates in %lld ms (%lld)\n", ROUNDS, wget_get_timemillis() - start, sum);
+
+	start = wget_get_timemillis();
+	for (int n = 0; n < ROUNDS; n++)
+		wget_http_print_date(t, buf, sizeof(buf));
+	printf("printed '%s' %d times in %lld ms\n", buf, ROUNDS, wget_get_timemillis() - start);
+
+	return 0;
+}
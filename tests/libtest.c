@@ -47,11 +47,14 @@
 #include <wget.h>
 #include "libtest.h"
 
+#define HTTP_SERVER_THREADS 8 // number of HTTP server threads with a response delay
+
 static wget_thread_t
 	http_server_tid,
 	https_server_tid,
 	ftp_server_tid,
-	ftps_server_tid;
+	ftps_server_tid,
+	http_server_extra_tid[HTTP_SERVER_THREADS - 1];
 static int
 	http_server_port,
 	https_server_port,
@@ -83,17 +86,312 @@ static const char
 	*server_hello;
 static char
 	server_send_content_length = 1;
+static int
+	server_response_delay; // ms
+static wget_thread_mutex_t
+	urls_mutex = WGET_THREAD_MUTEX_INITIALIZER; // the server threads update the request counters of 'urls'
+static int
+	h2_max_streams, // HTTP/2 stream limit announced by the HTTPS server, 0 = no HTTP/2
+	h2_open_streams,
+	h2_peak_streams, // max. number of streams open at the same time
+	h2_refused_streams, // streams reset with REFUSED_STREAM
+	h2_misdirected_requests; // requests answered with 421
+static const char
+	*h2_misdirected; // host name answered with 421 over connections opened for another one
 
 static void sigterm_handler(int sig G_GNUC_WGET_UNUSED)
 {
 	terminate = 1;
 }
 
-static void *_http_server_thread(void *ctx)
+#ifdef WITH_LIBNGHTTP2
+typedef struct {
+	const char
+		*body;
+	size_t
+		body_len,
+		body_pos;
+	int32_t
+		stream_id;
+	char
+		path[256],
+		authority[256];
+} _h2_stream_t;
+
+typedef struct {
+	wget_tcp_t
+		*tcp;
+	wget_vector_t
+		*streams, // owns the _h2_stream_t structures
+		*ready; // streams with a complete request
+	char
+		authority[256]; // of the first request, the host name the connection has been opened for
+} _h2_connection_t;
+
+static ssize_t _h2_send_callback(nghttp2_session *session G_GNUC_WGET_UNUSED,
+	const uint8_t *data, size_t length, int flags G_GNUC_WGET_UNUSED, void *user_data)
+{
+	_h2_connection_t *conn = user_data;
+	ssize_t rc = wget_tcp_write(conn->tcp, (const char *) data, length);
+
+	return rc > 0 ? rc : NGHTTP2_ERR_CALLBACK_FAILURE;
+}
+
+static int _h2_on_begin_headers_callback(nghttp2_session *session, const nghttp2_frame *frame, void *user_data)
+{
+	_h2_connection_t *conn = user_data;
+	_h2_stream_t stream = { .stream_id = frame->hd.stream_id };
+	int pos;
+
+	if (frame->hd.type != NGHTTP2_HEADERS)
+		return 0;
+
+	pos = wget_vector_add(conn->streams, &stream, sizeof(stream));
+	nghttp2_session_set_stream_user_data(session, frame->hd.stream_id, wget_vector_get(conn->streams, pos));
+
+	if (++h2_open_streams > h2_peak_streams)
+		h2_peak_streams = h2_open_streams;
+
+	return 0;
+}
+
+static int _h2_on_header_callback(nghttp2_session *session, const nghttp2_frame *frame,
+	const uint8_t *name, size_t namelen, const uint8_t *value, size_t valuelen,
+	uint8_t flags G_GNUC_WGET_UNUSED, void *user_data G_GNUC_WGET_UNUSED)
+{
+	_h2_stream_t *stream = nghttp2_session_get_stream_user_data(session, frame->hd.stream_id);
+
+	if (stream && namelen == 5 && !memcmp(name, ":path", 5))
+		snprintf(stream->path, sizeof(stream->path), "%.*s", (int) valuelen, value);
+	else if (stream && namelen == 10 && !memcmp(name, ":authority", 10))
+		snprintf(stream->authority, sizeof(stream->authority), "%.*s", (int) valuelen, value);
+
+	return 0;
+}
+
+static int _h2_on_frame_recv_callback(nghttp2_session *session, const nghttp2_frame *frame, void *user_data)
+{
+	_h2_connection_t *conn = user_data;
+	_h2_stream_t *stream;
+
+	// the request is complete, the response is sent after the current input has been processed
+	if ((frame->hd.type == NGHTTP2_HEADERS || frame->hd.type == NGHTTP2_DATA) && (frame->hd.flags & NGHTTP2_FLAG_END_STREAM)) {
+		if ((stream = nghttp2_session_get_stream_user_data(session, frame->hd.stream_id))) {
+			if (!*conn->authority)
+				snprintf(conn->authority, sizeof(conn->authority), "%s", stream->authority);
+			wget_vector_add_noalloc(conn->ready, stream);
+		}
+	}
+
+	return 0;
+}
+
+static int _h2_on_frame_send_callback(nghttp2_session *session G_GNUC_WGET_UNUSED,
+	const nghttp2_frame *frame, void *user_data G_GNUC_WGET_UNUSED)
+{
+	if (frame->hd.type == NGHTTP2_RST_STREAM && frame->rst_stream.error_code == NGHTTP2_REFUSED_STREAM)
+		h2_refused_streams++;
+
+	return 0;
+}
+
+static int _h2_on_stream_close_callback(nghttp2_session *session G_GNUC_WGET_UNUSED,
+	int32_t stream_id G_GNUC_WGET_UNUSED, uint32_t error_code G_GNUC_WGET_UNUSED, void *user_data G_GNUC_WGET_UNUSED)
+{
+	h2_open_streams--;
+
+	return 0;
+}
+
+static ssize_t _h2_read_body(nghttp2_session *session G_GNUC_WGET_UNUSED, int32_t stream_id G_GNUC_WGET_UNUSED,
+	uint8_t *buf, size_t length, uint32_t *data_flags, nghttp2_data_source *source, void *user_data G_GNUC_WGET_UNUSED)
+{
+	_h2_stream_t *stream = source->ptr;
+	size_t n = stream->body_len - stream->body_pos;
+
+	if (n > length)
+		n = length;
+
+	memcpy(buf, stream->body + stream->body_pos, n);
+	stream->body_pos += n;
+
+	if (stream->body_pos >= stream->body_len)
+		*data_flags |= NGHTTP2_DATA_FLAG_EOF;
+
+	return n;
+}
+
+// 'authority' is host[:port], compare its host part
+static int _h2_authority_is(const char *authority, const char *host)
+{
+	size_t len = strlen(host);
+
+	return !strncmp(authority, host, len) && (authority[len] == ':' || !authority[len]);
+}
+
+static void _h2_respond(nghttp2_session *session, _h2_connection_t *conn, _h2_stream_t *stream)
+{
+	wget_test_url_t *url = NULL;
+	nghttp2_nv nvs[countof(url->headers) + 2];
+	char names[countof(url->headers)][64], status[4] = "404", content_length[32];
+	size_t nnvs = 0, it;
+
+	// a coalesced request for a host this server doesn't serve over this connection
+	if (h2_misdirected && _h2_authority_is(stream->authority, h2_misdirected) && !_h2_authority_is(conn->authority, h2_misdirected)) {
+		h2_misdirected_requests++;
+		nvs[nnvs++] = (nghttp2_nv) { (uint8_t *) ":status", (uint8_t *) "421", 7, 3, NGHTTP2_NV_FLAG_NONE };
+		nvs[nnvs++] = (nghttp2_nv) { (uint8_t *) "content-length", (uint8_t *) "0", 14, 1, NGHTTP2_NV_FLAG_NONE };
+		nghttp2_submit_response(session, stream->stream_id, nvs, nnvs, NULL);
+		return;
+	}
+
+	for (it = 0; it < nurls; it++) {
+		if (!strcmp(stream->path, urls[it].name)) {
+			url = &urls[it];
+			break;
+		}
+	}
+
+	if (url) {
+		wget_thread_mutex_lock(&urls_mutex);
+		url->requests++;
+		wget_thread_mutex_unlock(&urls_mutex);
+
+		if (url->early_hints[0]) {
+			nghttp2_nv hints[countof(url->early_hints) + 1];
+			char hint_names[countof(url->early_hints)][64];
+			size_t nhints = 0;
+
+			hints[nhints++] = (nghttp2_nv) { (uint8_t *) ":status", (uint8_t *) "103", 7, 3, NGHTTP2_NV_FLAG_NONE };
+			for (it = 0; it < countof(url->early_hints) && url->early_hints[it]; it++) {
+				const char *value = strchr(url->early_hints[it], ':');
+				size_t namelen;
+
+				if (!value || (namelen = value - url->early_hints[it]) >= sizeof(hint_names[it]))
+					continue;
+
+				for (size_t i = 0; i < namelen; i++)
+					hint_names[it][i] = c_tolower(url->early_hints[it][i]);
+				hint_names[it][namelen] = 0;
+
+				for (value++; c_isblank(*value); value++);
+
+				hints[nhints++] = (nghttp2_nv) { (uint8_t *) hint_names[it], (uint8_t *) value, namelen, strlen(value), NGHTTP2_NV_FLAG_NONE };
+			}
+
+			nghttp2_submit_headers(session, NGHTTP2_FLAG_NONE, stream->stream_id, NULL, hints, nhints, NULL);
+		}
+
+		snprintf(status, sizeof(status), "%s", url->code ? url->code : "200");
+		stream->body = url->body ? url->body : "";
+		stream->body_len = url->body_len ? url->body_len : strlen(stream->body);
+	}
+
+	snprintf(content_length, sizeof(content_length), "%zu", stream->body_len);
+	nvs[nnvs++] = (nghttp2_nv) { (uint8_t *) ":status", (uint8_t *) status, 7, 3, NGHTTP2_NV_FLAG_NONE };
+	nvs[nnvs++] = (nghttp2_nv) { (uint8_t *) "content-length", (uint8_t *) content_length, 14, strlen(content_length), NGHTTP2_NV_FLAG_NONE };
+
+	// HTTP/2 header names are lowercase, connection specific headers are not allowed
+	for (it = 0; url && it < countof(url->headers) && url->headers[it]; it++) {
+		const char *value = strchr(url->headers[it], ':');
+		size_t namelen;
+
+		if (!value || (namelen = value - url->headers[it]) >= sizeof(names[it]))
+			continue;
+
+		for (size_t i = 0; i < namelen; i++)
+			names[it][i] = c_tolower(url->headers[it][i]);
+		names[it][namelen] = 0;
+
+		if (!strcmp(names[it], "connection") || !strcmp(names[it], "keep-alive") || !strcmp(names[it], "transfer-encoding"))
+			continue;
+
+		for (value++; c_isblank(*value); value++);
+
+		nvs[nnvs++] = (nghttp2_nv) { (uint8_t *) names[it], (uint8_t *) value, namelen, strlen(value), NGHTTP2_NV_FLAG_NONE };
+	}
+
+	nghttp2_submit_response(session, stream->stream_id, nvs, nnvs,
+		&(nghttp2_data_provider) { .source.ptr = stream, .read_callback = _h2_read_body });
+}
+
+// serve an HTTP/2 connection (negotiated via ALPN or with prior knowledge) until the client closes it,
+// 'data' is what has already been read from the connection
+static void _http2_server(wget_tcp_t *tcp, const char *data, size_t length)
+{
+	_h2_connection_t conn = {
+		.tcp = tcp,
+		.streams = wget_vector_create(16, -2, NULL),
+		.ready = wget_vector_create(16, -2, NULL),
+	};
+	nghttp2_session_callbacks *callbacks;
+	nghttp2_session *session;
+	char buf[16384];
+	ssize_t nbytes;
+	int it;
+
+	if (nghttp2_session_callbacks_new(&callbacks))
+		wget_error_printf_exit(_("Failed to create HTTP2 callbacks\n"));
+
+	nghttp2_session_callbacks_set_send_callback(callbacks, _h2_send_callback);
+	nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, _h2_on_begin_headers_callback);
+	nghttp2_session_callbacks_set_on_header_callback(callbacks, _h2_on_header_callback);
+	nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, _h2_on_frame_recv_callback);
+	nghttp2_session_callbacks_set_on_frame_send_callback(callbacks, _h2_on_frame_send_callback);
+	nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, _h2_on_stream_close_callback);
+
+	if (nghttp2_session_server_new(&session, callbacks, &conn))
+		wget_error_printf_exit(_("Failed to create HTTP2 server session\n"));
+
+	nghttp2_session_callbacks_del(callbacks);
+
+	nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, (nghttp2_settings_entry []) {
+		{ NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, (uint32_t) h2_max_streams }
+	}, h2_max_streams ? 1 : 0);
+
+	while (!terminate) {
+		if (wget_vector_size(conn.ready) > 0) {
+			// emulate a high-latency server: all requests received so far are answered after the delay
+			if (server_response_delay)
+				wget_millisleep(server_response_delay);
+
+			for (it = 0; it < wget_vector_size(conn.ready); it++)
+				_h2_respond(session, &conn, wget_vector_get(conn.ready, it));
+			wget_vector_clear_nofree(conn.ready);
+		}
+
+		if (nghttp2_session_send(session))
+			break;
+
+		if (!nghttp2_session_want_read(session) && !nghttp2_session_want_write(session))
+			break;
+
+		if (length) {
+			// data read before the protocol was known
+			nbytes = length;
+			length = 0;
+		} else if ((nbytes = wget_tcp_read(tcp, buf, sizeof(buf))) > 0)
+			data = buf;
+		else
+			break;
+
+		if (nghttp2_session_mem_recv(session, (const uint8_t *) data, nbytes) < 0)
+			break;
+	}
+
+	nghttp2_session_del(session);
+	wget_vector_clear_nofree(conn.ready);
+	wget_vector_free(&conn.ready);
+	wget_vector_free(&conn.streams);
+}
+#endif
+
+// accept and answer connections until terminated
+static void _http_server(wget_tcp_t *parent_tcp)
 {
-	wget_tcp_t *tcp=NULL, *parent_tcp = ctx;
+	wget_tcp_t *tcp=NULL;
 	wget_test_url_t *url = NULL;
-	char buf[4096], method[32], request_url[256], tag[64], value[256], *p;
+	char buf[4096], method[32], request_url[256], tag[64], value[256], etag[256], *p;
 	ssize_t from_bytes, to_bytes, n;
 	size_t nbytes, body_len, request_url_length;
 	unsigned it;
@@ -110,6 +408,13 @@ static void *_http_server_thread(void *ctx)
 		wget_tcp_deinit(&tcp);
 
 		if ((tcp = wget_tcp_accept(parent_tcp))) {
+#ifdef WITH_LIBNGHTTP2
+			if (wget_tcp_get_protocol(tcp) == WGET_PROTOCOL_HTTP_2_0) {
+				_http2_server(tcp, NULL, 0);
+				continue;
+			}
+#endif
+
 			authorized = 0;
 
 			nbytes = 0;
@@ -122,14 +427,34 @@ static void *_http_server_thread(void *ctx)
 			}
 			wget_info_printf(_("[SERVER] total %zd bytes (total %zu) (errno=%d)\n"), n, nbytes, errno);
 
+#ifdef WITH_LIBNGHTTP2
+			// a client with prior knowledge starts with the HTTP/2 connection preface (h2c)
+			if (nbytes >= 16 && !memcmp(buf, "PRI * HTTP/2.0\r\n", 16)) {
+				_http2_server(tcp, buf, nbytes);
+				continue;
+			}
+#endif
+
 			if (nbytes > 0) {
 				if (sscanf(buf, "%31s %255s", method, request_url) !=2) {
 					wget_tcp_printf(tcp, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
 					continue;
 				}
 
+				// proxy requests come with an absolute URL, take the path if the URL is not explicitly listed
+				if (!wget_strncasecmp_ascii(request_url, "http://", 7) || !wget_strncasecmp_ascii(request_url, "https://", 8)) {
+					for (it = 0; it < nurls && strcmp(request_url, urls[it].name); it++);
+
+					if (it == nurls) {
+						const char *path = strchr(strstr(request_url, "://") + 3, '/');
+
+						memmove(request_url, path ? path : "/", strlen(path ? path : "/") + 1);
+					}
+				}
+
 				byterange = from_bytes = to_bytes = 0;
 				modified = 0;
+				*etag = 0;
 
 				for (p = strstr(buf, "\r\n"); p && sscanf(p, "\r\n%63[^:]: %255[^\r]", tag, value) == 2; p = strstr(p + 2, "\r\n")) {
 					if (!wget_strcasecmp_ascii(tag, "Range")) {
@@ -158,6 +483,9 @@ static void *_http_server_thread(void *ctx)
 						modified = wget_http_parse_full_date(value);
 						wget_info_printf("modified = %ld\n", modified);
 					}
+					else if (!wget_strcasecmp_ascii(tag, "If-None-Match")) {
+						snprintf(etag, sizeof(etag), "%s", value);
+					}
 				}
 
 				url = NULL;
@@ -190,6 +518,25 @@ static void *_http_server_thread(void *ctx)
 					continue;
 				}
 
+				wget_thread_mutex_lock(&urls_mutex);
+				url->requests++;
+				if (!wget_tcp_get_peer_address(tcp, url->peer, sizeof(url->peer)))
+					*url->peer = 0;
+				wget_thread_mutex_unlock(&urls_mutex);
+
+				// hints about the final response are sent before any processing delay
+				if (url->early_hints[0]) {
+					nbytes = snprintf(buf, sizeof(buf), "HTTP/1.1 103 Early Hints\r\n");
+					for (it = 0; it < countof(url->early_hints) && url->early_hints[it]; it++)
+						nbytes += snprintf(buf + nbytes, sizeof(buf) - nbytes, "%s\r\n", url->early_hints[it]);
+					nbytes += snprintf(buf + nbytes, sizeof(buf) - nbytes, "\r\n");
+					wget_tcp_write(tcp, buf, nbytes);
+				}
+
+				// emulate a high-latency server
+				if (server_response_delay)
+					wget_millisleep(server_response_delay);
+
 				if (url->auth_method && !authorized) {
 					if (!wget_strcasecmp_ascii(url->auth_method, "basic"))
 						wget_tcp_printf(tcp,
@@ -203,7 +550,18 @@ static void *_http_server_thread(void *ctx)
 					continue;
 				}
 
-				if (modified && url->modified<=modified) {
+				if (*etag) {
+					// If-None-Match takes precedence over If-Modified-Since
+					for (it = 0; it < countof(url->headers) && url->headers[it]; it++) {
+						if (!wget_strncasecmp_ascii(url->headers[it], "ETag: ", 6))
+							break;
+					}
+
+					if (it < countof(url->headers) && url->headers[it] && !strcmp(url->headers[it] + 6, etag)) {
+						wget_tcp_printf(tcp,"HTTP/1.1 304 Not Modified\r\n\r\n");
+						continue;
+					}
+				} else if (modified && url->modified<=modified) {
 					wget_tcp_printf(tcp,"HTTP/1.1 304 Not Modified\r\n\r\n");
 					continue;
 				}
@@ -231,7 +589,7 @@ static void *_http_server_thread(void *ctx)
 						nbytes += snprintf(buf + nbytes, sizeof(buf) - nbytes, "%.*s", (int)body_len, url->body + from_bytes);
 				} else {
 					// create response
-					body_len = strlen(url->body ? url->body : "");
+					body_len = url->body_len ? url->body_len : strlen(url->body ? url->body : "");
 					nbytes = snprintf(buf, sizeof(buf), "HTTP/1.1 %s\r\n", url->code ? url->code : "200 OK");
 					if (server_send_content_length)
 						nbytes += snprintf(buf + nbytes, sizeof(buf) - nbytes, "Content-Length: %zu\r\n", body_len);
@@ -239,22 +597,45 @@ static void *_http_server_thread(void *ctx)
 						nbytes += snprintf(buf + nbytes, sizeof(buf) - nbytes, "%s\r\n", url->headers[it]);
 					}
 					nbytes += snprintf(buf + nbytes, sizeof(buf) - nbytes, "\r\n");
-					if (!strcmp(method, "GET") || !strcmp(method, "POST"))
+					if (url->body_len || url->body_delay) {
+						// binary or delayed body, sent separately after the header
+						wget_tcp_write(tcp, buf, nbytes);
+						nbytes = 0;
+						if (url->body_delay)
+							wget_millisleep(url->body_delay);
+						if (!strcmp(method, "GET") || !strcmp(method, "POST"))
+							wget_tcp_write(tcp, url->body ? url->body : "", body_len);
+					} else if (!strcmp(method, "GET") || !strcmp(method, "POST"))
 						nbytes += snprintf(buf + nbytes, sizeof(buf) - nbytes, "%s", url->body ? url->body : "");
 				}
 
 				// send response
-				wget_tcp_write(tcp, buf, nbytes);
+				if (nbytes)
+					wget_tcp_write(tcp, buf, nbytes);
 			}
 		} else if (!terminate)
 			wget_error_printf(_("Failed to get connection (%d)\n"), errno);
 	}
+}
 
+static void *_http_server_thread(void *ctx)
+{
+	wget_tcp_t *parent_tcp = ctx;
+
+	_http_server(parent_tcp);
 	wget_tcp_deinit(&parent_tcp);
 
 	return NULL;
 }
 
+// additional threads share the listening socket of the HTTP server thread
+static void *_http_server_extra_thread(void *ctx)
+{
+	_http_server(ctx);
+
+	return NULL;
+}
+
 static void *_ftp_server_thread(void *ctx)
 {
 	wget_tcp_t *tcp = NULL, *parent_tcp = ctx, *pasv_parent_tcp = NULL, *pasv_tcp = NULL;
@@ -462,6 +843,13 @@ void wget_test_stop_server(void)
 	}
 
 	// free resources - needed for valgrind testing
+	if (server_response_delay) {
+		// stop the extra threads before the listening socket is closed
+		for (unsigned it = 0; it < countof(http_server_extra_tid); it++) {
+			pthread_kill(http_server_extra_tid[it], SIGTERM);
+			wget_thread_join(http_server_extra_tid[it]);
+		}
+	}
 	pthread_kill(http_server_tid, SIGTERM);
 	pthread_kill(https_server_tid, SIGTERM);
 	pthread_kill(ftp_server_tid, SIGTERM);
@@ -591,6 +979,12 @@ void wget_test_start_server(int first_key, ...)
 		case WGET_TEST_SERVER_SEND_CONTENT_LENGTH:
 			server_send_content_length = va_arg(args, int);
 			break;
+		case WGET_TEST_SERVER_RESPONSE_DELAY:
+			server_response_delay = va_arg(args, int);
+			break;
+		case WGET_TEST_H2_MAX_STREAMS:
+			h2_max_streams = va_arg(args, int);
+			break;
 		default:
 			wget_error_printf(_("Unknown option %d\n"), key);
 		}
@@ -615,6 +1009,10 @@ void wget_test_start_server(int first_key, ...)
 	wget_ssl_set_config_string(WGET_SSL_CERT_FILE, SRCDIR "/certs/x509-server-cert.pem");
 	wget_ssl_set_config_string(WGET_SSL_KEY_FILE, SRCDIR "/certs/x509-server-key.pem");
 
+	// let clients negotiate HTTP/2
+	if (h2_max_streams)
+		wget_ssl_set_config_string(WGET_SSL_SERVER_ALPN, "h2,http/1.1");
+
 	// init HTTP server socket
 	http_parent_tcp = wget_tcp_init();
 	wget_tcp_set_timeout(http_parent_tcp, -1); // INFINITE timeout
@@ -653,7 +1051,7 @@ void wget_test_start_server(int first_key, ...)
 
 	// now replace {{port}} in the body by the actual server port
 	for (wget_test_url_t *url = urls; url < urls + nurls; url++) {
-		char *p = _insert_ports(url->body);
+		char *p = url->body_len ? NULL : _insert_ports(url->body);
 
 		if (p) {
 			url->body = p;
@@ -674,6 +1072,14 @@ void wget_test_start_server(int first_key, ...)
 	if ((rc = wget_thread_start(&http_server_tid, _http_server_thread, http_parent_tcp, 0)) != 0)
 		wget_error_printf_exit(_("Failed to start HTTP server, error %d\n"), rc);
 
+	// with a response delay, several threads accept connections in parallel
+	if (server_response_delay) {
+		for (it = 0; it < countof(http_server_extra_tid); it++) {
+			if ((rc = wget_thread_start(&http_server_extra_tid[it], _http_server_extra_thread, http_parent_tcp, 0)) != 0)
+				wget_error_printf_exit(_("Failed to start HTTP server, error %d\n"), rc);
+		}
+	}
+
 	// start thread for HTTPS
 	if ((rc = wget_thread_start(&https_server_tid, _http_server_thread, https_parent_tcp, 0)) != 0)
 		wget_error_printf_exit(_("Failed to start HTTPS server, error %d\n"), rc);
@@ -759,9 +1165,14 @@ void wget_test(int first_key, ...)
 		args;
 	char
 		server_send_content_length_old = server_send_content_length;
+	int
+		h2_max_streams_old = h2_max_streams;
+	const char
+		*h2_misdirected_old = h2_misdirected;
 
 	keep_tmpfiles = 0;
 	server_hello = "220 FTP server ready";
+	h2_peak_streams = h2_refused_streams = h2_misdirected_requests = 0;
 
 	if (!request_urls)
 		request_urls = wget_vector_create(8,8,NULL);
@@ -801,6 +1212,12 @@ void wget_test(int first_key, ...)
 		case WGET_TEST_SERVER_SEND_CONTENT_LENGTH:
 			server_send_content_length = va_arg(args, int);
 			break;
+		case WGET_TEST_H2_MAX_STREAMS:
+			h2_max_streams = va_arg(args, int); // HTTP/2 has to be enabled with wget_test_start_server()
+			break;
+		case WGET_TEST_H2_MISDIRECTED:
+			h2_misdirected = va_arg(args, const char *);
+			break;
 		default:
 			wget_error_printf_exit(_("Unknown option %d [%s]\n"), key, options);
 		}
@@ -815,12 +1232,13 @@ void wget_test(int first_key, ...)
 	if (existing_files) {
 		for (it = 0; existing_files[it].name; it++) {
 			if ((fd = open(existing_files[it].name, O_CREAT|O_WRONLY|O_TRUNC, 0644)) != -1) {
-				ssize_t nbytes = write(fd, existing_files[it].content, strlen(existing_files[it].content));
+				size_t length = existing_files[it].content_length ? existing_files[it].content_length : strlen(existing_files[it].content);
+				ssize_t nbytes = write(fd, existing_files[it].content, length);
 				close(fd);
 
-				if (nbytes != (ssize_t)strlen(existing_files[it].content))
+				if (nbytes != (ssize_t)length)
 					wget_error_printf_exit(_("Failed to write %zu bytes to file %s/%s [%s]\n"),
-						strlen(existing_files[it].content), tmpdir, existing_files[it].name, options);
+						length, tmpdir, existing_files[it].name, options);
 
 				if (existing_files[it].timestamp) {
 					// take the old utime() instead of utimes()
@@ -881,6 +1299,7 @@ void wget_test(int first_key, ...)
 				wget_error_printf_exit(_("Missing expected file %s/%s [%s]\n"), tmpdir, expected_files[it].name, options);
 
 			if (expected_files[it].content) {
+				size_t length = expected_files[it].content_length ? expected_files[it].content_length : strlen(expected_files[it].content);
 				char content[st.st_size ? st.st_size : 1];
 
 				if ((fd = open(expected_files[it].name, O_RDONLY)) != -1) {
@@ -891,7 +1310,7 @@ void wget_test(int first_key, ...)
 						wget_error_printf_exit(_("Failed to read %lld bytes from file %s/%s [%s]\n"),
 							(long long)st.st_size, tmpdir, expected_files[it].name, options);
 
-					if (strlen(expected_files[it].content) != (size_t)nbytes || memcmp(expected_files[it].content, content, nbytes) != 0)
+					if (length != (size_t)nbytes || memcmp(expected_files[it].content, content, nbytes) != 0)
 						wget_error_printf_exit(_("Unexpected content in %s [%s]\n"), expected_files[it].name, options);
 				}
 			}
@@ -908,6 +1327,8 @@ void wget_test(int first_key, ...)
 	wget_buffer_free(&cmd);
 
 	server_send_content_length = server_send_content_length_old;
+	h2_max_streams = h2_max_streams_old;
+	h2_misdirected = h2_misdirected_old;
 
 	// system("ls -la");
 }
@@ -922,6 +1343,21 @@ int wget_test_get_https_server_port(void)
 	return https_server_port;
 }
 
+int wget_test_get_h2_peak_streams(void)
+{
+	return h2_peak_streams;
+}
+
+int wget_test_get_h2_refused_streams(void)
+{
+	return h2_refused_streams;
+}
+
+int wget_test_get_h2_misdirected_requests(void)
+{
+	return h2_misdirected_requests;
+}
+
 int wget_test_get_ftp_server_port(void)
 {
 	return ftp_server_port;
@@ -46,6 +46,9 @@ extern "C" {
 #define WGET_TEST_FTP_IO_ORDERED 1004
 #define WGET_TEST_FTP_SERVER_HELLO 1005
 #define WGET_TEST_FTPS_IMPLICIT 1006
+#define WGET_TEST_SERVER_RESPONSE_DELAY 1007 // ms, HTTP requests are answered by several threads then
+#define WGET_TEST_H2_MAX_STREAMS 1008 // the HTTPS server offers HTTP/2 with this stream limit (also per wget_test())
+#define WGET_TEST_H2_MISDIRECTED 1009 // HTTP/2 requests for this host name over a connection opened for another one get 421 (per wget_test())
 
 // defines for wget_test()
 #define WGET_TEST_REQUEST_URL 2001
@@ -82,6 +85,8 @@ typedef struct {
 		content;
 	time_t
 		timestamp;
+	size_t
+		content_length; // length of binary content, 0 if content is a string
 } wget_test_file_t;
 
 typedef struct {
@@ -91,16 +96,26 @@ typedef struct {
 		code;
 	const char *
 		body;
+	size_t
+		body_len; // length of a binary body (may contain 0 bytes), 0 if body is a string
 	const char *
 		headers[10];
 	const char *
 		request_headers[10];
 	time_t
 		modified;
+	int
+		requests; // number of requests for this URL answered by the test server
 	char
 		body_alloc; // if body has been allocated internally (and need to be freed on exit)
 	char
 		header_alloc[10]; // if header[n] has been allocated internally (and need to be freed on exit)
+	const char *
+		early_hints[4]; // headers (e.g. Link) sent with a '103 Early Hints' response ahead of the final response
+	int
+		body_delay; // ms between sending the response header and the body (HTTP/1.1)
+	char
+		peer[64]; // numeric address of the client of the last request for this URL (HTTP/1.1)
 
 	// auth fields
 	const char *
@@ -128,6 +143,9 @@ WGETAPI int wget_test_get_http_server_port(void) G_GNUC_WGET_PURE;
 WGETAPI int wget_test_get_https_server_port(void) G_GNUC_WGET_PURE;
 WGETAPI int wget_test_get_ftp_server_port(void) G_GNUC_WGET_PURE;
 WGETAPI int wget_test_get_ftps_server_port(void) G_GNUC_WGET_PURE;
+WGETAPI int wget_test_get_h2_peak_streams(void) G_GNUC_WGET_PURE;
+WGETAPI int wget_test_get_h2_refused_streams(void) G_GNUC_WGET_PURE;
+WGETAPI int wget_test_get_h2_misdirected_requests(void) G_GNUC_WGET_PURE;
 
 #if defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 5)
 #	pragma GCC diagnostic ignored "-Wmissing-field-initializers"
@@ -0,0 +1,137 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing --bind-address with a list of local addresses
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h> // snprintf()
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+// the connections of the last run have to be spread over both bind addresses
+static void _check_peers(wget_test_url_t *urls, size_t nurls, const char *run)
+{
+	int seen2 = 0, seen3 = 0;
+
+	for (size_t it = 0; it < nurls; it++) {
+		if (!strcmp(urls[it].peer, "127.0.0.2"))
+			seen2++;
+		else if (!strcmp(urls[it].peer, "127.0.0.3"))
+			seen3++;
+		else
+			wget_error_printf_exit("%s: %s requested from '%s'\n", run, urls[it].name, urls[it].peer);
+
+		*urls[it].peer = 0;
+	}
+
+	if (!seen2 || !seen3)
+		wget_error_printf_exit("%s: connections not rotated (127.0.0.2: %d, 127.0.0.3: %d)\n", run, seen2, seen3);
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.body = "<html><a href=\"page1.html\">1</a><a href=\"page2.html\">2</a></html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/page1.html",
+			.code = "200 Dontcare",
+			.body = "<html>page1</html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/page2.html",
+			.code = "200 Dontcare",
+			.body = "<html>page2</html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+	};
+	static const char request[] = "GET /index.html HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+	wget_tcp_t *tcp;
+	char port[16], buf[256];
+
+#ifndef __linux__
+	// only Linux routes the whole 127.0.0.0/8 to the loopback device by default
+	exit(77);
+#endif
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// without keep-alive each download needs a new connection and thus a new bind address
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH --no-http-keep-alive --bind-address=127.0.0.2,127.0.0.3",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{	NULL } },
+		0);
+
+	_check_peers(urls, countof(urls), "bind-address");
+
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH --no-http-keep-alive --bind-address=127.0.0.2,127.0.0.3 --bind-address-no-port",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{	NULL } },
+		0);
+
+	_check_peers(urls, countof(urls), "bind-address-no-port");
+
+	// a tcp object keeps its bind addresses when the global ones are replaced meanwhile
+	wget_tcp_set_bind_address(NULL, "127.0.0.4");
+	tcp = wget_tcp_init();
+	wget_tcp_set_bind_address(NULL, NULL);
+	wget_tcp_set_timeout(tcp, 5000);
+
+	snprintf(port, sizeof(port), "%d", wget_test_get_http_server_port());
+	if (wget_tcp_connect(tcp, "127.0.0.1", port) != WGET_E_SUCCESS)
+		wget_error_printf_exit("Failed to connect to the test server\n");
+	if (wget_tcp_write(tcp, request, sizeof(request) - 1) != sizeof(request) - 1
+		|| wget_tcp_read(tcp, buf, sizeof(buf)) <= 0)
+		wget_error_printf_exit("No response from the test server\n");
+	wget_tcp_deinit(&tcp);
+
+	if (strcmp(urls[0].peer, "127.0.0.4"))
+		wget_error_printf_exit("replaced bind address: %s requested from '%s'\n", urls[0].name, urls[0].peer);
+
+	exit(0);
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing --compress-output
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+
+static char *_gzip(const char *data, size_t length, size_t *gzlength)
+{
+	z_stream strm = { .next_in = (unsigned char *) data, .avail_in = (unsigned) length };
+	char *gz;
+
+	if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		wget_error_printf_exit("Failed to initialize zlib\n");
+
+	gz = wget_malloc(deflateBound(&strm, length));
+	strm.next_out = (unsigned char *) gz;
+	strm.avail_out = (unsigned) deflateBound(&strm, length);
+
+	if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+		wget_error_printf_exit("Failed to gzip test data\n");
+
+	*gzlength = strm.total_out;
+	deflateEnd(&strm);
+
+	return gz;
+}
+
+// decompress all gzip members of 'fname' and compare with 'data', returns the compressed size
+static size_t _check_file(const char *fname, const char *data, size_t length)
+{
+	z_stream strm = { .next_in = NULL };
+	wget_buffer_t *out = wget_buffer_alloc(length + 1);
+	size_t size;
+	char *content = wget_read_file(fname, &size);
+	int rc;
+
+	if (!content)
+		wget_error_printf_exit("Failed to read %s\n", fname);
+
+	if (inflateInit2(&strm, 15 + 16) != Z_OK)
+		wget_error_printf_exit("Failed to initialize zlib\n");
+
+	strm.next_in = (unsigned char *) content;
+	strm.avail_in = (unsigned) size;
+
+	while (strm.avail_in) {
+		wget_buffer_ensure_capacity(out, out->length + 16384);
+		strm.next_out = (unsigned char *) out->data + out->length;
+		strm.avail_out = (unsigned) (out->size - out->length);
+
+		rc = inflate(&strm, Z_NO_FLUSH);
+		out->length = out->size - strm.avail_out;
+
+		if (rc == Z_STREAM_END)
+			inflateReset(&strm);
+		else if (rc != Z_OK)
+			wget_error_printf_exit("%s is not a valid gzip file (%d)\n", fname, rc);
+	}
+
+	inflateEnd(&strm);
+
+	if (out->length != length || memcmp(out->data, data, length))
+		wget_error_printf_exit("Unexpected content in %s (%zu bytes, expected %zu)\n", fname, out->length, length);
+
+	wget_buffer_free(&out);
+	wget_xfree(content);
+
+	return size;
+}
+#endif
+
+int main(void)
+{
+#ifdef WITH_ZLIB
+	static const char index_html[] = "<html><body><a href=\"dump.json\">dump</a></body></html>";
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.body = index_html,
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/dump.json",
+			.code = "200 Dontcare",
+			.headers = {
+				"Content-Type: application/json",
+			}
+		},
+		{	.name = "/log.txt",
+			.code = "200 Dontcare",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/data.tar.gz",
+			.code = "200 Dontcare",
+			.headers = {
+				"Content-Type: application/octet-stream",
+			}
+		},
+		{	.name = "/archive",
+			.code = "200 Dontcare",
+			.headers = {
+				"Content-Type: application/gzip",
+			}
+		},
+	};
+	wget_buffer_t *json = wget_buffer_alloc(256 * 1024);
+	wget_buffer_t *log = wget_buffer_alloc(4096);
+	wget_buffer_t *partial = wget_buffer_alloc(4096);
+	char *gz;
+	size_t gz_len, size, half;
+
+	// a large and well compressible body
+	wget_buffer_strcat(json, "[");
+	for (int it = 0; json->length < 200 * 1024; it++)
+		wget_buffer_printf_append(json, "%s{\"id\":%d,\"name\":\"item %d\",\"tags\":[\"a\",\"b\"]}", it ? "," : "", it, it);
+	wget_buffer_strcat(json, "]");
+
+	urls[1].body = json->data;
+	urls[1].body_len = json->length;
+
+	// small enough for a range response of the test server
+	for (int it = 0; log->length < 2048; it++)
+		wget_buffer_printf_append(log, "line %d\n", it);
+
+	urls[2].body = log->data;
+
+	// gzip files, recognized by name and by Content-Type
+	gz = _gzip(log->data, log->length, &gz_len);
+	urls[3].body = urls[4].body = gz;
+	urls[3].body_len = urls[4].body_len = gz_len;
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// files get a .gz suffix and are valid gzip files
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH --compress-output",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "index.html.gz", NULL },
+			{ "dump.json.gz", NULL },
+			{	NULL } },
+		0);
+
+	_check_file("index.html.gz", index_html, strlen(index_html));
+	size = _check_file("dump.json.gz", json->data, json->length);
+	wget_info_printf("dump.json: %zu bytes compressed to %zu bytes\n", json->length, size);
+	if (size * 4 > json->length)
+		wget_error_printf_exit("dump.json.gz is too large (%zu bytes)\n", size);
+
+	// -O keeps the given name
+	wget_test(
+		WGET_TEST_OPTIONS, "--compress-output -O out.json",
+		WGET_TEST_REQUEST_URL, "dump.json",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "out.json", NULL },
+			{	NULL } },
+		0);
+
+	_check_file("out.json", json->data, json->length);
+
+	// -N: an unchanged page is parsed from its compressed copy, the link in it is followed
+	gz = _gzip(index_html, strlen(index_html), &gz_len);
+	urls[0].modified = 1097310600;
+
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH -N --compress-output",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXISTING_FILES, &(wget_test_file_t []) {
+			{ "index.html.gz", gz, 1097310600, gz_len },
+			{	NULL } },
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "index.html.gz", gz, 0, gz_len },
+			{ "dump.json.gz", NULL },
+			{	NULL } },
+		0);
+
+	_check_file("dump.json.gz", json->data, json->length);
+	urls[0].modified = 0;
+	wget_xfree(gz);
+
+	// gzip files are saved as they are, not compressed a second time
+	wget_test(
+		WGET_TEST_OPTIONS, "--compress-output",
+		WGET_TEST_REQUEST_URLS, "data.tar.gz", "archive", NULL,
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "data.tar.gz", gz, 0, gz_len },
+			{ "archive", gz, 0, gz_len },
+			{	NULL } },
+		0);
+
+	wget_xfree(gz);
+
+	// a plain file of an earlier run is continued plain, not cut back or compressed
+	half = log->length / 2;
+	wget_buffer_memcpy(partial, log->data, half);
+
+	wget_test(
+		WGET_TEST_OPTIONS, "--compress-output -c",
+		WGET_TEST_REQUEST_URL, "log.txt",
+		WGET_TEST_EXISTING_FILES, &(wget_test_file_t []) {
+			{ "log.txt", partial->data, 0, partial->length },
+			{	NULL } },
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "log.txt", log->data },
+			{	NULL } },
+		0);
+
+	// an interrupted download: one complete gzip member followed by a truncated one
+	gz = _gzip(log->data, half, &gz_len);
+	wget_buffer_memcpy(partial, gz, gz_len);
+	wget_xfree(gz);
+	gz = _gzip(log->data + half, 100, &gz_len);
+	wget_buffer_memcat(partial, gz, gz_len / 2);
+	wget_xfree(gz);
+
+	// the incomplete member is removed and the download continues behind the complete one
+	wget_test(
+		WGET_TEST_OPTIONS, "--compress-output -c",
+		WGET_TEST_REQUEST_URL, "log.txt",
+		WGET_TEST_EXISTING_FILES, &(wget_test_file_t []) {
+			{ "log.txt.gz", partial->data, 0, partial->length },
+			{	NULL } },
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "log.txt.gz", NULL },
+			{	NULL } },
+		0);
+
+	_check_file("log.txt.gz", log->data, log->length);
+
+	// the complete member has been kept, so only the rest has been requested
+	gz = wget_read_file("log.txt.gz", &size);
+	partial->length -= gz_len / 2;
+	if (!gz || size < partial->length || memcmp(gz, partial->data, partial->length))
+		wget_error_printf_exit("log.txt.gz doesn't start with the complete gzip member\n");
+	wget_xfree(gz);
+
+	wget_buffer_free(&partial);
+	wget_buffer_free(&log);
+	wget_buffer_free(&json);
+#endif
+
+	exit(0);
+}
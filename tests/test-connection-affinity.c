@@ -0,0 +1,138 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Benchmarking connection reuse of several downloaders crawling two hosts
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#define NPAGES 16
+#define NLINKS 5 // files linked by each page
+#define DELAY 50 // response latency in ms
+
+// the test server answers both, so these are two hosts with the same content
+static const char *hosts[2] = { "localhost", "127.0.0.1" };
+
+int main(void)
+{
+	wget_test_url_t urls[1 + NPAGES + NPAGES * NLINKS];
+	wget_test_file_t expected_files[countof(urls) + 2];
+	wget_buffer_t *index = wget_buffer_alloc(4096), *pages[NPAGES];
+	char names[countof(urls)][16], bodies[NPAGES * NLINKS][32];
+	long long start, elapsed;
+	char *log, *p;
+	int nurls = 0, connections = 0, responses = 0;
+
+#ifndef WITH_LIBNGHTTP2
+	exit(77); // the test server keeps connections open for HTTP/2 only
+#endif
+
+	memset(urls, 0, sizeof(urls));
+	memset(expected_files, 0, sizeof(expected_files));
+
+	// an index on the first host links pages on both hosts, each page links files on both hosts
+	wget_buffer_strcpy(index, "<html><body>");
+	nurls = 1 + NPAGES;
+
+	for (int it = 0; it < NPAGES; it++) {
+		snprintf(names[1 + it], sizeof(names[1 + it]), "/p%d.html", it);
+		wget_buffer_printf_append(index, "<a href=\"http://%s:{{port}}%s\">%d</a>", hosts[it % 2], names[1 + it], it);
+
+		pages[it] = wget_buffer_alloc(1024);
+		wget_buffer_strcpy(pages[it], "<html><body>");
+
+		for (int n = 0; n < NLINKS; n++) {
+			int f = it * NLINKS + n;
+
+			snprintf(names[nurls], sizeof(names[nurls]), "/f%d.txt", f);
+			snprintf(bodies[f], sizeof(bodies[f]), "file %d", f);
+			wget_buffer_printf_append(pages[it], "<a href=\"http://%s:{{port}}%s\">%d</a>", hosts[f % 2], names[nurls], f);
+
+			urls[nurls].name = names[nurls];
+			urls[nurls].code = "200 Dontcare";
+			urls[nurls].body = bodies[f];
+			urls[nurls].headers[0] = "Content-Type: text/plain";
+			nurls++;
+		}
+
+		wget_buffer_strcat(pages[it], "</body></html>");
+
+		urls[1 + it].name = names[1 + it];
+		urls[1 + it].code = "200 Dontcare";
+		urls[1 + it].body = pages[it]->data;
+		urls[1 + it].headers[0] = "Content-Type: text/html";
+	}
+	wget_buffer_strcat(index, "</body></html>");
+
+	urls[0].name = "/index.html";
+	urls[0].code = "200 Dontcare";
+	urls[0].body = index->data;
+	urls[0].headers[0] = "Content-Type: text/html";
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		WGET_TEST_SERVER_RESPONSE_DELAY, DELAY,
+		0);
+
+	// bodies have their {{port}} replaced now
+	for (int it = 0; it < nurls; it++) {
+		expected_files[it].name = urls[it].name + 1;
+		expected_files[it].content = urls[it].body;
+	}
+	expected_files[nurls].name = "affinity.log";
+
+	start = wget_get_timemillis();
+
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH -H --max-threads=4 --http2-prior-knowledge=* -o affinity.log",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+
+	elapsed = wget_get_timemillis() - start;
+
+	if (!(log = wget_read_file("affinity.log", NULL)))
+		wget_error_printf_exit("Failed to read affinity.log\n");
+	if (!(p = strstr(log, "Connections: ")) || sscanf(p, "Connections: %d opened for %d responses", &connections, &responses) != 2)
+		wget_error_printf_exit("Missing connection statistics in affinity.log\n");
+	wget_xfree(log);
+
+	wget_info_printf("%d connections for %d responses from %d hosts in %lld ms\n",
+		connections, responses, (int) countof(hosts), elapsed);
+
+	// a downloader keeps its connection while its host has work, instead of reconnecting per file
+	if (connections * 4 > responses)
+		wget_error_printf_exit("Too many connections (%d for %d responses)\n", connections, responses);
+
+	for (int it = 0; it < NPAGES; it++)
+		wget_buffer_free(&pages[it]);
+	wget_buffer_free(&index);
+
+	exit(0);
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing --host-health-file with a host refusing connections
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include <time.h>
+#include "libtest.h"
+
+#define OPTIONS "-r -nH --tries=2 --host-health-file=health.txt -o health.log"
+
+typedef struct {
+	int
+		failures;
+	char
+		error[16];
+	long long
+		backoff;
+} health_t;
+
+static wget_test_file_t
+	expected_files[5];
+
+// get the entry for localhost:'port' from the health file of the last run, returns 0 if there is none
+static int _find_health(int port, health_t *health)
+{
+	char *data, *line, hostname[256];
+	long long last_failure;
+	int entry_port, found = 0;
+
+	if (!(data = wget_read_file("health.txt", NULL)))
+		wget_error_printf_exit("Failed to read health.txt\n");
+
+	for (line = strtok(data, "\n"); line; line = strtok(NULL, "\n")) {
+		if (sscanf(line, "http %255s %d %d %15s %lld %lld", hostname, &entry_port, &health->failures, health->error,
+			&last_failure, &health->backoff) == 6
+			&& !strcmp(hostname, "localhost") && entry_port == port)
+		{
+			found = 1;
+			break;
+		}
+	}
+
+	wget_xfree(data);
+
+	return found;
+}
+
+static void _get_health(int port, health_t *health)
+{
+	if (!_find_health(port, health))
+		wget_error_printf_exit("No health entry for port %d\n", port);
+}
+
+// run with 'health' as content of the health file, NULL to start without
+static void _run(const char *health)
+{
+	wget_test_file_t existing_files[2] = { { NULL } };
+
+	if (health)
+		existing_files[0] = (wget_test_file_t) { "health.txt", health };
+
+	wget_test(
+		WGET_TEST_OPTIONS, OPTIONS,
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXISTING_FILES, existing_files,
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/ok.txt",
+			.code = "200 Dontcare",
+			.body = "ok",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+	};
+	wget_tcp_t *tcp = wget_tcp_init();
+	char index[256], existing[512], *log;
+	health_t health;
+	int dead_port;
+
+	// a port nobody listens on, connections are refused
+	if (wget_tcp_listen(tcp, "localhost", NULL, 5) != 0)
+		wget_error_printf_exit("Failed to get a free port\n");
+	dead_port = wget_tcp_get_local_port(tcp);
+	wget_tcp_deinit(&tcp);
+
+	snprintf(index, sizeof(index),
+		"<html><body><a href=\"ok.txt\">ok</a><a href=\"http://localhost:%d/dead.txt\">dead</a></body></html>", dead_port);
+	urls[0].body = index;
+
+	expected_files[0] = (wget_test_file_t) { urls[0].name + 1, urls[0].body };
+	expected_files[1] = (wget_test_file_t) { urls[1].name + 1, urls[1].body };
+	expected_files[2] = (wget_test_file_t) { "health.txt", NULL };
+	expected_files[3] = (wget_test_file_t) { "health.log", NULL };
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// first run: the host is blocked after --tries failures
+	_run(NULL);
+
+	_get_health(dead_port, &health);
+	if (health.failures != 2 || strcmp(health.error, "refused") || health.backoff != 60)
+		wget_error_printf_exit("First run: %d failures (%s), backoff %lld\n", health.failures, health.error, health.backoff);
+
+	// healthy hosts are not written
+	if (_find_health(wget_test_get_http_server_port(), &health))
+		wget_error_printf_exit("First run: the test server has an entry (%d failures)\n", health.failures);
+
+	// second run: the host is skipped without trying, the test server is back and its entry is removed
+	snprintf(existing, sizeof(existing), "http localhost %d 2 refused %lld 60\nhttp localhost %d 2 timeout %lld 60\n",
+		dead_port, (long long) time(NULL), wget_test_get_http_server_port(), (long long) time(NULL) - 3600);
+	_run(existing);
+
+	if (_find_health(wget_test_get_http_server_port(), &health))
+		wget_error_printf_exit("Second run: the entry of the test server has not been removed\n");
+
+	_get_health(dead_port, &health);
+	if (health.failures != 2 || health.backoff != 60)
+		wget_error_printf_exit("Second run: %d failures, backoff %lld\n", health.failures, health.backoff);
+
+	if (!(log = wget_read_file("health.log", NULL)))
+		wget_error_printf_exit("Failed to read health.log\n");
+	if (!strstr(log, "skipped for"))
+		wget_error_printf_exit("Second run: the host has not been skipped\n");
+	wget_xfree(log);
+
+	// third run: after the backoff time, a single try doubles the backoff
+	snprintf(existing, sizeof(existing), "http localhost %d 2 refused %lld 60\n", dead_port, (long long) time(NULL) - 3600);
+	_run(existing);
+
+	_get_health(dead_port, &health);
+	if (health.failures != 3 || strcmp(health.error, "refused") || health.backoff != 120)
+		wget_error_printf_exit("Third run: %d failures (%s), backoff %lld\n", health.failures, health.error, health.backoff);
+
+	exit(0);
+}
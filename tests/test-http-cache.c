@@ -0,0 +1,184 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing --cache-dir (persistent HTTP cache)
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "libtest.h"
+
+// the cache has to survive between the test runs, so it is kept outside of the test directory
+static void _remove_cache(const char *dirname)
+{
+	DIR *dir;
+	struct dirent *dp;
+
+	if ((dir = opendir(dirname))) {
+		while ((dp = readdir(dir))) {
+			char fname[strlen(dirname) + strlen(dp->d_name) + 2];
+			struct stat st;
+
+			if (!strcmp(dp->d_name, ".") || !strcmp(dp->d_name, ".."))
+				continue;
+
+			snprintf(fname, sizeof(fname), "%s/%s", dirname, dp->d_name);
+
+			if (stat(fname, &st) == 0 && S_ISDIR(st.st_mode))
+				_remove_cache(fname);
+			else
+				unlink(fname);
+		}
+
+		closedir(dir);
+		rmdir(dirname);
+	}
+}
+
+static void _check_requests(const wget_test_url_t *urls, size_t nurls, const int *expected, const char *run)
+{
+	for (size_t it = 0; it < nurls; it++) {
+		if (urls[it].requests != expected[it])
+			wget_error_printf_exit("%s: %s requested %d times, expected %d\n", run, urls[it].name, urls[it].requests, expected[it]);
+	}
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/fresh.html",
+			.code = "200 Dontcare",
+			.body = "<html><body><a href=\"sub.html\">sub page</a></body></html>",
+			.headers = {
+				"Content-Type: text/html",
+				"Cache-Control: max-age=3600",
+			}
+		},
+		{	.name = "/sub.html",
+			.code = "200 Dontcare",
+			.body = "sub page",
+			.headers = {
+				"Cache-Control: max-age=3600",
+			}
+		},
+		{	.name = "/etag.html",
+			.code = "200 Dontcare",
+			.body = "revalidated by ETag",
+			.headers = {
+				"Cache-Control: no-cache",
+				"ETag: \"abc\"",
+			}
+		},
+		{	.name = "/lastmod.html",
+			.code = "200 Dontcare",
+			.body = "revalidated by Last-Modified",
+			.headers = {
+				"Cache-Control: max-age=0",
+				"Last-Modified: Sat, 09 Oct 2004 08:30:00 GMT",
+			},
+			.modified = 1097310600
+		},
+		{	.name = "/nostore.html",
+			.code = "200 Dontcare",
+			.body = "never stored",
+			.headers = {
+				"Cache-Control: no-store",
+				"ETag: \"def\"",
+			}
+		},
+	};
+	char cache_dir[64], options[256];
+
+	snprintf(cache_dir, sizeof(cache_dir), ".test_cache_%d", (int) getpid());
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// wget2 runs in the test directory, one level below
+	snprintf(options, sizeof(options), "-r -nH --cache-dir=../%s", cache_dir);
+
+	// first run fills the cache
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URLS, "fresh.html", "etag.html", "lastmod.html", "nostore.html", NULL,
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[3].body },
+			{ urls[4].name + 1, urls[4].body },
+			{	NULL } },
+		0);
+
+	_check_requests(urls, countof(urls), (int []) { 1, 1, 1, 1, 1 }, "first run");
+
+	// fresh entries (also the one found by parsing a cached page) are served without a request,
+	// stale ones are revalidated (304) and written from the cache
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URLS, "fresh.html", "etag.html", "lastmod.html", "nostore.html", NULL,
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[3].body },
+			{ urls[4].name + 1, urls[4].body },
+			{	NULL } },
+		0);
+
+	_check_requests(urls, countof(urls), (int []) { 1, 1, 2, 2, 2 }, "second run");
+
+	// --no-cache: nothing is served without asking the server
+	snprintf(options, sizeof(options), "-r -nH --no-cache --cache-dir=../%s", cache_dir);
+
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URLS, "fresh.html", "etag.html", "lastmod.html", "nostore.html", NULL,
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[3].body },
+			{ urls[4].name + 1, urls[4].body },
+			{	NULL } },
+		0);
+
+	_check_requests(urls, countof(urls), (int []) { 2, 2, 3, 3, 3 }, "--no-cache run");
+
+	// wget_test_stop_server() is called at exit and changes to the parent directory,
+	// we are still in the test directory here
+	snprintf(options, sizeof(options), "../%s", cache_dir);
+	_remove_cache(options);
+
+	exit(0);
+}
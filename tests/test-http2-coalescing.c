@@ -0,0 +1,131 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing HTTP/2 connection coalescing of host names sharing address and certificate
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#define NFILES 10
+
+// both names resolve to the test server's address and are covered by its certificate
+static const char *hosts[2] = { "localhost", "127.0.0.1" };
+
+static wget_test_file_t
+	expected_files[NFILES + 3];
+
+static int _run(const char *options, const char *misdirected)
+{
+	char cmd[512], *log, *p;
+	int connections = 0;
+
+	snprintf(cmd, sizeof(cmd), "-r -nH -H %s -o coalescing.log https://localhost:%d/index.html",
+		options, wget_test_get_https_server_port());
+
+	wget_test(
+		WGET_TEST_OPTIONS, cmd,
+		WGET_TEST_REQUEST_URL, NULL,
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		WGET_TEST_H2_MISDIRECTED, misdirected,
+		0);
+
+	if (!(log = wget_read_file("coalescing.log", NULL)))
+		wget_error_printf_exit("Failed to read coalescing.log\n");
+	if (!(p = strstr(log, "Connections: ")) || sscanf(p, "Connections: %d opened", &connections) != 1)
+		wget_error_printf_exit("Missing connection statistics in coalescing.log\n");
+	wget_xfree(log);
+
+	wget_info_printf("%s: %d connections\n", options, connections);
+
+	return connections;
+}
+
+int main(void)
+{
+	wget_test_url_t urls[NFILES + 1];
+	wget_buffer_t *index = wget_buffer_alloc(1024);
+	char names[NFILES][16], bodies[NFILES][32];
+	int connections;
+
+#if !defined WITH_GNUTLS || !defined WITH_LIBNGHTTP2
+	exit(77);
+#endif
+
+	memset(urls, 0, sizeof(urls));
+
+	// the index links files on both host names
+	wget_buffer_strcpy(index, "<html><body>");
+	for (int it = 0; it < NFILES; it++) {
+		snprintf(names[it], sizeof(names[it]), "/f%d.txt", it);
+		snprintf(bodies[it], sizeof(bodies[it]), "file %d", it);
+		wget_buffer_printf_append(index, "<a href=\"https://%s:{{sslport}}%s\">%d</a>", hosts[it % 2], names[it], it);
+
+		urls[it + 1].name = names[it];
+		urls[it + 1].code = "200 Dontcare";
+		urls[it + 1].body = bodies[it];
+		urls[it + 1].headers[0] = "Content-Type: text/plain";
+	}
+	wget_buffer_strcat(index, "</body></html>");
+
+	urls[0].name = "/index.html";
+	urls[0].code = "200 Dontcare";
+	urls[0].body = index->data;
+	urls[0].headers[0] = "Content-Type: text/html";
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		WGET_TEST_H2_MAX_STREAMS, 100,
+		0);
+
+	// the index body has its {{sslport}} replaced now
+	for (int it = 0; it < NFILES + 1; it++) {
+		expected_files[it].name = urls[it].name + 1;
+		expected_files[it].content = urls[it].body;
+	}
+	expected_files[NFILES + 1].name = "coalescing.log";
+
+	// the connection to localhost also serves 127.0.0.1
+	if ((connections = _run("--ca-certificate=" SRCDIR "/certs/x509-ca-cert.pem --no-ocsp", NULL)) != 1)
+		wget_error_printf_exit("%d connections, expected a single coalesced one\n", connections);
+
+	// without certificate checking, a certificate doesn't prove anything about other host names
+	if ((connections = _run("--no-check-certificate", NULL)) != 2)
+		wget_error_printf_exit("%d connections, expected one per host name\n", connections);
+
+	// a server answering 421 for 127.0.0.1 on the coalesced connection gets the requests again on a connection of its own
+	connections = _run("--ca-certificate=" SRCDIR "/certs/x509-ca-cert.pem --no-ocsp", "127.0.0.1");
+	if (!wget_test_get_h2_misdirected_requests())
+		wget_error_printf_exit("No request has been misdirected\n");
+	if (connections < 2)
+		wget_error_printf_exit("%d connections, expected another one for the misdirected host name\n", connections);
+
+	wget_buffer_free(&index);
+
+	exit(0);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing HTTP/2 over plain TCP with prior knowledge (--http2-prior-knowledge)
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#define NFILES 10
+#define DELAY 50 // response latency in ms
+
+static wget_test_file_t
+	expected_files[NFILES + 2];
+
+static int _run(const char *options)
+{
+	int peak;
+
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+
+	peak = wget_test_get_h2_peak_streams();
+	wget_info_printf("%s: %d HTTP/2 streams at most\n", options, peak);
+
+	return peak;
+}
+
+int main(void)
+{
+	wget_test_url_t urls[NFILES + 1];
+	wget_buffer_t *index = wget_buffer_alloc(1024);
+	char names[NFILES][16], bodies[NFILES][32];
+	int peak;
+
+#ifndef WITH_LIBNGHTTP2
+	exit(77);
+#endif
+
+	memset(urls, 0, sizeof(urls));
+
+	wget_buffer_strcpy(index, "<html><body>");
+	for (int it = 0; it < NFILES; it++) {
+		snprintf(names[it], sizeof(names[it]), "/f%d.txt", it);
+		snprintf(bodies[it], sizeof(bodies[it]), "file %d", it);
+		wget_buffer_printf_append(index, "<a href=\"%s\">%d</a>", names[it] + 1, it);
+
+		urls[it + 1].name = names[it];
+		urls[it + 1].code = "200 Dontcare";
+		urls[it + 1].body = bodies[it];
+		urls[it + 1].headers[0] = "Content-Type: text/plain";
+
+		expected_files[it + 1].name = names[it] + 1;
+		expected_files[it + 1].content = bodies[it];
+	}
+	wget_buffer_strcat(index, "</body></html>");
+
+	urls[0].name = "/index.html";
+	urls[0].code = "200 Dontcare";
+	urls[0].body = index->data;
+	urls[0].headers[0] = "Content-Type: text/html";
+
+	expected_files[0].name = "index.html";
+	expected_files[0].content = index->data;
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		WGET_TEST_SERVER_RESPONSE_DELAY, DELAY,
+		0);
+
+	// the links are requested in parallel over one plain TCP connection
+	if ((peak = _run("-r -nH --http2-prior-knowledge=localhost")) < 2)
+		wget_error_printf_exit("No multiplexing with HTTP/2 prior knowledge (%d streams at most)\n", peak);
+
+	if ((peak = _run("-r -nH --http2-prior-knowledge=*")) < 2)
+		wget_error_printf_exit("No multiplexing with HTTP/2 prior knowledge for all hosts (%d streams at most)\n", peak);
+
+	// other hosts and --no-http2 keep HTTP/1.1
+	if ((peak = _run("-r -nH --http2-prior-knowledge=.example.com")) != 0)
+		wget_error_printf_exit("HTTP/2 used for a host not in the list\n");
+
+	if ((peak = _run("-r -nH --http2-prior-knowledge=localhost --no-http2")) != 0)
+		wget_error_printf_exit("HTTP/2 used in spite of --no-http2\n");
+
+	wget_buffer_free(&index);
+
+	exit(0);
+}
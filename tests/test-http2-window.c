@@ -0,0 +1,124 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing the HTTP/2 request window against servers with different stream limits
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#define NFILES 40
+#define DELAY 100 // response latency in ms
+
+static wget_test_file_t
+	existing_files[2],
+	expected_files[NFILES + 2];
+
+static void _run(int max_streams, const char *window_option, int min_peak, int max_peak)
+{
+	char options[256];
+	int peak, refused;
+
+	snprintf(options, sizeof(options), "--ca-certificate=" SRCDIR "/certs/x509-ca-cert.pem --no-ocsp %s -i urls.txt",
+		window_option);
+
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URL, NULL,
+		WGET_TEST_H2_MAX_STREAMS, max_streams,
+		WGET_TEST_EXISTING_FILES, existing_files,
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+
+	peak = wget_test_get_h2_peak_streams();
+	refused = wget_test_get_h2_refused_streams();
+
+	wget_info_printf("%d streams allowed, %s: %d streams at most, %d refused\n",
+		max_streams, window_option, peak, refused);
+
+	// no request may be sent before the server's SETTINGS have been seen
+	if (refused)
+		wget_error_printf_exit("%d streams refused by a server allowing %d\n", refused, max_streams);
+
+	if (peak < min_peak || peak > max_peak)
+		wget_error_printf_exit("%d parallel streams, expected %d to %d\n", peak, min_peak, max_peak);
+}
+
+int main(void)
+{
+	wget_test_url_t urls[NFILES];
+	wget_buffer_t *list = wget_buffer_alloc(4096);
+	char names[NFILES][16], bodies[NFILES][32];
+
+#if !defined WITH_GNUTLS || !defined WITH_LIBNGHTTP2
+	exit(77);
+#endif
+
+	memset(urls, 0, sizeof(urls));
+
+	for (int it = 0; it < NFILES; it++) {
+		snprintf(names[it], sizeof(names[it]), "/f%d.txt", it);
+		snprintf(bodies[it], sizeof(bodies[it]), "file %d", it);
+
+		urls[it].name = names[it];
+		urls[it].code = "200 Dontcare";
+		urls[it].body = bodies[it];
+		urls[it].headers[0] = "Content-Type: text/plain";
+
+		expected_files[it].name = names[it] + 1;
+		expected_files[it].content = bodies[it];
+	}
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		WGET_TEST_SERVER_RESPONSE_DELAY, DELAY,
+		WGET_TEST_H2_MAX_STREAMS, 100,
+		0);
+
+	// all URLs are known from the start, so a fixed window would send them before the server's SETTINGS arrive
+	for (int it = 0; it < NFILES; it++)
+		wget_buffer_printf_append(list, "https://localhost:%d%s\n", wget_test_get_https_server_port(), names[it]);
+
+	existing_files[0].name = "urls.txt";
+	existing_files[0].content = list->data;
+	expected_files[NFILES].name = "urls.txt";
+	expected_files[NFILES].content = list->data;
+
+	// a small server limit is respected from the first request on (before its SETTINGS, 4 streams are assumed)
+	_run(4, "", 2, 4);
+
+	// a large server limit is used up to --http2-request-window (default 30)
+	_run(100, "", 8, 30);
+
+	// the user setting caps the window
+	_run(100, "--http2-request-window=2", 1, 2);
+
+	wget_buffer_free(&list);
+
+	exit(0);
+}
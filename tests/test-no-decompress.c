@@ -0,0 +1,174 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing --no-decompress (saving Content-Encoded bodies as received)
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+
+static char *_gzip(const char *data, size_t length, size_t *gzlength)
+{
+	z_stream strm = { .next_in = (unsigned char *) data, .avail_in = (unsigned) length };
+	char *gz;
+
+	if (deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		wget_error_printf_exit("Failed to initialize zlib\n");
+
+	gz = wget_malloc(deflateBound(&strm, length));
+	strm.next_out = (unsigned char *) gz;
+	strm.avail_out = (unsigned) deflateBound(&strm, length);
+
+	if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+		wget_error_printf_exit("Failed to gzip test data\n");
+
+	*gzlength = strm.total_out;
+	deflateEnd(&strm);
+
+	return gz;
+}
+
+static void _check_file(const char *fname, const char *data, size_t length)
+{
+	size_t size;
+	char *content = wget_read_file(fname, &size);
+
+	if (!content)
+		wget_error_printf_exit("Failed to read %s\n", fname);
+
+	if (size != length || memcmp(content, data, length))
+		wget_error_printf_exit("Unexpected content in %s (%zu bytes, expected %zu)\n", fname, size, length);
+
+	wget_xfree(content);
+}
+#endif
+
+int main(void)
+{
+#ifdef WITH_ZLIB
+	static const char index_html[] = "<html><body><a href=\"dump.json\">dump</a></body></html>";
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.headers = {
+				"Content-Type: text/html",
+				"Content-Encoding: gzip",
+			}
+		},
+		{	.name = "/dump.json",
+			.code = "200 Dontcare",
+			.headers = {
+				"Content-Type: application/json",
+				"Content-Encoding: gzip",
+			}
+		},
+	};
+	wget_buffer_t *json = wget_buffer_alloc(256 * 1024);
+	char *gz_index, *gz_json;
+	size_t gz_index_len, gz_json_len;
+
+	// a large and well compressible body
+	wget_buffer_strcat(json, "[");
+	for (int it = 0; json->length < 200 * 1024; it++)
+		wget_buffer_printf_append(json, "%s{\"id\":%d,\"name\":\"item %d\",\"tags\":[\"a\",\"b\"]}", it ? "," : "", it, it);
+	wget_buffer_strcat(json, "]");
+
+	gz_index = _gzip(index_html, strlen(index_html), &gz_index_len);
+	gz_json = _gzip(json->data, json->length, &gz_json_len);
+
+	urls[0].body = gz_index;
+	urls[0].body_len = gz_index_len;
+	urls[1].body = gz_json;
+	urls[1].body_len = gz_json_len;
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// default: everything is decompressed
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "index.html", index_html },
+			{ "dump.json", NULL },
+			{	NULL } },
+		0);
+
+	_check_file("dump.json", json->data, json->length);
+
+	// the HTML page is still decompressed to be parsed, the JSON dump is written as received
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH --no-decompress",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "index.html", index_html },
+			{ "dump.json.gz", NULL },
+			{	NULL } },
+		0);
+
+	_check_file("dump.json.gz", gz_json, gz_json_len);
+
+	// without recursion nothing is parsed, -O keeps the given name
+	wget_test(
+		WGET_TEST_OPTIONS, "--no-decompress -O out.gz",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "out.gz", NULL },
+			{	NULL } },
+		0);
+
+	_check_file("out.gz", gz_index, gz_index_len);
+
+	// -N: the copy saved with the encoding suffix is found, so it is not downloaded again
+	urls[1].modified = 1097310600;
+
+	wget_test(
+		WGET_TEST_OPTIONS, "--no-decompress -N",
+		WGET_TEST_REQUEST_URL, "dump.json",
+		WGET_TEST_EXISTING_FILES, &(wget_test_file_t []) {
+			{ "dump.json.gz", "not modified", 1097310600 },
+			{	NULL } },
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "dump.json.gz", "not modified" },
+			{	NULL } },
+		0);
+
+	wget_buffer_free(&json);
+	wget_xfree(gz_json);
+	wget_xfree(gz_index);
+#endif
+
+	exit(0);
+}
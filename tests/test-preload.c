@@ -0,0 +1,131 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing --page-requisites with Link: rel=preload and 103 Early Hints
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h> // exit()
+#include <sys/stat.h>
+#include "libtest.h"
+
+#define BODY_DELAY 2000 // ms
+
+static void _check_requests(const wget_test_url_t *urls, size_t nurls, const char *run)
+{
+	for (size_t it = 0; it < nurls; it++) {
+		if (urls[it].requests != 1)
+			wget_error_printf_exit("%s: %s requested %d times, expected once\n", run, urls[it].name, urls[it].requests);
+	}
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.body =
+				"<html><head>"
+				"<link rel=\"stylesheet\" href=\"style.css\">"
+				"<script src=\"script.js\"></script>"
+				"</head><body>page</body></html>",
+			.headers = {
+				"Content-Type: text/html",
+				"Link: </style.css>; rel=preload; as=style, </script.js>; rel=preload; as=script",
+			},
+			.early_hints = {
+				"Link: </font.woff>; rel=preload; as=font",
+			},
+			.body_delay = BODY_DELAY,
+		},
+		{	.name = "/style.css",
+			.code = "200 Dontcare",
+			.body = "body { }",
+			.headers = {
+				"Content-Type: text/css",
+			}
+		},
+		{	.name = "/script.js",
+			.code = "200 Dontcare",
+			.body = "var x;",
+			.headers = {
+				"Content-Type: application/javascript",
+			}
+		},
+		{	.name = "/font.woff",
+			.code = "200 Dontcare",
+			.body = "font",
+			.headers = {
+				"Content-Type: font/woff",
+			}
+		},
+	};
+	wget_test_file_t expected_files[countof(urls) + 1] = { { NULL } };
+	struct stat st_index, st;
+
+	for (size_t it = 0; it < countof(urls); it++) {
+		expected_files[it].name = urls[it].name + 1;
+		expected_files[it].content = urls[it].body;
+	}
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		WGET_TEST_SERVER_RESPONSE_DELAY, 10, // answer requests by several threads
+		0);
+
+	// the requisites are requested as soon as the header of index.html arrives
+	wget_test(
+		WGET_TEST_OPTIONS, "-p -nH --max-threads=4",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+
+	_check_requests(urls, countof(urls), "HTTP/1.1");
+
+	// without preloading, the requisites would be written after the delayed body of index.html
+	if (stat("index.html", &st_index))
+		wget_error_printf_exit("Failed to stat index.html\n");
+	for (size_t it = 1; it < countof(urls); it++) {
+		if (stat(urls[it].name + 1, &st) || st.st_mtime >= st_index.st_mtime)
+			wget_error_printf_exit("%s has not been downloaded ahead of the body of index.html\n", urls[it].name + 1);
+	}
+
+#ifdef WITH_LIBNGHTTP2
+	for (size_t it = 0; it < countof(urls); it++)
+		urls[it].requests = 0;
+
+	// the 103 response is followed by the final response on the same stream
+	wget_test(
+		WGET_TEST_OPTIONS, "-p -nH --http2-prior-knowledge=localhost",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+
+	_check_requests(urls, countof(urls), "HTTP/2");
+#endif
+
+	exit(0);
+}
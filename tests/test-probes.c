@@ -0,0 +1,96 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing that the static tracepoints (USDT) are compiled into the binaries
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#ifdef ENABLE_PROBES
+static int _contains(const char *data, size_t size, const char *s, size_t len)
+{
+	for (const char *p = data; (p = memchr(p, *s, data + size - p)); p++) {
+		if ((size_t) (data + size - p) >= len && !memcmp(p, s, len))
+			return 1;
+	}
+
+	return 0;
+}
+
+// each probe has a .note.stapsdt entry containing "<provider>\0<name>\0"
+static int _has_probe(const char *data, size_t size, const char *name)
+{
+	char pattern[64];
+	size_t namelen = strlen(name);
+
+	memcpy(pattern, "wget", 5);
+	memcpy(pattern + 5, name, namelen + 1);
+
+	return _contains(data, size, pattern, namelen + 6);
+}
+#endif
+
+int main(void)
+{
+#ifdef ENABLE_PROBES
+	static const char *probes[] = {
+		"job_dequeue", "url_enqueue", "url_blacklist", "file_open", "file_close",
+		"tcp_connect_start", "tcp_connect_end", "tls_handshake_start", "tls_handshake_end",
+		"http_request_send", "http_response_first_byte", "http_response_done",
+	};
+	// libwget is either linked into wget2 or a shared library of its own
+	static const char *binaries[] = {
+		"../src/wget2_noinstall" EXEEXT,
+		"../libwget/.libs/libwget.so",
+	};
+	wget_buffer_t *data = wget_buffer_alloc(1024 * 1024);
+
+	for (unsigned it = 0; it < countof(binaries); it++) {
+		size_t size;
+		char *content = wget_read_file(binaries[it], &size);
+
+		if (content) {
+			wget_buffer_memcat(data, content, size);
+			wget_xfree(content);
+		} else if (it == 0)
+			wget_error_printf_exit("Failed to read %s\n", binaries[it]);
+	}
+
+	if (!_contains(data->data, data->length, "stapsdt", 7))
+		wget_error_printf_exit("No .note.stapsdt section found\n");
+
+	for (unsigned it = 0; it < countof(probes); it++) {
+		if (!_has_probe(data->data, data->length, probes[it]))
+			wget_error_printf_exit("Probe wget:%s not found\n", probes[it]);
+	}
+
+	wget_buffer_free(&data);
+
+	exit(0);
+#else
+	exit(77); // built without sys/sdt.h or with --disable-probes
+#endif
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing proxy selection (failing proxies are avoided and retried after ejection)
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h> // snprintf()
+#include <stdlib.h> // exit()
+#include "libtest.h"
+
+static wget_thread_mutex_t
+	mutex = WGET_THREAD_MUTEX_INITIALIZER;
+static int
+	accepted; // number of connections accepted by the dropping proxy
+
+// a proxy that accepts connections, reads the request and closes without an answer
+static void *_dropping_proxy(void *ctx)
+{
+	wget_tcp_t *parent_tcp = ctx, *tcp;
+	char buf[1024];
+
+	while ((tcp = wget_tcp_accept(parent_tcp))) {
+		wget_thread_mutex_lock(&mutex);
+		accepted++;
+		wget_thread_mutex_unlock(&mutex);
+
+		wget_tcp_read(tcp, buf, sizeof(buf));
+		wget_tcp_deinit(&tcp);
+	}
+
+	return NULL;
+}
+
+static int _get_accepted(void)
+{
+	int n;
+
+	wget_thread_mutex_lock(&mutex);
+	n = accepted;
+	accepted = 0;
+	wget_thread_mutex_unlock(&mutex);
+
+	return n;
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.body = "<html><a href=\"page1.html\">1</a><a href=\"page2.html\">2</a></html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/page1.html",
+			.code = "200 Dontcare",
+			.body = "<html>page1</html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/page2.html",
+			.code = "200 Dontcare",
+			.body = "<html>page2</html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+	};
+	wget_tcp_t *tcp = wget_tcp_init();
+	wget_thread_t tid;
+	char options[256];
+	int drop_port, n;
+
+	if (wget_tcp_listen(tcp, "localhost", NULL, 5) != 0)
+		wget_error_printf_exit("Failed to listen for the dropping proxy\n");
+	drop_port = wget_tcp_get_local_port(tcp);
+	if (wget_thread_start(&tid, _dropping_proxy, tcp, 0) != 0)
+		wget_error_printf_exit("Failed to start the dropping proxy\n");
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// the first proxy drops connections, the test server serves as second (working) proxy
+	snprintf(options, sizeof(options), "-r -nH --waitretry=0 --http-proxy=localhost:%d,localhost:%d",
+		drop_port, wget_test_get_http_server_port());
+
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{	NULL } },
+		0);
+
+	// each file has been requested once through the working proxy
+	for (size_t it = 0; it < countof(urls); it++) {
+		if (urls[it].requests != 1)
+			wget_error_printf_exit("%s requested %d times, expected once\n", urls[it].name, urls[it].requests);
+	}
+
+	// after its first failure, the dropping proxy is not used while the working one is faster
+	if ((n = _get_accepted()) != 1)
+		wget_error_printf_exit("Dropping proxy used %d times, expected once\n", n);
+
+	for (size_t it = 0; it < countof(urls); it++)
+		urls[it].requests = 0;
+
+	// with the dropping proxy only, it stays in use after being ejected (3 failures)
+	snprintf(options, sizeof(options), "--tries=4 --waitretry=0 --http-proxy=localhost:%d", drop_port);
+
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{	NULL } },
+		0);
+
+	if ((n = _get_accepted()) != 4)
+		wget_error_printf_exit("Dropping proxy used %d times, expected 4 times\n", n);
+
+	if (urls[0].requests)
+		wget_error_printf_exit("%s requested %d times, expected none\n", urls[0].name, urls[0].requests);
+
+	exit(0);
+}
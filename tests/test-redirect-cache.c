@@ -0,0 +1,218 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing that --redirect-cache follows known permanent redirects without requests
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#define OPTIONS "-r -nH --redirect-cache --redirect-cache-file=redirects.txt"
+
+static void _check_requests(const wget_test_url_t *urls, size_t nurls, const int *expected, const char *run)
+{
+	for (size_t it = 0; it < nurls; it++) {
+		if (urls[it].requests != expected[it])
+			wget_error_printf_exit("%s: %s requested %d times, expected %d\n", run, urls[it].name, urls[it].requests, expected[it]);
+	}
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.body =
+				"<html><body>"
+				"<a href=\"old.html\">old</a>"
+				"<a href=\"chain1.html\">chain</a>"
+				"<a href=\"temp.html\">temporary</a>"
+				"<a href=\"nostore.html\">not stored</a>"
+				"<a href=\"short.html\">short-lived</a>"
+				"</body></html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/old.html",
+			.code = "301 Moved Permanently",
+			.headers = {
+				"Location: http://localhost:{{port}}/new.html",
+			}
+		},
+		{	.name = "/new.html",
+			.code = "200 Dontcare",
+			.body = "new",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/chain1.html",
+			.code = "301 Moved Permanently",
+			.headers = {
+				"Location: http://localhost:{{port}}/chain2.html",
+			}
+		},
+		{	.name = "/chain2.html",
+			.code = "308 Permanent Redirect",
+			.headers = {
+				"Location: http://localhost:{{port}}/final.html",
+			}
+		},
+		{	.name = "/final.html",
+			.code = "200 Dontcare",
+			.body = "final",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/temp.html",
+			.code = "302 Found",
+			.headers = {
+				"Location: http://localhost:{{port}}/temp-target.html",
+			}
+		},
+		{	.name = "/temp-target.html",
+			.code = "200 Dontcare",
+			.body = "temporary",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/nostore.html",
+			.code = "301 Moved Permanently",
+			.headers = {
+				"Location: http://localhost:{{port}}/nostore-target.html",
+				"Cache-Control: no-store",
+			}
+		},
+		{	.name = "/nostore-target.html",
+			.code = "200 Dontcare",
+			.body = "not stored",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/short.html",
+			.code = "301 Moved Permanently",
+			.headers = {
+				"Location: http://localhost:{{port}}/short-target.html",
+				"Cache-Control: max-age=600",
+			}
+		},
+		{	.name = "/short-target.html",
+			.code = "200 Dontcare",
+			.body = "short-lived",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+	};
+	char *redirects, *p;
+	long long created, maxage;
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// first run: the redirects are followed by the server's responses and the permanent ones are stored
+	wget_test(
+		WGET_TEST_OPTIONS, OPTIONS,
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[5].body },
+			{ urls[6].name + 1, urls[7].body },
+			{ urls[8].name + 1, urls[9].body },
+			{ urls[10].name + 1, urls[11].body },
+			{ "redirects.txt", NULL },
+			{	NULL } },
+		0);
+
+	_check_requests(urls, countof(urls), (int []) { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 }, "first run");
+
+	if (!(redirects = wget_read_file("redirects.txt", NULL)))
+		wget_error_printf_exit("Failed to read redirects.txt\n");
+
+	// the server's Cache-Control rules over the default lifetime of 30 days
+	if (strstr(redirects, "/nostore.html"))
+		wget_error_printf_exit("Redirect with 'Cache-Control: no-store' has been stored\n");
+	if (!(p = strstr(redirects, "/short-target.html ")) || sscanf(p, "/short-target.html %lld %lld", &created, &maxage) != 2)
+		wget_error_printf_exit("Missing redirect with 'Cache-Control: max-age=600'\n");
+	if (maxage != 600)
+		wget_error_printf_exit("Redirect with 'Cache-Control: max-age=600' stored with maxage %lld\n", maxage);
+
+	for (size_t it = 0; it < countof(urls); it++)
+		urls[it].requests = 0;
+
+	// second run: the same files, but 4 round trips less (old.html, chain1.html, chain2.html and short.html)
+	wget_test(
+		WGET_TEST_OPTIONS, OPTIONS,
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXISTING_FILES, &(wget_test_file_t []) {
+			{ "redirects.txt", redirects },
+			{	NULL } },
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[5].body },
+			{ urls[6].name + 1, urls[7].body },
+			{ urls[8].name + 1, urls[9].body },
+			{ urls[10].name + 1, urls[11].body },
+			{ "redirects.txt", redirects },
+			{	NULL } },
+		0);
+
+	// the temporary and the not stored redirect are still asked for
+	_check_requests(urls, countof(urls), (int []) { 1, 0, 1, 0, 0, 1, 1, 1, 1, 1, 0, 1 }, "second run");
+
+	for (size_t it = 0; it < countof(urls); it++)
+		urls[it].requests = 0;
+
+	// third run: a known redirect given on the command line isn't asked for either
+	wget_test(
+		WGET_TEST_OPTIONS, OPTIONS,
+		WGET_TEST_REQUEST_URL, "old.html",
+		WGET_TEST_EXISTING_FILES, &(wget_test_file_t []) {
+			{ "redirects.txt", redirects },
+			{	NULL } },
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[1].name + 1, urls[2].body },
+			{ "redirects.txt", redirects },
+			{	NULL } },
+		0);
+
+	_check_requests(urls, countof(urls), (int []) { 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, "third run");
+
+	wget_xfree(redirects);
+
+	exit(0);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing that sitemap <lastmod> avoids requests for up-to-date local copies
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h> // exit()
+#include "libtest.h"
+
+#define NEWER 1464739200 // 2016-06-01, newer than any <lastmod>
+#define OLDER 1420070400 // 2015-01-01, older than any <lastmod>
+
+static void _check_requests(const wget_test_url_t *urls, size_t nurls, const int *expected, const char *run)
+{
+	for (size_t it = 0; it < nurls; it++) {
+		if (urls[it].requests != expected[it])
+			wget_error_printf_exit("%s: %s requested %d times, expected %d\n", run, urls[it].name, urls[it].requests, expected[it]);
+	}
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/robots.txt",
+			.code = "200 Dontcare",
+			.body = "Sitemap: http://localhost:{{port}}/sitemap_index.xml\n",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.body = "<html><body>no links here</body></html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/sitemap_index.xml",
+			.code = "200 Dontcare",
+			.body =
+				"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+				"<sitemapindex xmlns=\"http://www.sitemaps.org/schemas/sitemap/0.9\">"
+				"<sitemap><loc>http://localhost:{{port}}/sitemap1.xml</loc><lastmod>2016-01-01</lastmod></sitemap>"
+				"</sitemapindex>",
+			.headers = {
+				"Content-Type: application/xml",
+			}
+		},
+		{	.name = "/sitemap1.xml",
+			.code = "200 Dontcare",
+			.body =
+				"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+				"<urlset xmlns=\"http://www.sitemaps.org/schemas/sitemap/0.9\">"
+				"<url><loc>http://localhost:{{port}}/page1.html</loc><lastmod>2016-01-01</lastmod></url>"
+				"<url><loc>http://localhost:{{port}}/page2.html</loc><lastmod>2016-01-01T10:00:00Z</lastmod></url>"
+				"<url><lastmod>2016-01-01T10:00:00+01:00</lastmod><loc>http://localhost:{{port}}/page3.html</loc></url>"
+				"<url><loc>http://localhost:{{port}}/page4.html</loc><lastmod>2016-01-01</lastmod></url>"
+				"</urlset>",
+			.headers = {
+				"Content-Type: application/xml",
+			}
+		},
+		{	.name = "/page1.html",
+			.code = "200 Dontcare",
+			.body = "page1",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/page2.html",
+			.code = "200 Dontcare",
+			.body = "page2",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/page3.html",
+			.code = "200 Dontcare",
+			.body = "page3",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+		{	.name = "/page4.html",
+			.code = "200 Dontcare",
+			.body = "page4",
+			.headers = {
+				"Content-Type: text/plain",
+			}
+		},
+	};
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// first run: everything is downloaded
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH -N",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[3].body },
+			{ urls[4].name + 1, urls[4].body },
+			{ urls[5].name + 1, urls[5].body },
+			{ urls[6].name + 1, urls[6].body },
+			{ urls[7].name + 1, urls[7].body },
+			{	NULL } },
+		0);
+
+	_check_requests(urls, countof(urls), (int []) { 1, 1, 1, 1, 1, 1, 1, 1 }, "first run");
+
+	for (size_t it = 0; it < countof(urls); it++)
+		urls[it].requests = 0;
+
+	// second run: the nested sitemap and pages 1-3 are up-to-date, only page 4 is older than its <lastmod>
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH -N",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXISTING_FILES, &(wget_test_file_t []) {
+			{ urls[3].name + 1, urls[3].body, NEWER },
+			{ urls[4].name + 1, urls[4].body, NEWER },
+			{ urls[5].name + 1, urls[5].body, NEWER },
+			{ urls[6].name + 1, urls[6].body, NEWER },
+			{ urls[7].name + 1, urls[7].body, OLDER },
+			{	NULL } },
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[3].body, NEWER },
+			{ urls[4].name + 1, urls[4].body, NEWER },
+			{ urls[5].name + 1, urls[5].body, NEWER },
+			{ urls[6].name + 1, urls[6].body, NEWER },
+			{ urls[7].name + 1, urls[7].body },
+			{	NULL } },
+		0);
+
+	// 4 requests avoided: sitemap1.xml and page1-3.html
+	_check_requests(urls, countof(urls), (int []) { 1, 1, 1, 0, 0, 0, 0, 1 }, "second run");
+
+	exit(0);
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing the adaptive downloader pool (--min-threads) against a high-latency server
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#define NFILES 60
+#define DELAY 100 // response latency in ms
+
+static wget_test_file_t
+	expected_files[NFILES + 3];
+
+static long long _run(const char *options, const char *logfile)
+{
+	long long start = wget_get_timemillis(), elapsed;
+	int n = NFILES + 1;
+
+	expected_files[n].name = logfile;
+	expected_files[n].content = NULL;
+	expected_files[n + !!logfile].name = NULL;
+
+	wget_test(
+		WGET_TEST_OPTIONS, options,
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+
+	elapsed = wget_get_timemillis() - start;
+	wget_info_printf("%s: %lld ms\n", options, elapsed);
+
+	return elapsed;
+}
+
+int main(void)
+{
+	wget_test_url_t urls[NFILES + 1];
+	wget_buffer_t *index = wget_buffer_alloc(4096);
+	char names[NFILES][16], bodies[NFILES][32];
+	long long fixed1, fixed8, adaptive;
+	char *log, *p;
+	int peak = 0;
+
+	if (!wget_thread_support())
+		exit(77); // no threads, no pool
+
+	memset(urls, 0, sizeof(urls));
+	memset(expected_files, 0, sizeof(expected_files));
+
+	wget_buffer_strcpy(index, "<html><body>");
+	for (int it = 0; it < NFILES; it++) {
+		snprintf(names[it], sizeof(names[it]), "/f%d.txt", it);
+		snprintf(bodies[it], sizeof(bodies[it]), "file %d", it);
+		wget_buffer_printf_append(index, "<a href=\"%s\">%d</a>", names[it] + 1, it);
+
+		urls[it + 1].name = names[it];
+		urls[it + 1].code = "200 Dontcare";
+		urls[it + 1].body = bodies[it];
+		urls[it + 1].headers[0] = "Content-Type: text/plain";
+
+		expected_files[it + 1].name = names[it] + 1;
+		expected_files[it + 1].content = bodies[it];
+	}
+	wget_buffer_strcat(index, "</body></html>");
+
+	urls[0].name = "/index.html";
+	urls[0].code = "200 Dontcare";
+	urls[0].body = index->data;
+	urls[0].headers[0] = "Content-Type: text/html";
+
+	expected_files[0].name = "index.html";
+	expected_files[0].content = index->data;
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		WGET_TEST_SERVER_RESPONSE_DELAY, DELAY,
+		0);
+
+	fixed1 = _run("-r -nH --max-threads=1", NULL);
+	fixed8 = _run("-r -nH --max-threads=8", NULL);
+	adaptive = _run("-r -nH --min-threads=1 --max-threads=8 -o pool.log", "pool.log");
+
+	// the pool has to grow, since responses are slow but the server serves requests in parallel
+	if (!(log = wget_read_file("pool.log", NULL)))
+		wget_error_printf_exit("Failed to read pool.log\n");
+	if (!(p = strstr(log, "Downloader pool: ")) || sscanf(p, "Downloader pool: %d", &peak) != 1)
+		wget_error_printf_exit("Missing pool statistics in pool.log\n");
+	wget_xfree(log);
+
+	wget_info_printf("fixed 1: %lld ms, fixed 8: %lld ms, adaptive 1..8: %lld ms (%d threads at most)\n",
+		fixed1, fixed8, adaptive, peak);
+
+	// timings are just informational, the pool has to grow but stay within its limits
+	if (peak < 3 || peak > 8)
+		wget_error_printf_exit("Unexpected pool size (%d threads at most)\n", peak);
+
+	wget_buffer_free(&index);
+
+	exit(0);
+}
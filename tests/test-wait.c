@@ -0,0 +1,107 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing that --wait spaces the requests per host, while other hosts are served
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#define NFILES 3 // per host
+
+// both names resolve to the test server, but are different hosts for the politeness delay
+static const char *hosts[2] = { "localhost", "127.0.0.1" };
+
+int main(void)
+{
+	wget_test_url_t urls[1 + 2 * NFILES];
+	wget_test_file_t expected_files[1 + 2 * NFILES + 1];
+	wget_buffer_t *index = wget_buffer_alloc(1024);
+	char names[2 * NFILES][16];
+	long long start, elapsed;
+
+	memset(urls, 0, sizeof(urls));
+	memset(expected_files, 0, sizeof(expected_files));
+
+	// the index links files on both host names
+	wget_buffer_strcpy(index, "<html><body>");
+	for (int it = 0; it < 2 * NFILES; it++) {
+		snprintf(names[it], sizeof(names[it]), "/f%d.txt", it);
+		wget_buffer_printf_append(index, "<a href=\"http://%s:{{port}}%s\">%d</a>", hosts[it % 2], names[it], it);
+
+		urls[it + 1].name = names[it];
+		urls[it + 1].code = "200 Dontcare";
+		urls[it + 1].body = "file";
+		urls[it + 1].headers[0] = "Content-Type: text/plain";
+	}
+	wget_buffer_strcat(index, "</body></html>");
+
+	urls[0].name = "/index.html";
+	urls[0].code = "200 Dontcare";
+	urls[0].body = index->data;
+	urls[0].headers[0] = "Content-Type: text/html";
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// the index body has its {{port}} replaced now
+	for (int it = 0; it < 1 + 2 * NFILES; it++) {
+		expected_files[it].name = urls[it].name + 1;
+		expected_files[it].content = urls[it].body;
+	}
+
+	// a single downloader: a thread sleeping through the delay would need a second per request
+	start = wget_get_timemillis();
+
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH -H -e robots=off --wait=1 --max-threads=1",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, expected_files,
+		0);
+
+	elapsed = wget_get_timemillis() - start;
+	wget_info_printf("%d requests to 2 hosts in %lld ms\n", 1 + 2 * NFILES, elapsed);
+
+	for (int it = 0; it < 1 + 2 * NFILES; it++) {
+		if (urls[it].requests != 1)
+			wget_error_printf_exit("%s requested %d times, expected once\n", urls[it].name, urls[it].requests);
+	}
+
+	// localhost gets 1 + NFILES requests, one per second
+	if (elapsed < NFILES * 1000)
+		wget_error_printf_exit("%lld ms, the requests to localhost have not been spaced by --wait\n", elapsed);
+
+	// 127.0.0.1 is served while localhost has to wait, a request per second would take 2 * NFILES seconds
+	if (elapsed >= 2 * NFILES * 1000)
+		wget_error_printf_exit("%lld ms, the other host has not been served during the delay\n", elapsed);
+
+	wget_buffer_free(&index);
+
+	exit(0);
+}
@@ -0,0 +1,354 @@
+/*
+ * Copyright(c) 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of libwget.
+ *
+ * Libwget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Libwget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libwget.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Testing --warc-file
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h> // exit()
+#include <string.h>
+#include "libtest.h"
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#define MAX_RECORDS 32
+
+// request and response records are paired by WARC-Concurrent-To
+typedef struct {
+	char
+		id[64],
+		uri[256];
+} record_t;
+
+static void _base32(const unsigned char *src, size_t n, char *dst)
+{
+	static const char alphabet[32] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+	unsigned int value = 0, bits = 0;
+
+	for (size_t it = 0; it < n; it++) {
+		value = ((value << 8) | src[it]) & 0xFFFF;
+		for (bits += 8; bits >= 5; bits -= 5)
+			*dst++ = alphabet[(value >> (bits - 5)) & 31];
+	}
+
+	if (bits)
+		*dst++ = alphabet[(value << (5 - bits)) & 31];
+
+	*dst = 0;
+}
+
+static const char *_find_field(const char *head, size_t headlen, const char *name)
+{
+	size_t namelen = strlen(name);
+
+	for (const char *p = head; p && p < head + headlen; ) {
+		if (!wget_strncasecmp_ascii(p, name, namelen) && p[namelen] == ':')
+			return p + namelen + 1 + (p[namelen + 1] == ' ');
+		if ((p = strstr(p, "\r\n")))
+			p += 2;
+	}
+
+	return NULL;
+}
+
+static void _copy_field(char *dst, size_t size, const char *field)
+{
+	size_t len = field ? strcspn(field, "\r") : 0;
+
+	if (len >= size)
+		len = size - 1;
+
+	memcpy(dst, field ? field : "", len);
+	dst[len] = 0;
+}
+
+#ifdef WITH_ZLIB
+// every record is a gzip member of its own
+static char *_gunzip(const char *fname, char *content, size_t *size)
+{
+	z_stream strm = { .next_in = NULL };
+	wget_buffer_t *out = wget_buffer_alloc(*size * 4 + 1);
+	char *data;
+	int rc;
+
+	if (inflateInit2(&strm, 15 + 16) != Z_OK)
+		wget_error_printf_exit("Failed to initialize zlib\n");
+
+	strm.next_in = (unsigned char *) content;
+	strm.avail_in = (unsigned) *size;
+
+	while (strm.avail_in) {
+		wget_buffer_ensure_capacity(out, out->length + 16384);
+		strm.next_out = (unsigned char *) out->data + out->length;
+		strm.avail_out = (unsigned) (out->size - out->length);
+
+		rc = inflate(&strm, Z_NO_FLUSH);
+		out->length = out->size - strm.avail_out;
+
+		if (rc == Z_STREAM_END)
+			inflateReset(&strm);
+		else if (rc != Z_OK)
+			wget_error_printf_exit("%s is not a valid gzip file (%d)\n", fname, rc);
+	}
+
+	inflateEnd(&strm);
+	wget_xfree(content);
+
+	*size = out->length;
+	out->data[out->length] = 0; // the buffer has room for the terminator
+	data = wget_memdup(out->data, out->length + 1);
+	wget_buffer_free(&out);
+
+	return data;
+}
+#endif
+
+// parse a WARC file, check each record's framing and digest, count requests and responses,
+// check that every response belongs to a request for the same URI and that every body shows up in a response
+static void _check_warc(const char *fname, int *nrequests, int *nresponses, int *nwarcinfo, const char **bodies)
+{
+	size_t size;
+	char *data = wget_read_file(fname, &size), *p, *end;
+	record_t requests[MAX_RECORDS], responses[MAX_RECORDS];
+	int nreq = 0, nresp = 0;
+
+	if (!data)
+		wget_error_printf_exit("Failed to read %s\n", fname);
+
+	if (wget_match_tail(fname, ".gz")) {
+#ifdef WITH_ZLIB
+		data = _gunzip(fname, data, &size);
+#else
+		wget_error_printf_exit("%s: no zlib support\n", fname);
+#endif
+	}
+
+	for (p = data, end = data + size; p < end; ) {
+		char *head_end, digest_b32[64];
+		const char *field;
+		unsigned char digest[20];
+		size_t headlen, length;
+
+		if (strncmp(p, "WARC/1.0\r\n", 10))
+			wget_error_printf_exit("%s: missing WARC/1.0 at offset %td\n", fname, p - data);
+
+		if (!(head_end = strstr(p, "\r\n\r\n")))
+			wget_error_printf_exit("%s: unterminated record header\n", fname);
+
+		headlen = head_end - p + 2;
+
+		if (!(field = _find_field(p, headlen, "Content-Length")))
+			wget_error_printf_exit("%s: missing Content-Length\n", fname);
+		length = (size_t) atoll(field);
+
+		if (head_end + 4 + length + 4 > end || memcmp(head_end + 4 + length, "\r\n\r\n", 4))
+			wget_error_printf_exit("%s: bad record length %zu\n", fname, length);
+
+		if (!(field = _find_field(p, headlen, "WARC-Block-Digest")) || strncmp(field, "sha1:", 5))
+			wget_error_printf_exit("%s: missing WARC-Block-Digest\n", fname);
+
+		wget_hash_fast(WGET_DIGTYPE_SHA1, head_end + 4, length, digest);
+		_base32(digest, sizeof(digest), digest_b32);
+		if (strncmp(field + 5, digest_b32, strlen(digest_b32)))
+			wget_error_printf_exit("%s: block digest mismatch\n", fname);
+
+		if (!(field = _find_field(p, headlen, "WARC-Type")))
+			wget_error_printf_exit("%s: missing WARC-Type\n", fname);
+
+		if (!strncmp(field, "request\r\n", 9)) {
+			if (strncmp(head_end + 4, "GET ", 4) || !strstr(head_end + 4, " HTTP/1.1\r\n"))
+				wget_error_printf_exit("%s: request block doesn't start with a request line\n", fname);
+
+			if (nreq < MAX_RECORDS) {
+				_copy_field(requests[nreq].id, sizeof(requests[nreq].id), _find_field(p, headlen, "WARC-Record-ID"));
+				_copy_field(requests[nreq].uri, sizeof(requests[nreq].uri), _find_field(p, headlen, "WARC-Target-URI"));
+				nreq++;
+			}
+
+			(*nrequests)++;
+		} else if (!strncmp(field, "response\r\n", 10)) {
+			const char *block = head_end + 4, *body;
+
+			if (strncmp(block, "HTTP/1.1 ", 9) || !(body = strstr(block, "\r\n\r\n")) || body >= block + length)
+				wget_error_printf_exit("%s: response block doesn't start with a status line\n", fname);
+
+			// mark the body as seen
+			body += 4;
+			for (int it = 0; bodies[it]; it++) {
+				if (strlen(bodies[it]) == (size_t) (block + length - body) && !memcmp(bodies[it], body, block + length - body)) {
+					bodies[it] = "";
+					break;
+				}
+			}
+
+			if (nresp < MAX_RECORDS) {
+				_copy_field(responses[nresp].id, sizeof(responses[nresp].id), _find_field(p, headlen, "WARC-Concurrent-To"));
+				_copy_field(responses[nresp].uri, sizeof(responses[nresp].uri), _find_field(p, headlen, "WARC-Target-URI"));
+				nresp++;
+			}
+
+			(*nresponses)++;
+		} else if (!strncmp(field, "warcinfo\r\n", 10)) {
+			(*nwarcinfo)++;
+		} else
+			wget_error_printf_exit("%s: unexpected WARC-Type\n", fname);
+
+		p = head_end + 4 + length + 4;
+	}
+
+	// records of concurrent downloads may be interleaved
+	for (int it = 0; it < nresp; it++) {
+		int found = 0;
+
+		for (int it2 = 0; it2 < nreq && !found; it2++)
+			found = !strcmp(responses[it].id, requests[it2].id) && !strcmp(responses[it].uri, requests[it2].uri);
+
+		if (!found)
+			wget_error_printf_exit("%s: no request record for the response of %s\n", fname, responses[it].uri);
+	}
+
+	wget_xfree(data);
+}
+
+// check the WARC file of a recursive download of all 'urls'
+static void _check_archive(const char *fname, const wget_test_url_t *urls, size_t nurls)
+{
+	const char *bodies[16];
+	int nrequests = 0, nresponses = 0, nwarcinfo = 0;
+
+	for (size_t it = 0; it < nurls; it++)
+		bodies[it] = urls[it].body;
+	bodies[nurls] = NULL;
+
+	_check_warc(fname, &nrequests, &nresponses, &nwarcinfo, bodies);
+
+	// robots.txt is requested as well (404, no body to compare)
+	if (nwarcinfo != 1 || nrequests != nresponses || nresponses < (int) nurls)
+		wget_error_printf_exit("%s: unexpected record count: %d warcinfo, %d requests, %d responses\n",
+			fname, nwarcinfo, nrequests, nresponses);
+
+	for (size_t it = 0; it < nurls; it++)
+		if (*bodies[it])
+			wget_error_printf_exit("%s: body of %s not found\n", fname, urls[it].name);
+}
+
+int main(void)
+{
+	wget_test_url_t urls[]={
+		{	.name = "/index.html",
+			.code = "200 Dontcare",
+			.body =
+				"<html><head><title>Main Page</title><body><p>A link to a" \
+				" <A href=\"http://localhost:{{port}}/secondpage.html\">second page</a>." \
+				" <a href=\"/subdir1/subpage1.html\">page in subdir1</a>." \
+				" <a href=\"./subdir1/subpage2.html\">page in subdir1</a>." \
+				" <a href=\"./subdir1/chunked.txt\">chunked</a>." \
+				"</p></body></html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/secondpage.html",
+			.code = "200 Dontcare",
+			.body = "<html><head><title>Second Page</title></head><body></body></html>",
+			.headers = {
+				"Content-Type: text/html",
+			}
+		},
+		{	.name = "/subdir1/subpage1.html",
+			.code = "200 Dontcare",
+			.body = "sub1_1"
+		},
+		{	.name = "/subdir1/subpage2.html",
+			.code = "200 Dontcare",
+			.body = "sub1_2"
+		},
+		{	.name = "/subdir1/chunked.txt",
+			.code = "200 Dontcare",
+			.body = "3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n",
+			.headers = {
+				"Content-Type: text/plain",
+				"Transfer-Encoding: chunked",
+			}
+		},
+	};
+
+	// functions won't come back if an error occurs
+	wget_test_start_server(
+		WGET_TEST_RESPONSE_URLS, &urls, countof(urls),
+		0);
+
+	// one uncompressed WARC file
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH --max-threads=3 --warc-file=archive --no-warc-compression",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[3].body },
+			{ urls[4].name + 1, "abcde" },
+			{ "archive.warc", NULL },
+			{	NULL } },
+		0);
+
+	// the records keep the messages as received, the chunked body included
+	_check_archive("archive.warc", urls, countof(urls));
+
+	// a tiny size limit puts every record into a file of its own
+	wget_test(
+		WGET_TEST_OPTIONS, "--warc-file=archive --warc-max-size=1 --no-warc-compression",
+		WGET_TEST_REQUEST_URL, "subdir1/subpage1.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ "subpage1.html", urls[2].body },
+			{ "archive-00000.warc", NULL },
+			{ "archive-00001.warc", NULL },
+			{ "archive-00002.warc", NULL },
+			{	NULL } },
+		0);
+
+#ifdef WITH_ZLIB
+	// compressed output of concurrent downloads, the records are compressed by several threads
+	wget_test(
+		WGET_TEST_OPTIONS, "-r -nH --max-threads=5 --warc-file=archive",
+		WGET_TEST_REQUEST_URL, "index.html",
+		WGET_TEST_EXPECTED_ERROR_CODE, 0,
+		WGET_TEST_EXPECTED_FILES, &(wget_test_file_t []) {
+			{ urls[0].name + 1, urls[0].body },
+			{ urls[1].name + 1, urls[1].body },
+			{ urls[2].name + 1, urls[2].body },
+			{ urls[3].name + 1, urls[3].body },
+			{ urls[4].name + 1, "abcde" },
+			{ "archive.warc.gz", NULL },
+			{	NULL } },
+		0);
+
+	_check_archive("archive.warc.gz", urls, countof(urls));
+#endif
+
+	exit(0);
+}
@@ -37,9 +37,19 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/socket.h>
+#ifdef HAVE_NETINET_TCP_H
+#	include <netinet/tcp.h>
+#endif
+#if defined __linux__ && defined __GLIBC__
+#	include <sys/resource.h>
+#	include <sys/wait.h>
+#endif
+#include <c-ctype.h>
 
 #include <wget.h>
 #include "../libwget/private.h"
+#include "../libwget/net.h"
 
 #include "../src/wget_options.h"
 #include "../src/wget_log.h"
@@ -48,6 +58,51 @@ static int
 	ok,
 	failed;
 
+#if defined __linux__ && defined __GLIBC__ && !defined __SANITIZE_ADDRESS__
+/*
+ * Grow a buffer to 'size' bytes in network sized chunks within a child process.
+ * Returns the increase of the peak RSS in KiB, -1 on error.
+ * If growing copied the content into a new block, the peak would be 1.5 times the size.
+ */
+static long _grow_peak_rss(size_t size)
+{
+	struct rusage before, after;
+	int fd[2], status;
+	long kib = -1;
+	pid_t pid;
+
+	if (pipe(fd) == -1)
+		return -1;
+
+	if ((pid = fork()) == 0) {
+		wget_buffer_t *bufp;
+
+		close(fd[0]);
+		getrusage(RUSAGE_SELF, &before);
+
+		bufp = wget_buffer_alloc(102400);
+		while (bufp->length < size)
+			wget_buffer_memset_append(bufp, 'x', 1460);
+
+		getrusage(RUSAGE_SELF, &after);
+		kib = after.ru_maxrss - before.ru_maxrss;
+		if (write(fd[1], &kib, sizeof(kib)) != sizeof(kib))
+			_exit(1);
+		_exit(0);
+	}
+
+	close(fd[1]);
+	if (pid > 0) {
+		if (read(fd[0], &kib, sizeof(kib)) != sizeof(kib))
+			kib = -1;
+		waitpid(pid, &status, 0);
+	}
+	close(fd[0]);
+
+	return kib;
+}
+#endif
+
 static void _test_buffer(wget_buffer_t *buf, const char *name)
 {
 	char test[256];
@@ -171,6 +226,59 @@ static void test_buffer(void)
 	_test_buffer(bufp, "Test 5");
 	wget_buffer_free(&bufp);
 
+	// growing a body of several MiB in network sized chunks
+
+	bufp = wget_buffer_alloc(102400);
+	for (int it = 0; it < 4096; it++)
+		wget_buffer_memset_append(bufp, 'a' + it % 26, 1460);
+	{
+		size_t it;
+
+		for (it = 0; it < bufp->length && bufp->data[it] == 'a' + (int)(it / 1460) % 26; it++);
+
+		if (it == 4096 * 1460 && bufp->length == it && !bufp->data[it])
+			ok++;
+		else {
+			failed++;
+			info_printf("test_buffer.grow: mismatch at %zu (length %zu)\n", it, bufp->length);
+		}
+	}
+	wget_buffer_free(&bufp);
+
+	// a reserved buffer must not be reallocated (and copied) while filled up
+
+	bufp = wget_buffer_alloc(16);
+	wget_buffer_strcpy(bufp, "x");
+	wget_buffer_ensure_capacity(bufp, 4 * 1024 * 1024);
+	{
+		const char *data = bufp->data;
+
+		for (int it = 0; it < 1023; it++)
+			wget_buffer_memset_append(bufp, 'y', 4096);
+
+		if (bufp->data == data && *bufp->data == 'x')
+			ok++;
+		else {
+			failed++;
+			info_printf("test_buffer.reserve: buffer has been reallocated\n");
+		}
+	}
+	wget_buffer_free(&bufp);
+
+#if defined __linux__ && defined __GLIBC__ && !defined __SANITIZE_ADDRESS__
+	// growing a buffer must not copy its content into a new block (valgrind's realloc always does)
+	if (!getenv("LD_PRELOAD") || !strstr(getenv("LD_PRELOAD"), "vgpreload")) {
+		long kib = _grow_peak_rss(32 << 20);
+
+		if (kib >= 0 && kib < (32 << 10) * 5 / 4)
+			ok++;
+		else {
+			failed++;
+			info_printf("test_buffer.peak: growing to 32 MiB took %ld KiB\n", kib);
+		}
+	}
+#endif
+
 	// check that appending works
 
 	wget_buffer_init(&buf, sbuf, sizeof(sbuf));
@@ -1348,6 +1456,300 @@ static void test_hpkp(void)
 	wget_hpkp_db_free(&hpkp_db);
 }
 
+static void test_http_date(void)
+{
+	static const struct test_data {
+		const char *
+			date;
+		time_t
+			result;
+	} test_data[] = {
+		{ "Sun, 06 Nov 1994 08:49:37 GMT", 784111777 }, // IMF-fixdate
+		{ "Sunday, 06-Nov-94 08:49:37 GMT", 784111777 }, // RFC 850
+		{ "Sun Nov  6 08:49:37 1994", 784111777 }, // asctime()
+		{ "Sun, 06-Nov-1994 08:49:37 GMT", 784111777 }, // Netscape
+		{ "6 Nov 1994 08:49:37 GMT", 784111777 },
+		{ "  sun, 6 nov 1994 8:49:37", 784111777 },
+		{ "Thu, 29 Feb 2024 23:59:59 GMT", 1709251199 },
+		{ "Wed, 01 Jan 2070 00:00:00 GMT", 3155760000 },
+		{ "Thu, 01 Jan 1970 00:00:00 GMT", 0 },
+		{ "Wed, 29 Feb 2023 00:00:00 GMT", 0 },
+		{ "Sun, 06 Foo 1994 08:49:37 GMT", 0 },
+		{ "Sun, 06 Nov 1994 08:49", 0 },
+		{ "Sun, 06 Nov 1994 24:49:37 GMT", 0 },
+		{ "Sun 06 Nov 1994 08:49:37 GMT", 0 },
+		{ "", 0 },
+	};
+	char buf[32], ref[32];
+	struct tm tm;
+	time_t ts;
+	int bad = 0;
+
+	for (unsigned it = 0; it < countof(test_data); it++) {
+		const struct test_data *t = &test_data[it];
+
+		// twice to also check the last-value cache
+		for (int n = 0; n < 2; n++) {
+			time_t result = wget_http_parse_full_date(t->date);
+
+			if (result == t->result)
+				ok++;
+			else {
+				failed++;
+				info_printf("Failed [%u]: wget_http_parse_full_date(%s) -> %lld (expected %lld)\n",
+					it, t->date, (long long) result, (long long) t->result);
+			}
+		}
+	}
+
+	// every day until 2100 with changing time of day
+	for (ts = 0; ts < 4102444800 && bad < 10; ts += 86400 + 3607) {
+		wget_http_print_date(ts, buf, sizeof(buf));
+
+		gmtime_r(&ts, &tm);
+		strftime(ref, sizeof(ref), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+
+		if (strcmp(buf, ref)) {
+			info_printf("Failed: wget_http_print_date(%lld) -> %s (expected %s)\n", (long long) ts, buf, ref);
+			bad++;
+		} else if (wget_http_parse_full_date(buf) != ts) {
+			info_printf("Failed: wget_http_parse_full_date(%s) -> %lld (expected %lld)\n",
+				buf, (long long) wget_http_parse_full_date(buf), (long long) ts);
+			bad++;
+		}
+	}
+
+	if (bad)
+		failed++;
+	else
+		ok++;
+
+	// truncation as with snprintf()
+	wget_http_print_date(784111777, buf, 9);
+	if (!strcmp(buf, "Sun, 06 "))
+		ok++;
+	else {
+		failed++;
+		info_printf("Failed: wget_http_print_date() truncated to '%s' (expected 'Sun, 06 ')\n", buf);
+	}
+}
+
+static void test_memstats(void)
+{
+	size_t current, peak, count, current2, peak2, count2;
+	char buf[1024];
+
+	// other tests may have charged the counters already, so only check the differences
+	wget_memstats_get(WGET_MEMTAG_DNS_CACHE, &current, &peak, &count);
+
+	wget_memstats_alloc(WGET_MEMTAG_DNS_CACHE, peak + 1000);
+	wget_memstats_alloc(WGET_MEMTAG_DNS_CACHE, 500);
+	wget_memstats_free(WGET_MEMTAG_DNS_CACHE, peak + 1000);
+	wget_memstats_get(WGET_MEMTAG_DNS_CACHE, &current2, &peak2, &count2);
+	wget_memstats_free(WGET_MEMTAG_DNS_CACHE, 500);
+
+	if (current2 == current + 500 && peak2 == current + peak + 1500 && count2 == count + 2)
+		ok++;
+	else {
+		failed++;
+		info_printf("Failed: memstats %zu/%zu/%zu (expected %zu/%zu/%zu)\n",
+			current2, peak2, count2, current + 500, current + peak + 1500, count + 2);
+	}
+
+	if (!strcmp(wget_memstats_name(WGET_MEMTAG_DNS_CACHE), "dns_cache") && !wget_memstats_name(WGET_MEMTAG_MAX))
+		ok++;
+	else {
+		failed++;
+		info_printf("Failed: wget_memstats_name()\n");
+	}
+
+	// all tags are listed, the output is truncated like snprintf()
+	if (wget_memstats_report(buf, sizeof(buf)) == strlen(buf) && strstr(buf, "\n  cookies ") && buf[strlen(buf) - 1] == '\n')
+		ok++;
+	else {
+		failed++;
+		info_printf("Failed: wget_memstats_report() -> '%s'\n", buf);
+	}
+
+	if (wget_memstats_report(buf, 7) == 6 && !strcmp(buf, "Memory"))
+		ok++;
+	else {
+		failed++;
+		info_printf("Failed: wget_memstats_report() truncated to '%s' (expected 'Memory')\n", buf);
+	}
+}
+
+static void test_sitemap_entries(void)
+{
+	static const struct test_data {
+		const char *
+			loc;
+		time_t
+			lastmod;
+	} test_data[] = {
+		{ "http://example.com/a.html", 1476748800 }, // 2016-10-18
+		{ "http://example.com/b.html", 1476793800 }, // 2016-10-18T12:30:00Z
+		{ "http://example.com/c.html", 1476793800 }, // 2016-10-18T14:30:00+02:00, <lastmod> before <loc>
+		{ "http://example.com/d.html", 0 }, // no <lastmod>
+		{ "http://example.com/e.html", 0 }, // invalid <lastmod>
+	};
+	static const char *sitemap =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+		"<urlset xmlns=\"http://www.sitemaps.org/schemas/sitemap/0.9\">"
+		"<url><loc>http://example.com/a.html</loc><lastmod>2016-10-18</lastmod></url>"
+		"<url><loc> http://example.com/b.html </loc><lastmod>2016-10-18T12:30:00.5Z</lastmod></url>"
+		"<url><lastmod>2016-10-18T14:30:00+02:00</lastmod><loc>http://example.com/c.html</loc></url>"
+		"<url><loc>http://example.com/d.html</loc></url>"
+		"<url><loc>http://example.com/e.html</loc><lastmod>yesterday</lastmod></url>"
+		"</urlset>";
+	static const char *sitemap_index =
+		"<sitemapindex><sitemap><loc>http://example.com/s1.xml</loc><lastmod>2016-10-18</lastmod></sitemap></sitemapindex>";
+	wget_vector_t *urls, *sitemap_urls;
+
+	wget_sitemap_get_entries_inline(sitemap, &urls, &sitemap_urls);
+
+	if (wget_vector_size(urls) == countof(test_data) && !sitemap_urls) {
+		for (unsigned it = 0; it < countof(test_data); it++) {
+			const struct test_data *t = &test_data[it];
+			wget_sitemap_url_t *entry = wget_vector_get(urls, it);
+
+			if (entry->url.len == strlen(t->loc) && !strncmp(entry->url.p, t->loc, entry->url.len) && entry->lastmod == t->lastmod)
+				ok++;
+			else {
+				failed++;
+				info_printf("Failed [%u]: sitemap entry '%.*s' %lld (expected '%s' %lld)\n",
+					it, (int) entry->url.len, entry->url.p, (long long) entry->lastmod, t->loc, (long long) t->lastmod);
+			}
+		}
+	} else {
+		failed++;
+		info_printf("Failed: %d sitemap entries (expected %u)\n", wget_vector_size(urls), (unsigned) countof(test_data));
+	}
+
+	wget_vector_free(&urls);
+	wget_vector_free(&sitemap_urls);
+
+	// nested sitemaps come with their <lastmod>, too
+	wget_sitemap_get_entries_inline(sitemap_index, &urls, &sitemap_urls);
+
+	wget_sitemap_url_t *entry = wget_vector_get(sitemap_urls, 0);
+	if (!urls && wget_vector_size(sitemap_urls) == 1 && entry->lastmod == 1476748800)
+		ok++;
+	else {
+		failed++;
+		info_printf("Failed: sitemap index entries\n");
+	}
+
+	wget_vector_free(&urls);
+	wget_vector_free(&sitemap_urls);
+}
+
+static void test_html_names(void)
+{
+	// all names of the perfect hash in libwget/html_url.c (generated by contrib/gen_html_names.py)
+	static const char *url_attrs[] = {
+		"action", "archive", "background", "cite", "classid", "code", "codebase", "data", "formaction",
+		"href", "icon", "longdesc", "lowsrc", "manifest", "poster", "profile", "src", "srcset", "usemap",
+	};
+	static const char *other_names[] = {
+		"base", "charset", "content", "http-equiv", "link", "meta", "name", "rel", "style",
+		"hre", "hrefs", "sr", "srcx", "xhref", // not in the table
+	};
+	static const struct test_data {
+		const char *
+			html;
+		const char *
+			url; // the only URL found
+		const char *
+			encoding;
+		const char *
+			base;
+		int
+			follow,
+			link_inline;
+	} test_data[] = {
+		{ "<base href=\"http://b/\">", NULL, NULL, "http://b/", 1, 0 },
+		{ "<BASE HREF=\"http://b/\">", NULL, NULL, "http://b/", 1, 0 },
+		{ "<meta charset=\"k1\">", NULL, "k1", NULL, 1, 0 },
+		{ "<meta http-equiv=\"Content-Type\" content=\"text/html; charset=k2\">", NULL, "k2", NULL, 1, 0 },
+		{ "<META HTTP-EQUIV=\"Content-Type\" CONTENT=\"text/html; charset=k2\">", NULL, "k2", NULL, 1, 0 },
+		{ "<meta name=\"robots\" content=\"nofollow\">", NULL, NULL, NULL, 0, 0 },
+		{ "<link rel=\"stylesheet\" href=\"s.css\">", "s.css", NULL, NULL, 1, 1 },
+		{ "<link href=\"s.css\" REL=\"stylesheet\">", "s.css", NULL, NULL, 1, 1 },
+		{ "<LINK rel=\"next\" href=\"n.html\">", "n.html", NULL, NULL, 1, 0 },
+	};
+	WGET_HTML_PARSED_RESULT *res;
+	char html[64];
+
+	// URL valued attributes, the lookup folds the case
+	for (unsigned it = 0; it < countof(url_attrs) * 2; it++) {
+		const char *name = url_attrs[it / 2];
+		WGET_HTML_PARSED_URL *url;
+
+		snprintf(html, sizeof(html), "<x %s=\"u\">", name);
+		if (it & 1) {
+			for (char *p = html; *p; p++)
+				*p = c_toupper(*p);
+		}
+
+		res = wget_html_get_urls_inline(html, NULL, NULL);
+
+		if (wget_vector_size(res->uris) == 1 && (url = wget_vector_get(res->uris, 0))
+			&& url->url.len == 1 && (*url->url.p | 0x20) == 'u' && !wget_strcasecmp_ascii(url->attr, name))
+			ok++;
+		else {
+			failed++;
+			info_printf("Failed: URL attribute not found in '%s'\n", html);
+		}
+
+		wget_html_free_urls_inline(&res);
+	}
+
+	// other names and similar strings don't yield URLs
+	for (unsigned it = 0; it < countof(other_names); it++) {
+		snprintf(html, sizeof(html), "<x %s=\"u\">", other_names[it]);
+
+		res = wget_html_get_urls_inline(html, NULL, NULL);
+
+		if (!wget_vector_size(res->uris))
+			ok++;
+		else {
+			failed++;
+			info_printf("Failed: unexpected URL in '%s'\n", html);
+		}
+
+		wget_html_free_urls_inline(&res);
+	}
+
+	// names with a meaning as tag or in combination
+	for (unsigned it = 0; it < countof(test_data); it++) {
+		const struct test_data *t = &test_data[it];
+		WGET_HTML_PARSED_URL *url = NULL;
+
+		res = wget_html_get_urls_inline(t->html, NULL, NULL);
+
+		if (t->url) {
+			if (wget_vector_size(res->uris) == 1) {
+				url = wget_vector_get(res->uris, 0);
+				if (url->url.len != strlen(t->url) || strncmp(url->url.p, t->url, url->url.len) || url->link_inline != t->link_inline)
+					url = NULL;
+			}
+		}
+
+		if ((t->url ? url != NULL : !wget_vector_size(res->uris))
+			&& !wget_strcmp(res->encoding, t->encoding)
+			&& (t->base ? res->base.len == strlen(t->base) && !strncmp(res->base.p, t->base, res->base.len) : !res->base.p)
+			&& res->follow == t->follow)
+			ok++;
+		else {
+			failed++;
+			info_printf("Failed [%u]: unexpected result for '%s'\n", it, t->html);
+		}
+
+		wget_html_free_urls_inline(&res);
+	}
+}
+
 static void test_parse_challenge(void)
 {
 	static const struct test_data {
@@ -1449,6 +1851,81 @@ static void test_utils(void)
 	}
 }
 
+// the former printf based implementation of wget_iri_escape() and friends
+static void _escape_reference(const unsigned char *src, wget_buffer_t *buf, int mode)
+{
+	for (; *src; src++) {
+		int c = *src;
+
+		if ((c > 32 && c < 127 && (c_isalnum(c) || strchr("-._~", c)))
+			|| (mode == 1 && c == '/')
+			|| (mode == 2 && (c == '=' || c == '&')))
+			wget_buffer_memcat(buf, src, 1);
+		else if (mode == 2 && c == ' ')
+			wget_buffer_memcat(buf, "+", 1);
+		else
+			wget_buffer_printf_append(buf, "%%%02X", c);
+	}
+}
+
+static void test_iri_escape(void)
+{
+	static const char *(*escape[3])(const char *, wget_buffer_t *) = {
+		wget_iri_escape, wget_iri_escape_path, wget_iri_escape_query
+	};
+	char src[8], unesc[8], expected[8];
+	wget_buffer_t *buf = wget_buffer_alloc(16), *ref = wget_buffer_alloc(16);
+	int bad = 0;
+
+	// every byte value in every escape mode
+	for (int mode = 0; mode < 3; mode++) {
+		for (int c = 1; c < 256; c++) {
+			snprintf(src, sizeof(src), "a%cb", c);
+
+			wget_buffer_strcpy(buf, "x");
+			wget_buffer_strcpy(ref, "x");
+			escape[mode](src, buf);
+			_escape_reference((unsigned char *) src, ref, mode);
+
+			if (strcmp(buf->data, ref->data) || buf->length != ref->length) {
+				info_printf("Failed: escape mode %d of byte 0x%02X: '%s' (expected '%s')\n", mode, c, buf->data, ref->data);
+				bad++;
+			}
+		}
+	}
+
+	// every combination of two bytes after '%'
+	for (int c1 = 1; c1 < 256; c1++) {
+		for (int c2 = 1; c2 < 256; c2++) {
+			snprintf(src, sizeof(src), "%%%c%c%%", c1, c2);
+			strcpy(unesc, src);
+
+			if (c_isxdigit(c1) && c_isxdigit(c2)) {
+				snprintf(expected, sizeof(expected), "%c%%", (int) strtol(src + 1, NULL, 16));
+				if (!wget_percent_unescape(unesc) || strcmp(unesc, expected))
+					bad++;
+			} else if (wget_percent_unescape(unesc) || strcmp(unesc, src))
+				bad++;
+		}
+	}
+
+	strcpy(unesc, "%41%42c");
+	if (wget_iri_unescape_inline(unesc) != unesc || strcmp(unesc, "ABc"))
+		bad++;
+	strcpy(unesc, "%4gc%");
+	if (wget_iri_unescape_inline(unesc) || strcmp(unesc, "%4gc%"))
+		bad++;
+
+	if (bad) {
+		info_printf("Failed: %d escape/unescape mismatches\n", bad);
+		failed++;
+	} else
+		ok++;
+
+	wget_buffer_free(&ref);
+	wget_buffer_free(&buf);
+}
+
 static void test_strcasecmp_ascii(void)
 {
 	static const struct test_data {
@@ -1952,6 +2429,8 @@ static void test_robots(void)
 			path[3];
 		const char *
 			sitemap[3];
+		int
+			crawl_delay;
 	} test_data[] = {
 		{
 			// Deny all robots from part of the server
@@ -2050,6 +2529,33 @@ static void test_robots(void)
 			"Disallow: /cgi-bin/",
 			{ "/cgi-bin/", NULL },
 			{ "", NULL }
+		},
+		{
+			// Crawl-delay in seconds
+			"User-agent: *\n"
+			"Crawl-delay: 2\n"
+			"Disallow: /cgi-bin/\n",
+			{ "/cgi-bin/", NULL },
+			{ NULL },
+			2000
+		},
+		{
+			// fractional Crawl-delay
+			"User-agent: *\n"
+			"Crawl-delay: 0.25\n",
+			{ NULL },
+			{ NULL },
+			250
+		},
+		{
+			// Crawl-delay for another robot
+			"User-agent: otherbot\n"
+			"Crawl-delay: 10\n"
+			"User-agent: *\n"
+			"Disallow: /tmp/\n",
+			{ NULL },
+			{ NULL },
+			0
 		}
 	};
 
@@ -2087,11 +2593,98 @@ static void test_robots(void)
 			}
 		}
 
+		if (robots->crawl_delay == t->crawl_delay)
+			ok++;
+		else {
+			info_printf("Crawl-delay %d instead of %d\n", robots->crawl_delay, t->crawl_delay);
+			failed++;
+		}
+
 		wget_robots_free(&robots);
 
 	}
 }
 
+static void test_tcp_socket_options(void)
+{
+	wget_tcp_t *server = wget_tcp_init(), *client = wget_tcp_init();
+	char port[16];
+	socklen_t len;
+	int val;
+
+	wget_tcp_set_preferred_family(server, WGET_NET_FAMILY_IPV4);
+	if (wget_tcp_listen(server, "localhost", NULL, 5) != 0) {
+		info_printf("Failed to listen on localhost, skip socket option tests\n");
+		goto out;
+	}
+	snprintf(port, sizeof(port), "%d", wget_tcp_get_local_port(server));
+
+	wget_tcp_set_tcp_fastopen(client, 0);
+	wget_tcp_set_preferred_family(client, WGET_NET_FAMILY_IPV4);
+	wget_tcp_set_receive_buffer_size(client, 256 * 1024);
+	wget_tcp_set_send_buffer_size(client, 128 * 1024);
+	wget_tcp_set_notsent_lowat(client, 16384);
+	wget_tcp_set_congestion_control(client, "reno");
+	wget_tcp_set_quickack(client, 1);
+
+	if (wget_tcp_connect(client, "localhost", port) != WGET_E_SUCCESS) {
+		info_printf("Failed to connect to localhost:%s\n", port);
+		failed++;
+		goto out;
+	}
+
+	// the kernel may round up (Linux doubles) the buffer sizes
+	len = sizeof(val);
+	if (getsockopt(client->sockfd, SOL_SOCKET, SO_RCVBUF, (void *)&val, &len) == 0 && val >= 256 * 1024)
+		ok++;
+	else {
+		failed++;
+		info_printf("Unexpected SO_RCVBUF %d\n", val);
+	}
+
+	len = sizeof(val);
+	if (getsockopt(client->sockfd, SOL_SOCKET, SO_SNDBUF, (void *)&val, &len) == 0 && val >= 128 * 1024)
+		ok++;
+	else {
+		failed++;
+		info_printf("Unexpected SO_SNDBUF %d\n", val);
+	}
+
+#ifdef TCP_NOTSENT_LOWAT
+	len = sizeof(val);
+	if (getsockopt(client->sockfd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, (void *)&val, &len) == 0 && val == 16384)
+		ok++;
+	else {
+		failed++;
+		info_printf("Unexpected TCP_NOTSENT_LOWAT %d\n", val);
+	}
+#endif
+
+#ifdef TCP_CONGESTION
+	{
+		char congestion[16];
+
+		len = sizeof(congestion) - 1;
+		if (getsockopt(client->sockfd, IPPROTO_TCP, TCP_CONGESTION, congestion, &len) == 0) {
+			congestion[len] = 0;
+			if (!strcmp(congestion, "reno"))
+				ok++;
+			else {
+				failed++;
+				info_printf("Unexpected TCP_CONGESTION '%s'\n", congestion);
+			}
+		} else {
+			failed++;
+			info_printf("Failed to get TCP_CONGESTION\n");
+		}
+	}
+#endif
+
+out:
+	wget_tcp_deinit(&client);
+	wget_tcp_deinit(&server);
+}
+
 int main(int argc, const char **argv)
 {
 	// if VALGRIND testing is enabled, we have to call ourselves with valgrind checking
@@ -2122,6 +2715,7 @@ int main(int argc, const char **argv)
 	test_buffer();
 	test_buffer_printf();
 	test_utils();
+	test_iri_escape();
 	test_strcasecmp_ascii();
 	test_hashing();
 	test_vector();
@@ -2144,9 +2738,14 @@ int main(int argc, const char **argv)
 	test_hsts();
 	test_hpkp();
 	test_parse_challenge();
+	test_http_date();
+	test_memstats();
+	test_sitemap_entries();
+	test_html_names();
 	test_bar();
 	test_netrc();
 	test_robots();
+	test_tcp_socket_options();
 
 	selftest_options() ? failed++ : ok++;
 